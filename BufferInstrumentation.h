@@ -0,0 +1,271 @@
+/* Header for BufferInstrumentation and the Instrumented tracker. Unfortunately, templated
+ * functions must be visible to the compiler, so implementations of the functions are
+ * included directly by this header.
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include "DataContainer.h"
+
+/**
+ * Counters and latency histograms for the operations of one StatisticsBuffer, kept when
+ * the buffer lists the Instrumented tracker.
+ *
+ * Every call of an operation is counted, and one call in every sampleInterval (64 by
+ * default) is timed on std::chrono::steady_clock, its latency counted in a histogram of
+ * power-of-two bins of nanoseconds. An unsampled call costs an increment and a mask, so
+ * the counters can stay on in production; latencies are reported as the upper bound of
+ * their bin, so to within a factor of two.
+ *
+ * The counts are relaxed atomics, since the buffer's const queries update them and may
+ * run on several threads at once: the queries count with atomic increments, while the
+ * operations that change the buffer, which are never concurrent, count with plain
+ * relaxed loads and stores. The counts may be read, or dumped, from any thread; each is
+ * exact, but they are not read as one snapshot.
+ *
+ * Example: statBuffer.getInstrumentation().dumpJson(std::cout);
+ */
+class BufferInstrumentation {
+public:
+    /**
+     * The operations counted and timed: first those changing the buffer, then, from
+     * GetMean on, the const queries.
+     */
+    enum Operation { AddRow = 0, AddRows, RemoveRows, GetMean, GetStdDev, GetSkewness, GetKurtosis, GetSummary,
+                     numOperations };
+
+    /**
+     * Number of latency bins; bin i counts latencies below 2^i ns and not below 2^(i-1) ns,
+     * and the last also everything longer.
+     */
+    static const unsigned int numLatencyBins = 40;
+
+    /**
+     * Constructor, with all counts zero and a sample interval of 64.
+     */
+    BufferInstrumentation();
+
+    /**
+     * Copies the counts and sample interval of another instrumentation.
+     */
+    BufferInstrumentation(const BufferInstrumentation & other);
+    BufferInstrumentation & operator = (const BufferInstrumentation & other);
+
+    /**
+     * Returns a printable name for an operation, such as "addRow".
+     *
+     * @param operation  the operation
+     * @return           a static string
+     */
+    static const char * operationName(Operation operation);
+
+    /**
+     * Sets how often calls are timed: one in every interval of each operation. Not to be
+     * called while other threads use the buffer.
+     *
+     * @param interval  a power of two; 1 times every call
+     */
+    void setSampleInterval(uint32_t interval);
+
+    /**
+     * Returns how often calls are timed.
+     *
+     * @return the sample interval
+     */
+    uint32_t getSampleInterval() const;
+
+    /**
+     * Returns the number of calls of an operation.
+     *
+     * @param operation  the operation
+     * @return           the number of calls
+     */
+    uint64_t getCalls(Operation operation) const;
+
+    /**
+     * Returns the number of calls of an operation that were timed.
+     *
+     * @param operation  the operation
+     * @return           the number of timed calls
+     */
+    uint64_t getSampledCalls(Operation operation) const;
+
+    /**
+     * Returns the latency histogram of an operation, bin i counting the timed calls taking
+     * under 2^i ns.
+     *
+     * @param operation  the operation
+     * @return           a copy of the histogram
+     */
+    std::array<uint64_t, numLatencyBins> getLatencyHistogram(Operation operation) const;
+
+    /**
+     * Returns the upper bound, in nanoseconds, of the latency bin holding the given quantile
+     * of the timed calls of an operation, or 0 if none was timed.
+     *
+     * @param operation  the operation
+     * @param q          the quantile, from 0 to 1
+     * @return           the latency bound in nanoseconds
+     */
+    double getLatencyQuantile(Operation operation, double q) const;
+
+    /**
+     * Returns the number of rows added, by addRow() and addRows().
+     */
+    uint64_t getRowsAdded() const;
+
+    /**
+     * Returns the number of rows cycled out of the full buffer by rows added after them.
+     */
+    uint64_t getRowsEvicted() const;
+
+    /**
+     * Returns the number of rows taken out by removeRows().
+     */
+    uint64_t getRowsRemoved() const;
+
+    /**
+     * Zeroes every count, keeping the sample interval.
+     */
+    void clear();
+
+    /**
+     * Writes the counters and latency quantiles as lines of text.
+     *
+     * @param os  the stream to write to
+     */
+    void dumpText(std::ostream & os) const;
+
+    /**
+     * Writes the counters and latency histograms as a JSON object.
+     *
+     * @param os  the stream to write to
+     */
+    void dumpJson(std::ostream & os) const;
+
+    /**
+     * Counts a call of an operation, returning whether it is one to time.
+     */
+    bool beginCall(Operation operation);
+
+    /**
+     * Counts the latency of a timed call.
+     */
+    void recordLatency(Operation operation, uint64_t nanoseconds);
+
+    /**
+     * Counts rows added, evicted and removed.
+     */
+    void countRows(uint64_t added, uint64_t evicted, uint64_t removed);
+
+private:
+    /**
+     * Adds to a count of an operation: atomically for the const queries, which may run
+     * concurrently, otherwise with a relaxed load and store.
+     */
+    static uint64_t bump(std::atomic<uint64_t> & count, uint64_t amount, bool shared);
+
+    /**
+     * Whether an operation is a const query.
+     */
+    static bool isQuery(Operation operation);
+
+    /**
+     * sampleInterval - 1, to test the call count against.
+     */
+    uint32_t sampleMask_;
+    std::array<std::atomic<uint64_t>, numOperations> calls_;
+    std::array<std::atomic<uint64_t>, numOperations> sampledCalls_;
+    std::array<std::array<std::atomic<uint64_t>, numLatencyBins>, numOperations> latencies_;
+    std::atomic<uint64_t> rowsAdded_;
+    std::atomic<uint64_t> rowsEvicted_;
+    std::atomic<uint64_t> rowsRemoved_;
+};
+
+/**
+ * A StatisticsBuffer tracker keeping a BufferInstrumentation of the buffer's operations,
+ * e.g. StatisticsBuffer<1024, 16, Instrumented>. Like the moment policies its hooks are
+ * never called; the buffer counts and times its own operations when it is listed, and
+ * without it compiles to exactly the uninstrumented code.
+ */
+template <size_t T_length, size_t T_width>
+class Instrumented {
+public:
+    /**
+     * Returns the instrumentation of this buffer. It is updated by the const queries too,
+     * so is returned mutable even from a const buffer.
+     *
+     * @return a reference to the instrumentation
+     */
+    BufferInstrumentation & getInstrumentation() const;
+
+protected:
+    void onAddRow(const DataContainer<T_width> &) {}
+    void onRemoveRow(const DataContainer<T_width> &) {}
+    void onClear() {}
+
+private:
+    mutable BufferInstrumentation instrumentation_;
+};
+
+namespace InstrumentationDetail {
+
+/**
+ * Whether a tracker is Instrumented.
+ */
+template <size_t T_length, size_t T_width>
+std::true_type isInstrumented(const Instrumented<T_length, T_width> *);
+std::false_type isInstrumented(...);
+
+template <class T_tracker>
+struct IsInstrumented : decltype(isInstrumented(static_cast<T_tracker *>(nullptr))) {
+};
+
+template <bool... T_flags>
+struct AnyOf : std::false_type {
+};
+
+template <bool T_first, bool... T_rest>
+struct AnyOf<T_first, T_rest...> : std::integral_constant<bool, T_first || AnyOf<T_rest...>::value> {
+};
+
+/**
+ * Counts and, when sampled, times one call of a buffer operation, from construction to
+ * destruction. The version for uninstrumented buffers does nothing.
+ */
+template <bool T_enabled>
+class Probe {
+public:
+    template <class T_buffer>
+    Probe(const T_buffer *, BufferInstrumentation::Operation) {}
+
+    void countRows(uint64_t, uint64_t, uint64_t) {}
+};
+
+template <>
+class Probe<true> {
+public:
+    template <class T_buffer>
+    Probe(const T_buffer *buffer, BufferInstrumentation::Operation operation);
+
+    ~Probe();
+
+    void countRows(uint64_t added, uint64_t evicted, uint64_t removed);
+
+private:
+    Probe(const Probe &) = delete;
+    Probe & operator = (const Probe &) = delete;
+
+    BufferInstrumentation &instrumentation_;
+    BufferInstrumentation::Operation operation_;
+    bool sampled_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace InstrumentationDetail
+
+#include "BufferInstrumentation_impl.h"
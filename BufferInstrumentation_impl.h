@@ -0,0 +1,217 @@
+#include "BufferInstrumentation.h"
+#include <assert.h>
+
+inline BufferInstrumentation::BufferInstrumentation() : sampleMask_(63) {
+    this->clear();
+}
+
+inline BufferInstrumentation::BufferInstrumentation(const BufferInstrumentation &other) {
+    *this = other;
+}
+
+inline BufferInstrumentation & BufferInstrumentation::operator=(const BufferInstrumentation &other) {
+    this->sampleMask_ = other.sampleMask_;
+    for (unsigned int op = 0; op < numOperations; op++) {
+        this->calls_[op].store(other.calls_[op].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->sampledCalls_[op].store(other.sampledCalls_[op].load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+        for (unsigned int bin = 0; bin < numLatencyBins; bin++)
+            this->latencies_[op][bin].store(other.latencies_[op][bin].load(std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+    }
+    this->rowsAdded_.store(other.rowsAdded_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    this->rowsEvicted_.store(other.rowsEvicted_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    this->rowsRemoved_.store(other.rowsRemoved_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+inline const char * BufferInstrumentation::operationName(Operation operation) {
+    switch (operation) {
+    case AddRow: return "addRow";
+    case AddRows: return "addRows";
+    case RemoveRows: return "removeRows";
+    case GetMean: return "getMean";
+    case GetStdDev: return "getStdDev";
+    case GetSkewness: return "getSkewness";
+    case GetKurtosis: return "getKurtosis";
+    case GetSummary: return "getSummary";
+    default: return "unknown";
+    }
+}
+
+inline void BufferInstrumentation::setSampleInterval(uint32_t interval) {
+    assert(interval != 0 && (interval & (interval - 1)) == 0);
+    this->sampleMask_ = interval - 1;
+}
+
+inline uint32_t BufferInstrumentation::getSampleInterval() const {
+    return this->sampleMask_ + 1;
+}
+
+inline uint64_t BufferInstrumentation::getCalls(Operation operation) const {
+    return this->calls_[operation].load(std::memory_order_relaxed);
+}
+
+inline uint64_t BufferInstrumentation::getSampledCalls(Operation operation) const {
+    return this->sampledCalls_[operation].load(std::memory_order_relaxed);
+}
+
+inline std::array<uint64_t, BufferInstrumentation::numLatencyBins>
+BufferInstrumentation::getLatencyHistogram(Operation operation) const {
+    std::array<uint64_t, numLatencyBins> histogram;
+    for (unsigned int bin = 0; bin < numLatencyBins; bin++)
+        histogram[bin] = this->latencies_[operation][bin].load(std::memory_order_relaxed);
+    return histogram;
+}
+
+inline double BufferInstrumentation::getLatencyQuantile(Operation operation, double q) const {
+    assert(q >= 0 && q <= 1);
+    const std::array<uint64_t, numLatencyBins> histogram = this->getLatencyHistogram(operation);
+    uint64_t numSampled = 0;
+    for (uint64_t count: histogram)
+        numSampled += count;
+    if (numSampled == 0)
+        return 0;
+    // The bin holding the call of rank q * (numSampled - 1), counting from the fastest
+    const uint64_t rank = static_cast<uint64_t>(q * (numSampled - 1));
+    uint64_t seen = 0;
+    unsigned int bin = 0;
+    for (; bin + 1 < numLatencyBins; bin++) {
+        seen += histogram[bin];
+        if (seen > rank)
+            break;
+    }
+    return static_cast<double>(uint64_t(1) << bin);
+}
+
+inline uint64_t BufferInstrumentation::getRowsAdded() const {
+    return this->rowsAdded_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BufferInstrumentation::getRowsEvicted() const {
+    return this->rowsEvicted_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t BufferInstrumentation::getRowsRemoved() const {
+    return this->rowsRemoved_.load(std::memory_order_relaxed);
+}
+
+inline void BufferInstrumentation::clear() {
+    for (unsigned int op = 0; op < numOperations; op++) {
+        this->calls_[op].store(0, std::memory_order_relaxed);
+        this->sampledCalls_[op].store(0, std::memory_order_relaxed);
+        for (auto &count: this->latencies_[op])
+            count.store(0, std::memory_order_relaxed);
+    }
+    this->rowsAdded_.store(0, std::memory_order_relaxed);
+    this->rowsEvicted_.store(0, std::memory_order_relaxed);
+    this->rowsRemoved_.store(0, std::memory_order_relaxed);
+}
+
+inline void BufferInstrumentation::dumpText(std::ostream &os) const {
+    os << "rows added " << this->getRowsAdded() << ", evicted " << this->getRowsEvicted() << ", removed "
+       << this->getRowsRemoved() << std::endl;
+    for (unsigned int op = 0; op < numOperations; op++) {
+        const Operation operation = static_cast<Operation>(op);
+        const uint64_t numCalls = this->getCalls(operation), numSampled = this->getSampledCalls(operation);
+        if (numCalls == 0)
+            continue;
+        os << operationName(operation) << ": " << numCalls << " calls, " << numSampled << " timed";
+        if (numSampled > 0) {
+            os << ", p50 < " << this->getLatencyQuantile(operation, 0.5) << " ns, p99 < "
+               << this->getLatencyQuantile(operation, 0.99) << " ns, max < "
+               << this->getLatencyQuantile(operation, 1) << " ns";
+        }
+        os << std::endl;
+    }
+}
+
+inline void BufferInstrumentation::dumpJson(std::ostream &os) const {
+    os << "{\"rows_added\": " << this->getRowsAdded() << ", \"rows_evicted\": " << this->getRowsEvicted()
+       << ", \"rows_removed\": " << this->getRowsRemoved() << ", \"sample_interval\": " << this->getSampleInterval()
+       << ", \"operations\": {";
+    bool first = true;
+    for (unsigned int op = 0; op < numOperations; op++) {
+        const Operation operation = static_cast<Operation>(op);
+        const uint64_t numCalls = this->getCalls(operation);
+        if (numCalls == 0)
+            continue;
+        const std::array<uint64_t, numLatencyBins> histogram = this->getLatencyHistogram(operation);
+        os << (first ? "" : ", ") << "\"" << operationName(operation) << "\": {\"calls\": " << numCalls
+           << ", \"timed\": " << this->getSampledCalls(operation) << ", \"p50_ns\": "
+           << this->getLatencyQuantile(operation, 0.5) << ", \"p99_ns\": " << this->getLatencyQuantile(operation, 0.99)
+           << ", \"histogram\": [";
+        // The non-empty bins, each as the bound below which its calls took
+        bool firstBin = true;
+        for (unsigned int bin = 0; bin < numLatencyBins; bin++) {
+            if (histogram[bin] == 0)
+                continue;
+            os << (firstBin ? "" : ", ") << "{\"below_ns\": " << (uint64_t(1) << bin) << ", \"count\": "
+               << histogram[bin] << "}";
+            firstBin = false;
+        }
+        os << "]}";
+        first = false;
+    }
+    os << "}}" << std::endl;
+}
+
+inline bool BufferInstrumentation::beginCall(Operation operation) {
+    return (bump(this->calls_[operation], 1, isQuery(operation)) & this->sampleMask_) == 0;
+}
+
+inline void BufferInstrumentation::recordLatency(Operation operation, uint64_t nanoseconds) {
+    unsigned int bin = 0;
+    while (bin + 1 < numLatencyBins && (nanoseconds >> bin) != 0)
+        bin++;
+    bump(this->sampledCalls_[operation], 1, isQuery(operation));
+    bump(this->latencies_[operation][bin], 1, isQuery(operation));
+}
+
+inline void BufferInstrumentation::countRows(uint64_t added, uint64_t evicted, uint64_t removed) {
+    // Only the operations changing the buffer move rows
+    bump(this->rowsAdded_, added, false);
+    bump(this->rowsEvicted_, evicted, false);
+    bump(this->rowsRemoved_, removed, false);
+}
+
+inline uint64_t BufferInstrumentation::bump(std::atomic<uint64_t> &count, uint64_t amount, bool shared) {
+    if (shared)
+        return count.fetch_add(amount, std::memory_order_relaxed);
+    const uint64_t previous = count.load(std::memory_order_relaxed);
+    count.store(previous + amount, std::memory_order_relaxed);
+    return previous;
+}
+
+inline bool BufferInstrumentation::isQuery(Operation operation) {
+    return operation >= GetMean;
+}
+
+template <size_t T_length, size_t T_width>
+BufferInstrumentation & Instrumented<T_length, T_width>::getInstrumentation() const {
+    return this->instrumentation_;
+}
+
+namespace InstrumentationDetail {
+
+template <class T_buffer>
+Probe<true>::Probe(const T_buffer *buffer, BufferInstrumentation::Operation operation)
+        : instrumentation_(buffer->getInstrumentation()), operation_(operation),
+          sampled_(instrumentation_.beginCall(operation)) {
+    if (this->sampled_)
+        this->start_ = std::chrono::steady_clock::now();
+}
+
+inline Probe<true>::~Probe() {
+    if (this->sampled_) {
+        const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - this->start_;
+        this->instrumentation_.recordLatency(
+                this->operation_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+}
+
+inline void Probe<true>::countRows(uint64_t added, uint64_t evicted, uint64_t removed) {
+    this->instrumentation_.countRows(added, evicted, removed);
+}
+
+} // namespace InstrumentationDetail
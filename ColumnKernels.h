@@ -0,0 +1,468 @@
+/* Header for ColumnKernels, the per-column loops shared by DataContainer and
+ * StatisticsBuffer. Implementations are included directly by this header,
+ * like the templated classes.
+ *
+ * Every kernel has a scalar version plus SSE2, AVX2 and AVX-512 versions on
+ * x86 with GCC/Clang. The best one the CPU supports is chosen at runtime the
+ * first time a kernel is called. The SIMD versions perform exactly the same
+ * IEEE operations per column, in the same order, as the scalar ones (no FMA
+ * contraction), so results are identical whichever instruction set is used.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A collection of elementwise kernels over contiguous arrays of doubles,
+ * dispatched at runtime to the widest instruction set available.
+ *
+ * The shifted-data kernels maintain the accumulators used by StatisticsBuffer:
+ * Ex += (x - K) and Ex2 += (x - K)^2 for each column.
+ */
+class ColumnKernels {
+public:
+    /**
+     * Instruction sets a kernel can be dispatched to, from narrowest to widest.
+     */
+    enum InstructionSet { Scalar = 0, SSE2, AVX2, AVX512 };
+
+    /**
+     * Returns the widest instruction set supported by the running CPU.
+     *
+     * @return the detected instruction set
+     */
+    static InstructionSet supportedInstructionSet();
+
+    /**
+     * Returns the instruction set currently used by the kernels.
+     *
+     * @return the active instruction set
+     */
+    static InstructionSet activeInstructionSet();
+
+    /**
+     * Selects the instruction set used by the kernels, clamped to what the CPU supports.
+     * Intended for benchmarking and testing; not safe to call while other threads
+     * are running kernels.
+     *
+     * @param requested  the instruction set to use
+     * @return           the instruction set actually selected
+     */
+    static InstructionSet setInstructionSet(InstructionSet requested);
+
+    /**
+     * Returns a printable name for an instruction set.
+     *
+     * @param set  the instruction set
+     * @return     a static string such as "avx2"
+     */
+    static const char * instructionSetName(InstructionSet set);
+
+    /**
+     * lhs[i] += rhs[i] for each of the n columns.
+     */
+    static void add(double *lhs, const double *rhs, size_t n);
+
+    /**
+     * lhs[i] -= rhs[i] for each of the n columns.
+     */
+    static void subtract(double *lhs, const double *rhs, size_t n);
+
+    /**
+     * lhs[i] /= constant for each of the n columns.
+     */
+    static void divide(double *lhs, double constant, size_t n);
+
+    /**
+     * lhs[i] += scale * rhs[i] for each of the n columns.
+     */
+    static void addScaled(double *lhs, const double *rhs, double scale, size_t n);
+
+    /**
+     * lhs[i] = lhs[i] * lhs[i] for each of the n columns.
+     */
+    static void square(double *lhs, size_t n);
+
+    /**
+     * lhs[i] = sqrt(lhs[i]) for each of the n columns.
+     */
+    static void sqrt(double *lhs, size_t n);
+
+    /**
+     * Adds a row to the shifted-data accumulators: with d = row[i] - K[i],
+     * Ex[i] += d and Ex2[i] += d*d.
+     */
+    static void addShifted(double *Ex, double *Ex2, const double *row, const double *K, size_t n);
+
+    /**
+     * Removes a row from the shifted-data accumulators: with d = row[i] - K[i],
+     * Ex[i] -= d and Ex2[i] -= d*d.
+     */
+    static void removeShifted(double *Ex, double *Ex2, const double *row, const double *K, size_t n);
+
+    /**
+     * Removes oldRow and adds newRow to the shifted-data accumulators in a single
+     * pass. Equivalent to removeShifted(oldRow) followed by addShifted(newRow).
+     */
+    static void replaceShifted(double *Ex, double *Ex2, const double *oldRow, const double *newRow,
+                               const double *K, size_t n);
+
+    /**
+     * Number of rows of n columns the block kernels sweep at a time. A caller that makes a
+     * second pass over a block, such as copying it into a buffer, can go a sweep at a time and
+     * find each sweep's rows still in cache.
+     */
+    static size_t sweepRows(size_t n);
+
+    /**
+     * Adds numRows contiguous rows of n columns each to the shifted-data accumulators.
+     * Equivalent to calling addShifted() on each row in turn, with the same results, but the
+     * block is swept with the columns outer and the rows inner: each lane group of the
+     * accumulators is loaded once, carries the whole block in registers and is stored once.
+     * The other block kernels below and their mean-only and fourth-order versions do the same.
+     */
+    static void addShiftedRows(double *Ex, double *Ex2, const double *rows, size_t numRows,
+                               const double *K, size_t n);
+
+    /**
+     * Removes numRows contiguous rows of n columns each from the shifted-data accumulators.
+     * Equivalent to calling removeShifted() on each row in turn.
+     */
+    static void removeShiftedRows(double *Ex, double *Ex2, const double *rows, size_t numRows,
+                                  const double *K, size_t n);
+
+    /**
+     * Replaces numRows contiguous oldRows with numRows contiguous newRows in the shifted-data
+     * accumulators. Equivalent to calling replaceShifted() on each pair of rows in turn.
+     */
+    static void replaceShiftedRows(double *Ex, double *Ex2, const double *oldRows, const double *newRows,
+                                   size_t numRows, const double *K, size_t n);
+
+    /**
+     * Versions of the shifted-data kernels above for rows stored in a narrower type than
+     * double. The accumulators and K stay double. Float and int16_t rows have kernels of
+     * their own, overloaded below, that convert each lane group to double as it is loaded
+     * and go straight on with the update; rows of other types are widened to double on the
+     * stack, a chunk of columns at a time, and passed to the double kernel. Either way the
+     * conversion is exact, so the results are those of double rows holding the same values.
+     */
+    template <class T_value>
+    static void addShifted(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n);
+
+    template <class T_value>
+    static void removeShifted(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n);
+
+    template <class T_value>
+    static void replaceShifted(double *Ex, double *Ex2, const T_value *oldRow, const T_value *newRow,
+                               const double *K, size_t n);
+
+    template <class T_value>
+    static void addShiftedRows(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                               const double *K, size_t n);
+
+    template <class T_value>
+    static void removeShiftedRows(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                  const double *K, size_t n);
+
+    template <class T_value>
+    static void replaceShiftedRows(double *Ex, double *Ex2, const T_value *oldRows, const T_value *newRows,
+                                   size_t numRows, const double *K, size_t n);
+
+    static void addShifted(double *Ex, double *Ex2, const float *row, const double *K, size_t n);
+    static void removeShifted(double *Ex, double *Ex2, const float *row, const double *K, size_t n);
+    static void replaceShifted(double *Ex, double *Ex2, const float *oldRow, const float *newRow, const double *K,
+                               size_t n);
+    static void addShiftedRows(double *Ex, double *Ex2, const float *rows, size_t numRows, const double *K, size_t n);
+    static void removeShiftedRows(double *Ex, double *Ex2, const float *rows, size_t numRows, const double *K,
+                                  size_t n);
+    static void replaceShiftedRows(double *Ex, double *Ex2, const float *oldRows, const float *newRows,
+                                   size_t numRows, const double *K, size_t n);
+
+    static void addShifted(double *Ex, double *Ex2, const int16_t *row, const double *K, size_t n);
+    static void removeShifted(double *Ex, double *Ex2, const int16_t *row, const double *K, size_t n);
+    static void replaceShifted(double *Ex, double *Ex2, const int16_t *oldRow, const int16_t *newRow, const double *K,
+                               size_t n);
+    static void addShiftedRows(double *Ex, double *Ex2, const int16_t *rows, size_t numRows, const double *K, size_t n);
+    static void removeShiftedRows(double *Ex, double *Ex2, const int16_t *rows, size_t numRows, const double *K,
+                                  size_t n);
+    static void replaceShiftedRows(double *Ex, double *Ex2, const int16_t *oldRows, const int16_t *newRows,
+                                   size_t numRows, const double *K, size_t n);
+
+    /**
+     * Versions of the shifted-data kernels above that maintain Ex alone, for buffers that
+     * only track the mean. Each performs exactly the operations on Ex of its counterpart,
+     * so the means agree bit for bit with those of the full accumulators.
+     */
+    static void addShiftedMean(double *Ex, const double *row, const double *K, size_t n);
+    static void removeShiftedMean(double *Ex, const double *row, const double *K, size_t n);
+    static void replaceShiftedMean(double *Ex, const double *oldRow, const double *newRow, const double *K, size_t n);
+    static void addShiftedMeanRows(double *Ex, const double *rows, size_t numRows, const double *K, size_t n);
+    static void removeShiftedMeanRows(double *Ex, const double *rows, size_t numRows, const double *K, size_t n);
+    static void replaceShiftedMeanRows(double *Ex, const double *oldRows, const double *newRows, size_t numRows,
+                                       const double *K, size_t n);
+
+    /**
+     * Narrow-row versions of the mean-only kernels, widening as the shifted-data ones do.
+     */
+    template <class T_value>
+    static void addShiftedMean(double *Ex, const T_value *row, const double *K, size_t n);
+
+    template <class T_value>
+    static void removeShiftedMean(double *Ex, const T_value *row, const double *K, size_t n);
+
+    template <class T_value>
+    static void replaceShiftedMean(double *Ex, const T_value *oldRow, const T_value *newRow, const double *K, size_t n);
+
+    template <class T_value>
+    static void addShiftedMeanRows(double *Ex, const T_value *rows, size_t numRows, const double *K, size_t n);
+
+    template <class T_value>
+    static void removeShiftedMeanRows(double *Ex, const T_value *rows, size_t numRows, const double *K, size_t n);
+
+    template <class T_value>
+    static void replaceShiftedMeanRows(double *Ex, const T_value *oldRows, const T_value *newRows, size_t numRows,
+                                       const double *K, size_t n);
+
+    /**
+     * Versions of the shifted-data kernels above that also maintain the third- and
+     * fourth-power sums, for skewness and kurtosis: with d = row[i] - K[i], Ex3[i] += d^3
+     * and Ex4[i] += d^4 alongside Ex[i] and Ex2[i], in the same pass. Ex and Ex2 see exactly
+     * the operations of the plain kernels.
+     */
+    static void addShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row, const double *K,
+                            size_t n);
+    static void removeShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row, const double *K,
+                               size_t n);
+    static void replaceShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRow,
+                                const double *newRow, const double *K, size_t n);
+    static void addShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows, size_t numRows,
+                                const double *K, size_t n);
+    static void removeShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                   size_t numRows, const double *K, size_t n);
+    static void replaceShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRows,
+                                    const double *newRows, size_t numRows, const double *K, size_t n);
+
+    /**
+     * Narrow-row versions of the fourth-order kernels, widening as the shifted-data ones do.
+     */
+    template <class T_value>
+    static void addShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *row, const double *K,
+                            size_t n);
+
+    template <class T_value>
+    static void removeShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *row, const double *K,
+                               size_t n);
+
+    template <class T_value>
+    static void replaceShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *oldRow,
+                                const T_value *newRow, const double *K, size_t n);
+
+    template <class T_value>
+    static void addShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *rows, size_t numRows,
+                                const double *K, size_t n);
+
+    template <class T_value>
+    static void removeShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *rows,
+                                   size_t numRows, const double *K, size_t n);
+
+    template <class T_value>
+    static void replaceShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *oldRows,
+                                    const T_value *newRows, size_t numRows, const double *K, size_t n);
+
+    /**
+     * Merges the shifted-data accumulators of countB rows, taken relative to KB, into
+     * accumulators taken relative to KA: with d = KB[i] - KA[i], ExA[i] += ExB[i] + countB*d
+     * and Ex2A[i] += Ex2B[i] + d*(2*ExB[i] + countB*d).
+     */
+    static void mergeShifted(const double *KA, double *ExA, double *Ex2A, const double *KB, const double *ExB,
+                             const double *Ex2B, double countB, size_t n);
+
+    /**
+     * Computes the mean of each column from the shifted-data accumulators:
+     * mean[i] = K[i] + Ex[i] / count.
+     */
+    static void mean(double *mean, const double *K, const double *Ex, double count, size_t n);
+
+    /**
+     * Computes the sample standard deviation of each column from the shifted-data
+     * accumulators: stdDev[i] = sqrt((Ex2[i] - Ex[i]*Ex[i] / count) / (count - 1)).
+     * A sum of squares that cancels to slightly below zero is taken as zero, so a
+     * constant column gives 0 rather than NaN.
+     */
+    static void stdDev(double *stdDev, const double *Ex, const double *Ex2, double count, size_t n);
+
+    /**
+     * Moves the location parameter of each column to the current mean of its count values,
+     * adjusting the shifted-data accumulators to match: with d = (K[i] + Ex[i] / count) - K[i],
+     * K[i] += d, Ex[i] -= count*d and Ex2[i] -= d*(2*Ex[i] - count*d).
+     */
+    static void recenter(double *K, double *Ex, double *Ex2, double count, size_t n);
+
+    /**
+     * Version of recenter() for mean-only accumulators: K[i] and Ex[i] are updated as there.
+     */
+    static void recenterMean(double *K, double *Ex, double count, size_t n);
+
+    /**
+     * Version of recenter() for the fourth-order accumulators: K[i], Ex[i] and Ex2[i] are
+     * updated as there, and Ex3[i] and Ex4[i] by the binomial expansions of the sums of
+     * (d - shift)^3 and (d - shift)^4.
+     */
+    static void recenter4(double *K, double *Ex, double *Ex2, double *Ex3, double *Ex4, double count, size_t n);
+
+    /**
+     * Computes the skewness of each column, g1 = sqrt(count) * m3 / m2^(3/2), from the
+     * fourth-order accumulators, where m2 and m3 are the sums of the squared and cubed
+     * deviations from the mean. A constant column gives NaN.
+     */
+    static void skewness(double *skewness, const double *Ex, const double *Ex2, const double *Ex3, double count,
+                         size_t n);
+
+    /**
+     * Computes the excess kurtosis of each column, g2 = count * m4 / m2^2 - 3, from the
+     * fourth-order accumulators, where m4 is the sum of the fourth powers of the deviations
+     * from the mean. A constant column gives NaN.
+     */
+    static void kurtosis(double *kurtosis, const double *Ex, const double *Ex2, const double *Ex3, const double *Ex4,
+                         double count, size_t n);
+
+    /**
+     * Versions of addShifted(), replaceShifted(), addShifted4() and replaceShifted4() that
+     * first score the new row against the count rows in the accumulators, in the same pass
+     * over the columns. With d = row[i] - K[i] - Ex[i]/count, the deviation of the row from
+     * their mean, and m2 the sum of their squared deviations, each writes deviation[i] = d and
+     * sumSquares[i] = m2, and returns the largest excess d*d*(count - 1) - squaredThresholds[i]*m2.
+     * A column's excess is positive exactly when d is more than the threshold of sample standard
+     * deviations from the mean, so for a column constant over the rows, whenever the value
+     * differs; a row with no column flagged is told apart without dividing, taking square roots
+     * or another pass. The accumulators end up exactly as the unscored kernel leaves them.
+     */
+    static double addShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares, const double *row,
+                                   const double *K, const double *squaredThresholds, double count, size_t n);
+
+    static double replaceShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                       const double *oldRow, const double *newRow, const double *K,
+                                       const double *squaredThresholds, double count, size_t n);
+
+    static double addShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                    double *sumSquares, const double *row, const double *K,
+                                    const double *squaredThresholds, double count, size_t n);
+
+    static double replaceShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                        double *sumSquares, const double *oldRow, const double *newRow,
+                                        const double *K, const double *squaredThresholds, double count, size_t n);
+
+    /**
+     * Narrow-row versions of the scored kernels, widening as the shifted-data kernels do.
+     */
+    template <class T_value>
+    static double addShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                   const T_value *row, const double *K, const double *squaredThresholds,
+                                   double count, size_t n);
+
+    template <class T_value>
+    static double replaceShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                       const T_value *oldRow, const T_value *newRow, const double *K,
+                                       const double *squaredThresholds, double count, size_t n);
+
+    template <class T_value>
+    static double addShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                    double *sumSquares, const T_value *row, const double *K,
+                                    const double *squaredThresholds, double count, size_t n);
+
+    template <class T_value>
+    static double replaceShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                        double *sumSquares, const T_value *oldRow, const T_value *newRow,
+                                        const double *K, const double *squaredThresholds, double count, size_t n);
+
+    /**
+     * Adds a row to exponentially weighted estimates with smoothing factor alpha:
+     * with d = row[i] - mean[i], mean[i] += alpha*d and variance[i] = (1 - alpha)*(variance[i] + alpha*d*d).
+     */
+    static void addDecayed(double *mean, double *variance, const double *row, double alpha, size_t n);
+
+private:
+    /**
+     * Function pointers for one instruction set's kernels.
+     */
+    struct KernelTable {
+        void (*add)(double *, const double *, size_t);
+        void (*subtract)(double *, const double *, size_t);
+        void (*divide)(double *, double, size_t);
+        void (*addScaled)(double *, const double *, double, size_t);
+        void (*square)(double *, size_t);
+        void (*sqrt)(double *, size_t);
+        void (*addShifted)(double *, double *, const double *, const double *, size_t);
+        void (*removeShifted)(double *, double *, const double *, const double *, size_t);
+        void (*replaceShifted)(double *, double *, const double *, const double *, const double *, size_t);
+        void (*addShiftedRows)(double *, double *, const double *, size_t, const double *, size_t);
+        void (*removeShiftedRows)(double *, double *, const double *, size_t, const double *, size_t);
+        void (*replaceShiftedRows)(double *, double *, const double *, const double *, size_t,
+                                   const double *, size_t);
+        void (*addShiftedFloat)(double *, double *, const float *, const double *, size_t);
+        void (*removeShiftedFloat)(double *, double *, const float *, const double *, size_t);
+        void (*replaceShiftedFloat)(double *, double *, const float *, const float *, const double *, size_t);
+        void (*addShiftedRowsFloat)(double *, double *, const float *, size_t, const double *, size_t);
+        void (*removeShiftedRowsFloat)(double *, double *, const float *, size_t, const double *, size_t);
+        void (*replaceShiftedRowsFloat)(double *, double *, const float *, const float *, size_t,
+                                          const double *, size_t);
+        void (*addShiftedInt16)(double *, double *, const int16_t *, const double *, size_t);
+        void (*removeShiftedInt16)(double *, double *, const int16_t *, const double *, size_t);
+        void (*replaceShiftedInt16)(double *, double *, const int16_t *, const int16_t *, const double *, size_t);
+        void (*addShiftedRowsInt16)(double *, double *, const int16_t *, size_t, const double *, size_t);
+        void (*removeShiftedRowsInt16)(double *, double *, const int16_t *, size_t, const double *, size_t);
+        void (*replaceShiftedRowsInt16)(double *, double *, const int16_t *, const int16_t *, size_t,
+                                          const double *, size_t);
+        void (*addShiftedMean)(double *, const double *, const double *, size_t);
+        void (*removeShiftedMean)(double *, const double *, const double *, size_t);
+        void (*replaceShiftedMean)(double *, const double *, const double *, const double *, size_t);
+        void (*addShiftedMeanRows)(double *, const double *, size_t, const double *, size_t);
+        void (*removeShiftedMeanRows)(double *, const double *, size_t, const double *, size_t);
+        void (*replaceShiftedMeanRows)(double *, const double *, const double *, size_t, const double *, size_t);
+        void (*addShifted4)(double *, double *, double *, double *, const double *, const double *, size_t);
+        void (*removeShifted4)(double *, double *, double *, double *, const double *, const double *, size_t);
+        void (*replaceShifted4)(double *, double *, double *, double *, const double *, const double *,
+                                const double *, size_t);
+        void (*addShifted4Rows)(double *, double *, double *, double *, const double *, size_t, const double *,
+                                size_t);
+        void (*removeShifted4Rows)(double *, double *, double *, double *, const double *, size_t, const double *,
+                                   size_t);
+        void (*replaceShifted4Rows)(double *, double *, double *, double *, const double *, const double *, size_t,
+                                    const double *, size_t);
+        void (*mergeShifted)(const double *, double *, double *, const double *, const double *, const double *,
+                             double, size_t);
+        void (*mean)(double *, const double *, const double *, double, size_t);
+        void (*stdDev)(double *, const double *, const double *, double, size_t);
+        void (*recenter)(double *, double *, double *, double, size_t);
+        void (*recenterMean)(double *, double *, double, size_t);
+        void (*recenter4)(double *, double *, double *, double *, double *, double, size_t);
+        void (*skewness)(double *, const double *, const double *, const double *, double, size_t);
+        void (*kurtosis)(double *, const double *, const double *, const double *, const double *, double, size_t);
+        double (*addShiftedScored)(double *, double *, double *, double *, const double *, const double *,
+                                   const double *, double, size_t);
+        double (*replaceShiftedScored)(double *, double *, double *, double *, const double *, const double *,
+                                       const double *, const double *, double, size_t);
+        double (*addShifted4Scored)(double *, double *, double *, double *, double *, double *, const double *,
+                                    const double *, const double *, double, size_t);
+        double (*replaceShifted4Scored)(double *, double *, double *, double *, double *, double *, const double *,
+                                        const double *, const double *, const double *, double, size_t);
+        void (*addDecayed)(double *, double *, const double *, double, double, size_t);
+    };
+
+    /**
+     * Returns the kernel table for an instruction set the CPU supports.
+     */
+    static const KernelTable & tableFor(InstructionSet set);
+
+    /**
+     * Returns the slot holding the active kernel table, initialized on first use.
+     */
+    static const KernelTable *& active();
+
+    /**
+     * The instruction set of the active kernel table.
+     */
+    static InstructionSet & activeSet();
+};
+
+#include "ColumnKernels_impl.h"
@@ -0,0 +1,1312 @@
+#include "ColumnKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define COLUMN_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// The kernels must not be contracted into FMAs, which the AVX-512 target (and -march=native)
+// would otherwise allow, or the instruction sets would no longer agree bit for bit
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace ColumnKernelsDetail {
+
+inline void add_scalar(double *lhs, const double *rhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = lhs[i] + rhs[i];
+}
+
+inline void subtract_scalar(double *lhs, const double *rhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = lhs[i] - rhs[i];
+}
+
+inline void divide_scalar(double *lhs, double constant, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] /= constant;
+}
+
+inline void addScaled_scalar(double *lhs, const double *rhs, double scale, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = lhs[i] + scale * rhs[i];
+}
+
+inline void square_scalar(double *lhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = lhs[i] * lhs[i];
+}
+
+inline void sqrt_scalar(double *lhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = std::sqrt(lhs[i]);
+}
+
+template <class T_value>
+inline void addShifted_scalar(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    double diff;
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        Ex[i] += diff;
+        Ex2[i] += diff*diff;
+    }
+}
+
+template <class T_value>
+inline void removeShifted_scalar(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    double diff;
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        Ex[i] -= diff;
+        Ex2[i] -= diff*diff;
+    }
+}
+
+template <class T_value>
+inline void replaceShifted_scalar(double *Ex, double *Ex2, const T_value *oldRow, const T_value *newRow,
+                                  const double *K, size_t n) {
+    double oldDiff, newDiff;
+    for (size_t i = 0; i < n; i++) {
+        oldDiff = oldRow[i] - K[i];
+        newDiff = newRow[i] - K[i];
+        Ex[i] = (Ex[i] - oldDiff) + newDiff;
+        Ex2[i] = (Ex2[i] - oldDiff*oldDiff) + newDiff*newDiff;
+    }
+}
+
+/**
+ * Bytes of rows the block kernels sweep at a time. Each sweep runs with the columns outer and
+ * the rows inner, holding a lane group of the sums in registers over its rows, so the sums
+ * are loaded and stored once per sweep rather than once per row; the rows of a sweep stay
+ * in L1 while the lane groups walk across them.
+ */
+const size_t sweepBytes = 32768;
+
+/**
+ * Number of rows of n columns in one sweep of the block kernels, at least one.
+ */
+inline size_t sweepRows(size_t n) {
+    return std::max<size_t>(1, sweepBytes / (n * sizeof(double)));
+}
+
+/**
+ * The block kernels over one sweep, with rows stride doubles apart; the SIMD versions also
+ * finish with them the columns left over from their lanes.
+ */
+template <class T_value>
+inline void addShiftedRowsStrided_scalar(double *Ex, double *Ex2, const T_value *rows, size_t numRows, size_t stride,
+                                         const double *K, size_t n) {
+    double diff;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i];
+        for (size_t r = 0; r < numRows; r++) {
+            diff = rows[r*stride + i] - k;
+            ex += diff;
+            ex2 += diff*diff;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+    }
+}
+
+template <class T_value>
+inline void addShiftedRows_scalar(double *Ex, double *Ex2, const T_value *rows, size_t numRows, const double *K,
+                                  size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        addShiftedRowsStrided_scalar(Ex, Ex2, rows + start*n, count, n, K, n);
+    }
+}
+
+template <class T_value>
+inline void removeShiftedRowsStrided_scalar(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                            size_t stride, const double *K, size_t n) {
+    double diff;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i];
+        for (size_t r = 0; r < numRows; r++) {
+            diff = rows[r*stride + i] - k;
+            ex -= diff;
+            ex2 -= diff*diff;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+    }
+}
+
+template <class T_value>
+inline void removeShiftedRows_scalar(double *Ex, double *Ex2, const T_value *rows, size_t numRows, const double *K,
+                                     size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        removeShiftedRowsStrided_scalar(Ex, Ex2, rows + start*n, count, n, K, n);
+    }
+}
+
+template <class T_value>
+inline void replaceShiftedRowsStrided_scalar(double *Ex, double *Ex2, const T_value *oldRows, const T_value *newRows,
+                                             size_t numRows, size_t stride, const double *K, size_t n) {
+    double oldDiff, newDiff;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i];
+        for (size_t r = 0; r < numRows; r++) {
+            oldDiff = oldRows[r*stride + i] - k;
+            newDiff = newRows[r*stride + i] - k;
+            ex = (ex - oldDiff) + newDiff;
+            ex2 = (ex2 - oldDiff*oldDiff) + newDiff*newDiff;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+    }
+}
+
+template <class T_value>
+inline void replaceShiftedRows_scalar(double *Ex, double *Ex2, const T_value *oldRows, const T_value *newRows,
+                                      size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        replaceShiftedRowsStrided_scalar(Ex, Ex2, oldRows + start*n, newRows + start*n, count, n, K, n);
+    }
+}
+
+inline void addShiftedMean_scalar(double *Ex, const double *row, const double *K, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        Ex[i] += row[i] - K[i];
+}
+
+inline void removeShiftedMean_scalar(double *Ex, const double *row, const double *K, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        Ex[i] -= row[i] - K[i];
+}
+
+inline void replaceShiftedMean_scalar(double *Ex, const double *oldRow, const double *newRow, const double *K,
+                                      size_t n) {
+    for (size_t i = 0; i < n; i++)
+        Ex[i] = (Ex[i] - (oldRow[i] - K[i])) + (newRow[i] - K[i]);
+}
+
+inline void addShiftedMeanRowsStrided_scalar(double *Ex, const double *rows, size_t numRows, size_t stride,
+                                             const double *K, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i];
+        for (size_t r = 0; r < numRows; r++)
+            ex += rows[r*stride + i] - k;
+        Ex[i] = ex;
+    }
+}
+
+inline void addShiftedMeanRows_scalar(double *Ex, const double *rows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        addShiftedMeanRowsStrided_scalar(Ex, rows + start*n, count, n, K, n);
+    }
+}
+
+inline void removeShiftedMeanRowsStrided_scalar(double *Ex, const double *rows, size_t numRows, size_t stride,
+                                                const double *K, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i];
+        for (size_t r = 0; r < numRows; r++)
+            ex -= rows[r*stride + i] - k;
+        Ex[i] = ex;
+    }
+}
+
+inline void removeShiftedMeanRows_scalar(double *Ex, const double *rows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        removeShiftedMeanRowsStrided_scalar(Ex, rows + start*n, count, n, K, n);
+    }
+}
+
+inline void replaceShiftedMeanRowsStrided_scalar(double *Ex, const double *oldRows, const double *newRows,
+                                                 size_t numRows, size_t stride, const double *K, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i];
+        for (size_t r = 0; r < numRows; r++)
+            ex = (ex - (oldRows[r*stride + i] - k)) + (newRows[r*stride + i] - k);
+        Ex[i] = ex;
+    }
+}
+
+inline void replaceShiftedMeanRows_scalar(double *Ex, const double *oldRows, const double *newRows, size_t numRows,
+                                          const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        replaceShiftedMeanRowsStrided_scalar(Ex, oldRows + start*n, newRows + start*n, count, n, K, n);
+    }
+}
+
+inline void addShifted4_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row, const double *K,
+                               size_t n) {
+    double diff, diff2;
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        diff2 = diff*diff;
+        Ex[i] += diff;
+        Ex2[i] += diff2;
+        Ex3[i] += diff2*diff;
+        Ex4[i] += diff2*diff2;
+    }
+}
+
+inline void removeShifted4_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row, const double *K,
+                                  size_t n) {
+    double diff, diff2;
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        diff2 = diff*diff;
+        Ex[i] -= diff;
+        Ex2[i] -= diff2;
+        Ex3[i] -= diff2*diff;
+        Ex4[i] -= diff2*diff2;
+    }
+}
+
+inline void replaceShifted4_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRow,
+                                   const double *newRow, const double *K, size_t n) {
+    double oldDiff, newDiff, oldDiff2, newDiff2;
+    for (size_t i = 0; i < n; i++) {
+        oldDiff = oldRow[i] - K[i];
+        newDiff = newRow[i] - K[i];
+        oldDiff2 = oldDiff*oldDiff;
+        newDiff2 = newDiff*newDiff;
+        Ex[i] = (Ex[i] - oldDiff) + newDiff;
+        Ex2[i] = (Ex2[i] - oldDiff2) + newDiff2;
+        Ex3[i] = (Ex3[i] - oldDiff2*oldDiff) + newDiff2*newDiff;
+        Ex4[i] = (Ex4[i] - oldDiff2*oldDiff2) + newDiff2*newDiff2;
+    }
+}
+
+inline void addShifted4RowsStrided_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                          size_t numRows, size_t stride, const double *K, size_t n) {
+    double diff, diff2;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i], ex3 = Ex3[i], ex4 = Ex4[i];
+        for (size_t r = 0; r < numRows; r++) {
+            diff = rows[r*stride + i] - k;
+            diff2 = diff*diff;
+            ex += diff;
+            ex2 += diff2;
+            ex3 += diff2*diff;
+            ex4 += diff2*diff2;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+        Ex3[i] = ex3;
+        Ex4[i] = ex4;
+    }
+}
+
+inline void addShifted4Rows_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                   size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        addShifted4RowsStrided_scalar(Ex, Ex2, Ex3, Ex4, rows + start*n, count, n, K, n);
+    }
+}
+
+inline void removeShifted4RowsStrided_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                             size_t numRows, size_t stride, const double *K, size_t n) {
+    double diff, diff2;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i], ex3 = Ex3[i], ex4 = Ex4[i];
+        for (size_t r = 0; r < numRows; r++) {
+            diff = rows[r*stride + i] - k;
+            diff2 = diff*diff;
+            ex -= diff;
+            ex2 -= diff2;
+            ex3 -= diff2*diff;
+            ex4 -= diff2*diff2;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+        Ex3[i] = ex3;
+        Ex4[i] = ex4;
+    }
+}
+
+inline void removeShifted4Rows_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                      size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        removeShifted4RowsStrided_scalar(Ex, Ex2, Ex3, Ex4, rows + start*n, count, n, K, n);
+    }
+}
+
+inline void replaceShifted4RowsStrided_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                              const double *oldRows, const double *newRows, size_t numRows,
+                                              size_t stride, const double *K, size_t n) {
+    double oldDiff, newDiff, oldDiff2, newDiff2;
+    for (size_t i = 0; i < n; i++) {
+        const double k = K[i];
+        double ex = Ex[i], ex2 = Ex2[i], ex3 = Ex3[i], ex4 = Ex4[i];
+        for (size_t r = 0; r < numRows; r++) {
+            oldDiff = oldRows[r*stride + i] - k;
+            newDiff = newRows[r*stride + i] - k;
+            oldDiff2 = oldDiff*oldDiff;
+            newDiff2 = newDiff*newDiff;
+            ex = (ex - oldDiff) + newDiff;
+            ex2 = (ex2 - oldDiff2) + newDiff2;
+            ex3 = (ex3 - oldDiff2*oldDiff) + newDiff2*newDiff;
+            ex4 = (ex4 - oldDiff2*oldDiff2) + newDiff2*newDiff2;
+        }
+        Ex[i] = ex;
+        Ex2[i] = ex2;
+        Ex3[i] = ex3;
+        Ex4[i] = ex4;
+    }
+}
+
+inline void replaceShifted4Rows_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRows,
+                                       const double *newRows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        replaceShifted4RowsStrided_scalar(Ex, Ex2, Ex3, Ex4, oldRows + start*n, newRows + start*n, count, n, K, n);
+    }
+}
+
+inline void mergeShifted_scalar(const double *KA, double *ExA, double *Ex2A, const double *KB, const double *ExB,
+                               const double *Ex2B, double countB, size_t n) {
+    double shift, countShift;
+    for (size_t i = 0; i < n; i++) {
+        shift = KB[i] - KA[i];
+        countShift = countB * shift;
+        Ex2A[i] = Ex2A[i] + (Ex2B[i] + shift * ((ExB[i] + ExB[i]) + countShift));
+        ExA[i] = ExA[i] + (ExB[i] + countShift);
+    }
+}
+
+inline void mean_scalar(double *mean, const double *K, const double *Ex, double count, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        mean[i] = K[i] + Ex[i] / count;
+}
+
+inline void stdDev_scalar(double *stdDev, const double *Ex, const double *Ex2, double count, size_t n) {
+    double sumSquares;
+    for (size_t i = 0; i < n; i++) {
+        sumSquares = Ex2[i] - (Ex[i]*Ex[i]) / count;
+        // Written to match the SIMD max instructions, which also give 0 for NaN
+        sumSquares = sumSquares > 0.0 ? sumSquares : 0.0;
+        stdDev[i] = std::sqrt(sumSquares / (count - 1));
+    }
+}
+
+inline void recenter_scalar(double *K, double *Ex, double *Ex2, double count, size_t n) {
+    double newK, shift, countShift;
+    for (size_t i = 0; i < n; i++) {
+        newK = K[i] + Ex[i] / count;
+        shift = newK - K[i];
+        countShift = count * shift;
+        Ex2[i] = Ex2[i] - shift * ((Ex[i] + Ex[i]) - countShift);
+        Ex[i] = Ex[i] - countShift;
+        K[i] = newK;
+    }
+}
+
+inline void recenterMean_scalar(double *K, double *Ex, double count, size_t n) {
+    double newK;
+    for (size_t i = 0; i < n; i++) {
+        newK = K[i] + Ex[i] / count;
+        Ex[i] = Ex[i] - count * (newK - K[i]);
+        K[i] = newK;
+    }
+}
+
+inline void recenter4_scalar(double *K, double *Ex, double *Ex2, double *Ex3, double *Ex4, double count, size_t n) {
+    double newK, shift, countShift;
+    for (size_t i = 0; i < n; i++) {
+        newK = K[i] + Ex[i] / count;
+        shift = newK - K[i];
+        countShift = count * shift;
+        // Binomial expansions of the sums of (d - shift)^3 and (d - shift)^4, from the old sums
+        Ex4[i] = Ex4[i] - shift * (4.0 * Ex3[i] - shift * (6.0 * Ex2[i] - shift * (4.0 * Ex[i] - countShift)));
+        Ex3[i] = Ex3[i] - shift * (3.0 * Ex2[i] - shift * (3.0 * Ex[i] - countShift));
+        Ex2[i] = Ex2[i] - shift * ((Ex[i] + Ex[i]) - countShift);
+        Ex[i] = Ex[i] - countShift;
+        K[i] = newK;
+    }
+}
+
+inline void skewness_scalar(double *skewness, const double *Ex, const double *Ex2, const double *Ex3, double count,
+                            size_t n) {
+    double offset, m2, m3;
+    const double rootCount = std::sqrt(count);
+    for (size_t i = 0; i < n; i++) {
+        offset = Ex[i] / count;
+        m2 = Ex2[i] - Ex[i] * offset;
+        m2 = m2 > 0.0 ? m2 : 0.0;
+        m3 = Ex3[i] - offset * (3.0 * Ex2[i] - 2.0 * Ex[i] * offset);
+        skewness[i] = (rootCount * m3) / (m2 * std::sqrt(m2));
+    }
+}
+
+inline void kurtosis_scalar(double *kurtosis, const double *Ex, const double *Ex2, const double *Ex3, const double *Ex4,
+                            double count, size_t n) {
+    double offset, m2, m4;
+    for (size_t i = 0; i < n; i++) {
+        offset = Ex[i] / count;
+        m2 = Ex2[i] - Ex[i] * offset;
+        m2 = m2 > 0.0 ? m2 : 0.0;
+        m4 = Ex4[i] - offset * (4.0 * Ex3[i] - offset * (6.0 * Ex2[i] - 3.0 * Ex[i] * offset));
+        kurtosis[i] = (count * m4) / (m2 * m2) - 3.0;
+    }
+}
+
+/**
+ * Scores one column of a row against the count rows in the shifted-data accumulators, for
+ * the scored kernels: writes the deviation of the row from their mean and their sum of
+ * squared deviations, and returns the excess. inverse is 1 / count, by which the SIMD
+ * versions multiply too, so the offsets agree.
+ */
+inline double scoreShifted_scalar(double &deviation, double &sumSquares, double diff, double Ex, double Ex2,
+                                  double squaredThreshold, double inverse, double count) {
+    const double offset = Ex * inverse;
+    const double squares = Ex2 - Ex * offset;
+    deviation = diff - offset;
+    sumSquares = squares > 0.0 ? squares : 0.0;
+    return (deviation * deviation) * (count - 1) - squaredThreshold * sumSquares;
+}
+
+inline double addShiftedScored_scalar(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                      const double *row, const double *K, const double *squaredThresholds,
+                                      double count, size_t n) {
+    const double inverse = 1.0 / count;
+    double diff, excess;
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        excess = scoreShifted_scalar(deviation[i], sumSquares[i], diff, Ex[i], Ex2[i], squaredThresholds[i],
+                                     inverse, count);
+        largest = largest > excess ? largest : excess;
+        Ex[i] += diff;
+        Ex2[i] += diff*diff;
+    }
+    return largest;
+}
+
+inline double replaceShiftedScored_scalar(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                          const double *oldRow, const double *newRow, const double *K,
+                                          const double *squaredThresholds, double count, size_t n) {
+    const double inverse = 1.0 / count;
+    double oldDiff, newDiff, excess;
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i++) {
+        oldDiff = oldRow[i] - K[i];
+        newDiff = newRow[i] - K[i];
+        excess = scoreShifted_scalar(deviation[i], sumSquares[i], newDiff, Ex[i], Ex2[i], squaredThresholds[i],
+                                     inverse, count);
+        largest = largest > excess ? largest : excess;
+        Ex[i] = (Ex[i] - oldDiff) + newDiff;
+        Ex2[i] = (Ex2[i] - oldDiff*oldDiff) + newDiff*newDiff;
+    }
+    return largest;
+}
+
+inline double addShifted4Scored_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                       double *sumSquares, const double *row, const double *K,
+                                       const double *squaredThresholds, double count, size_t n) {
+    const double inverse = 1.0 / count;
+    double diff, diff2, excess;
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - K[i];
+        diff2 = diff*diff;
+        excess = scoreShifted_scalar(deviation[i], sumSquares[i], diff, Ex[i], Ex2[i], squaredThresholds[i],
+                                     inverse, count);
+        largest = largest > excess ? largest : excess;
+        Ex[i] += diff;
+        Ex2[i] += diff2;
+        Ex3[i] += diff2*diff;
+        Ex4[i] += diff2*diff2;
+    }
+    return largest;
+}
+
+inline double replaceShifted4Scored_scalar(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                           double *sumSquares, const double *oldRow, const double *newRow,
+                                           const double *K, const double *squaredThresholds, double count,
+                                           size_t n) {
+    const double inverse = 1.0 / count;
+    double oldDiff, newDiff, oldDiff2, newDiff2, excess;
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i++) {
+        oldDiff = oldRow[i] - K[i];
+        newDiff = newRow[i] - K[i];
+        oldDiff2 = oldDiff*oldDiff;
+        newDiff2 = newDiff*newDiff;
+        excess = scoreShifted_scalar(deviation[i], sumSquares[i], newDiff, Ex[i], Ex2[i], squaredThresholds[i],
+                                     inverse, count);
+        largest = largest > excess ? largest : excess;
+        Ex[i] = (Ex[i] - oldDiff) + newDiff;
+        Ex2[i] = (Ex2[i] - oldDiff2) + newDiff2;
+        Ex3[i] = (Ex3[i] - oldDiff2*oldDiff) + newDiff2*newDiff;
+        Ex4[i] = (Ex4[i] - oldDiff2*oldDiff2) + newDiff2*newDiff2;
+    }
+    return largest;
+}
+
+inline void addDecayed_scalar(double *mean, double *variance, const double *row, double alpha, double retain,
+                              size_t n) {
+    double diff, step;
+    for (size_t i = 0; i < n; i++) {
+        diff = row[i] - mean[i];
+        step = alpha * diff;
+        mean[i] = mean[i] + step;
+        variance[i] = retain * (variance[i] + diff * step);
+    }
+}
+
+/**
+ * Number of columns of a narrow row widened to double at a time, in a buffer on the stack.
+ */
+const size_t widenChunk = 256;
+
+template <class T_value>
+inline void widen(double *wide, const T_value *narrow, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        wide[i] = static_cast<double>(narrow[i]);
+}
+
+} // namespace ColumnKernelsDetail
+
+#ifdef COLUMN_KERNELS_X86
+
+#define CK_NAME(name) name##_sse2
+#define CK_TARGET __attribute__((target("sse2")))
+#define CK_VEC __m128d
+#define CK_LANES 2
+#define CK_LOAD _mm_loadu_pd
+#define CK_STORE _mm_storeu_pd
+#define CK_LOAD_FLOAT(p) _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))))
+#define CK_LOAD_INT16(p) _mm_set_pd((p)[1], (p)[0])
+#define CK_SET1 _mm_set1_pd
+#define CK_ADD _mm_add_pd
+#define CK_SUB _mm_sub_pd
+#define CK_MUL _mm_mul_pd
+#define CK_DIV _mm_div_pd
+#define CK_MAX _mm_max_pd
+#define CK_SQRT _mm_sqrt_pd
+#include "ColumnKernels_isa.h"
+#undef CK_NAME
+#undef CK_TARGET
+#undef CK_VEC
+#undef CK_LANES
+#undef CK_LOAD
+#undef CK_STORE
+#undef CK_LOAD_FLOAT
+#undef CK_LOAD_INT16
+#undef CK_SET1
+#undef CK_ADD
+#undef CK_SUB
+#undef CK_MUL
+#undef CK_DIV
+#undef CK_MAX
+#undef CK_SQRT
+
+#define CK_NAME(name) name##_avx2
+#define CK_TARGET __attribute__((target("avx2")))
+#define CK_VEC __m256d
+#define CK_LANES 4
+#define CK_LOAD _mm256_loadu_pd
+#define CK_STORE _mm256_storeu_pd
+#define CK_LOAD_FLOAT(p) _mm256_cvtps_pd(_mm_loadu_ps(p))
+#define CK_LOAD_INT16(p) _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))))
+#define CK_SET1 _mm256_set1_pd
+#define CK_ADD _mm256_add_pd
+#define CK_SUB _mm256_sub_pd
+#define CK_MUL _mm256_mul_pd
+#define CK_DIV _mm256_div_pd
+#define CK_MAX _mm256_max_pd
+#define CK_SQRT _mm256_sqrt_pd
+#include "ColumnKernels_isa.h"
+#undef CK_NAME
+#undef CK_TARGET
+#undef CK_VEC
+#undef CK_LANES
+#undef CK_LOAD
+#undef CK_STORE
+#undef CK_LOAD_FLOAT
+#undef CK_LOAD_INT16
+#undef CK_SET1
+#undef CK_ADD
+#undef CK_SUB
+#undef CK_MUL
+#undef CK_DIV
+#undef CK_MAX
+#undef CK_SQRT
+
+#define CK_NAME(name) name##_avx512
+#define CK_TARGET __attribute__((target("avx512f")))
+#define CK_VEC __m512d
+#define CK_LANES 8
+#define CK_LOAD _mm512_loadu_pd
+#define CK_STORE _mm512_storeu_pd
+#define CK_SET1 _mm512_set1_pd
+#define CK_ADD _mm512_add_pd
+#define CK_SUB _mm512_sub_pd
+#define CK_MUL _mm512_mul_pd
+#define CK_DIV _mm512_div_pd
+// _mm512_sqrt_pd, _mm512_max_pd and the conversions pass an undefined vector as the masked-off source, which
+// GCC 12 reports as -Wmaybe-uninitialized at -O2; with every lane selected the source is never read anyway
+#define CK_MAX(x, y) _mm512_mask_max_pd((x), (__mmask8)-1, (x), (y))
+#define CK_SQRT(x) _mm512_mask_sqrt_pd((x), (__mmask8)-1, (x))
+#define CK_LOAD_FLOAT(p) _mm512_mask_cvtps_pd(_mm512_setzero_pd(), (__mmask8)-1, _mm256_loadu_ps(p))
+#define CK_LOAD_INT16(p) _mm512_mask_cvtepi32_pd(_mm512_setzero_pd(), (__mmask8)-1, \
+        _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))))
+#include "ColumnKernels_isa.h"
+#undef CK_NAME
+#undef CK_TARGET
+#undef CK_VEC
+#undef CK_LANES
+#undef CK_LOAD
+#undef CK_STORE
+#undef CK_LOAD_FLOAT
+#undef CK_LOAD_INT16
+#undef CK_SET1
+#undef CK_ADD
+#undef CK_SUB
+#undef CK_MUL
+#undef CK_DIV
+#undef CK_MAX
+#undef CK_SQRT
+
+#endif // COLUMN_KERNELS_X86
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#define COLUMN_KERNELS_TABLE(suffix) { \
+    ColumnKernelsDetail::add_##suffix, \
+    ColumnKernelsDetail::subtract_##suffix, \
+    ColumnKernelsDetail::divide_##suffix, \
+    ColumnKernelsDetail::addScaled_##suffix, \
+    ColumnKernelsDetail::square_##suffix, \
+    ColumnKernelsDetail::sqrt_##suffix, \
+    ColumnKernelsDetail::addShifted_##suffix, \
+    ColumnKernelsDetail::removeShifted_##suffix, \
+    ColumnKernelsDetail::replaceShifted_##suffix, \
+    ColumnKernelsDetail::addShiftedRows_##suffix, \
+    ColumnKernelsDetail::removeShiftedRows_##suffix, \
+    ColumnKernelsDetail::replaceShiftedRows_##suffix, \
+    ColumnKernelsDetail::addShifted_##suffix<float>, \
+    ColumnKernelsDetail::removeShifted_##suffix<float>, \
+    ColumnKernelsDetail::replaceShifted_##suffix<float>, \
+    ColumnKernelsDetail::addShiftedRows_##suffix<float>, \
+    ColumnKernelsDetail::removeShiftedRows_##suffix<float>, \
+    ColumnKernelsDetail::replaceShiftedRows_##suffix<float>, \
+    ColumnKernelsDetail::addShifted_##suffix<int16_t>, \
+    ColumnKernelsDetail::removeShifted_##suffix<int16_t>, \
+    ColumnKernelsDetail::replaceShifted_##suffix<int16_t>, \
+    ColumnKernelsDetail::addShiftedRows_##suffix<int16_t>, \
+    ColumnKernelsDetail::removeShiftedRows_##suffix<int16_t>, \
+    ColumnKernelsDetail::replaceShiftedRows_##suffix<int16_t>, \
+    ColumnKernelsDetail::addShiftedMean_##suffix, \
+    ColumnKernelsDetail::removeShiftedMean_##suffix, \
+    ColumnKernelsDetail::replaceShiftedMean_##suffix, \
+    ColumnKernelsDetail::addShiftedMeanRows_##suffix, \
+    ColumnKernelsDetail::removeShiftedMeanRows_##suffix, \
+    ColumnKernelsDetail::replaceShiftedMeanRows_##suffix, \
+    ColumnKernelsDetail::addShifted4_##suffix, \
+    ColumnKernelsDetail::removeShifted4_##suffix, \
+    ColumnKernelsDetail::replaceShifted4_##suffix, \
+    ColumnKernelsDetail::addShifted4Rows_##suffix, \
+    ColumnKernelsDetail::removeShifted4Rows_##suffix, \
+    ColumnKernelsDetail::replaceShifted4Rows_##suffix, \
+    ColumnKernelsDetail::mergeShifted_##suffix, \
+    ColumnKernelsDetail::mean_##suffix, \
+    ColumnKernelsDetail::stdDev_##suffix, \
+    ColumnKernelsDetail::recenter_##suffix, \
+    ColumnKernelsDetail::recenterMean_##suffix, \
+    ColumnKernelsDetail::recenter4_##suffix, \
+    ColumnKernelsDetail::skewness_##suffix, \
+    ColumnKernelsDetail::kurtosis_##suffix, \
+    ColumnKernelsDetail::addShiftedScored_##suffix, \
+    ColumnKernelsDetail::replaceShiftedScored_##suffix, \
+    ColumnKernelsDetail::addShifted4Scored_##suffix, \
+    ColumnKernelsDetail::replaceShifted4Scored_##suffix, \
+    ColumnKernelsDetail::addDecayed_##suffix }
+
+inline ColumnKernels::InstructionSet ColumnKernels::supportedInstructionSet() {
+#ifdef COLUMN_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return Scalar;
+}
+
+inline ColumnKernels::InstructionSet ColumnKernels::activeInstructionSet() {
+    active(); // make sure the dispatch has been initialized
+    return activeSet();
+}
+
+inline ColumnKernels::InstructionSet ColumnKernels::setInstructionSet(InstructionSet requested) {
+    InstructionSet supported = supportedInstructionSet();
+    InstructionSet set = requested < supported ? requested : supported;
+    active() = &tableFor(set);
+    activeSet() = set;
+    return set;
+}
+
+inline const char * ColumnKernels::instructionSetName(InstructionSet set) {
+    switch (set) {
+        case SSE2:   return "sse2";
+        case AVX2:   return "avx2";
+        case AVX512: return "avx512";
+        default:     return "scalar";
+    }
+}
+
+inline const ColumnKernels::KernelTable & ColumnKernels::tableFor(InstructionSet set) {
+    static const KernelTable scalar = COLUMN_KERNELS_TABLE(scalar);
+#ifdef COLUMN_KERNELS_X86
+    static const KernelTable sse2 = COLUMN_KERNELS_TABLE(sse2);
+    static const KernelTable avx2 = COLUMN_KERNELS_TABLE(avx2);
+    static const KernelTable avx512 = COLUMN_KERNELS_TABLE(avx512);
+    switch (set) {
+        case SSE2:   return sse2;
+        case AVX2:   return avx2;
+        case AVX512: return avx512;
+        default:     break;
+    }
+#endif
+    (void)set;
+    return scalar;
+}
+
+inline const ColumnKernels::KernelTable *& ColumnKernels::active() {
+    static const KernelTable *table = &tableFor(activeSet());
+    return table;
+}
+
+inline ColumnKernels::InstructionSet & ColumnKernels::activeSet() {
+    static InstructionSet set = supportedInstructionSet();
+    return set;
+}
+
+#undef COLUMN_KERNELS_TABLE
+
+inline void ColumnKernels::add(double *lhs, const double *rhs, size_t n) {
+    active()->add(lhs, rhs, n);
+}
+
+inline void ColumnKernels::subtract(double *lhs, const double *rhs, size_t n) {
+    active()->subtract(lhs, rhs, n);
+}
+
+inline void ColumnKernels::divide(double *lhs, double constant, size_t n) {
+    active()->divide(lhs, constant, n);
+}
+
+inline void ColumnKernels::addScaled(double *lhs, const double *rhs, double scale, size_t n) {
+    active()->addScaled(lhs, rhs, scale, n);
+}
+
+inline void ColumnKernels::square(double *lhs, size_t n) {
+    active()->square(lhs, n);
+}
+
+inline void ColumnKernels::sqrt(double *lhs, size_t n) {
+    active()->sqrt(lhs, n);
+}
+
+inline void ColumnKernels::addShifted(double *Ex, double *Ex2, const double *row, const double *K, size_t n) {
+    active()->addShifted(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::removeShifted(double *Ex, double *Ex2, const double *row, const double *K, size_t n) {
+    active()->removeShifted(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::replaceShifted(double *Ex, double *Ex2, const double *oldRow, const double *newRow,
+                                          const double *K, size_t n) {
+    active()->replaceShifted(Ex, Ex2, oldRow, newRow, K, n);
+}
+
+inline size_t ColumnKernels::sweepRows(size_t n) {
+    return ColumnKernelsDetail::sweepRows(n);
+}
+
+inline void ColumnKernels::addShiftedRows(double *Ex, double *Ex2, const double *rows, size_t numRows,
+                                          const double *K, size_t n) {
+    active()->addShiftedRows(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::removeShiftedRows(double *Ex, double *Ex2, const double *rows, size_t numRows,
+                                             const double *K, size_t n) {
+    active()->removeShiftedRows(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::replaceShiftedRows(double *Ex, double *Ex2, const double *oldRows, const double *newRows,
+                                              size_t numRows, const double *K, size_t n) {
+    active()->replaceShiftedRows(Ex, Ex2, oldRows, newRows, numRows, K, n);
+}
+
+inline void ColumnKernels::addShiftedMean(double *Ex, const double *row, const double *K, size_t n) {
+    active()->addShiftedMean(Ex, row, K, n);
+}
+
+inline void ColumnKernels::removeShiftedMean(double *Ex, const double *row, const double *K, size_t n) {
+    active()->removeShiftedMean(Ex, row, K, n);
+}
+
+inline void ColumnKernels::replaceShiftedMean(double *Ex, const double *oldRow, const double *newRow, const double *K,
+                                              size_t n) {
+    active()->replaceShiftedMean(Ex, oldRow, newRow, K, n);
+}
+
+inline void ColumnKernels::addShiftedMeanRows(double *Ex, const double *rows, size_t numRows, const double *K,
+                                              size_t n) {
+    active()->addShiftedMeanRows(Ex, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::removeShiftedMeanRows(double *Ex, const double *rows, size_t numRows, const double *K,
+                                                 size_t n) {
+    active()->removeShiftedMeanRows(Ex, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::replaceShiftedMeanRows(double *Ex, const double *oldRows, const double *newRows,
+                                                  size_t numRows, const double *K, size_t n) {
+    active()->replaceShiftedMeanRows(Ex, oldRows, newRows, numRows, K, n);
+}
+
+inline void ColumnKernels::addShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row,
+                                       const double *K, size_t n) {
+    active()->addShifted4(Ex, Ex2, Ex3, Ex4, row, K, n);
+}
+
+inline void ColumnKernels::removeShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row,
+                                          const double *K, size_t n) {
+    active()->removeShifted4(Ex, Ex2, Ex3, Ex4, row, K, n);
+}
+
+inline void ColumnKernels::replaceShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRow,
+                                           const double *newRow, const double *K, size_t n) {
+    active()->replaceShifted4(Ex, Ex2, Ex3, Ex4, oldRow, newRow, K, n);
+}
+
+inline void ColumnKernels::addShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                           size_t numRows, const double *K, size_t n) {
+    active()->addShifted4Rows(Ex, Ex2, Ex3, Ex4, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::removeShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *rows,
+                                              size_t numRows, const double *K, size_t n) {
+    active()->removeShifted4Rows(Ex, Ex2, Ex3, Ex4, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::replaceShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRows,
+                                               const double *newRows, size_t numRows, const double *K, size_t n) {
+    active()->replaceShifted4Rows(Ex, Ex2, Ex3, Ex4, oldRows, newRows, numRows, K, n);
+}
+
+inline void ColumnKernels::mergeShifted(const double *KA, double *ExA, double *Ex2A, const double *KB,
+                                        const double *ExB, const double *Ex2B, double countB, size_t n) {
+    active()->mergeShifted(KA, ExA, Ex2A, KB, ExB, Ex2B, countB, n);
+}
+
+inline void ColumnKernels::mean(double *mean, const double *K, const double *Ex, double count, size_t n) {
+    active()->mean(mean, K, Ex, count, n);
+}
+
+inline void ColumnKernels::stdDev(double *stdDev, const double *Ex, const double *Ex2, double count, size_t n) {
+    active()->stdDev(stdDev, Ex, Ex2, count, n);
+}
+
+inline void ColumnKernels::recenter(double *K, double *Ex, double *Ex2, double count, size_t n) {
+    active()->recenter(K, Ex, Ex2, count, n);
+}
+
+inline void ColumnKernels::recenterMean(double *K, double *Ex, double count, size_t n) {
+    active()->recenterMean(K, Ex, count, n);
+}
+
+inline void ColumnKernels::recenter4(double *K, double *Ex, double *Ex2, double *Ex3, double *Ex4, double count,
+                                     size_t n) {
+    active()->recenter4(K, Ex, Ex2, Ex3, Ex4, count, n);
+}
+
+inline void ColumnKernels::skewness(double *skewness, const double *Ex, const double *Ex2, const double *Ex3,
+                                    double count, size_t n) {
+    active()->skewness(skewness, Ex, Ex2, Ex3, count, n);
+}
+
+inline void ColumnKernels::kurtosis(double *kurtosis, const double *Ex, const double *Ex2, const double *Ex3,
+                                    const double *Ex4, double count, size_t n) {
+    active()->kurtosis(kurtosis, Ex, Ex2, Ex3, Ex4, count, n);
+}
+
+inline double ColumnKernels::addShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                              const double *row, const double *K, const double *squaredThresholds,
+                                              double count, size_t n) {
+    return active()->addShiftedScored(Ex, Ex2, deviation, sumSquares, row, K, squaredThresholds, count, n);
+}
+
+inline double ColumnKernels::replaceShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                                  const double *oldRow, const double *newRow, const double *K,
+                                                  const double *squaredThresholds, double count, size_t n) {
+    return active()->replaceShiftedScored(Ex, Ex2, deviation, sumSquares, oldRow, newRow, K, squaredThresholds,
+                                          count, n);
+}
+
+inline double ColumnKernels::addShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                               double *sumSquares, const double *row, const double *K,
+                                               const double *squaredThresholds, double count, size_t n) {
+    return active()->addShifted4Scored(Ex, Ex2, Ex3, Ex4, deviation, sumSquares, row, K, squaredThresholds, count,
+                                       n);
+}
+
+inline double ColumnKernels::replaceShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                   double *deviation, double *sumSquares, const double *oldRow,
+                                                   const double *newRow, const double *K,
+                                                   const double *squaredThresholds, double count, size_t n) {
+    return active()->replaceShifted4Scored(Ex, Ex2, Ex3, Ex4, deviation, sumSquares, oldRow, newRow, K,
+                                           squaredThresholds, count, n);
+}
+
+inline void ColumnKernels::addDecayed(double *mean, double *variance, const double *row, double alpha, size_t n) {
+    active()->addDecayed(mean, variance, row, alpha, 1 - alpha, n);
+}
+
+inline void ColumnKernels::addShifted(double *Ex, double *Ex2, const float *row, const double *K, size_t n) {
+    active()->addShiftedFloat(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::removeShifted(double *Ex, double *Ex2, const float *row, const double *K, size_t n) {
+    active()->removeShiftedFloat(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::replaceShifted(double *Ex, double *Ex2, const float *oldRow, const float *newRow,
+                                          const double *K, size_t n) {
+    active()->replaceShiftedFloat(Ex, Ex2, oldRow, newRow, K, n);
+}
+
+inline void ColumnKernels::addShiftedRows(double *Ex, double *Ex2, const float *rows, size_t numRows, const double *K,
+                                          size_t n) {
+    active()->addShiftedRowsFloat(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::removeShiftedRows(double *Ex, double *Ex2, const float *rows, size_t numRows,
+                                             const double *K, size_t n) {
+    active()->removeShiftedRowsFloat(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::replaceShiftedRows(double *Ex, double *Ex2, const float *oldRows, const float *newRows,
+                                              size_t numRows, const double *K, size_t n) {
+    active()->replaceShiftedRowsFloat(Ex, Ex2, oldRows, newRows, numRows, K, n);
+}
+
+inline void ColumnKernels::addShifted(double *Ex, double *Ex2, const int16_t *row, const double *K, size_t n) {
+    active()->addShiftedInt16(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::removeShifted(double *Ex, double *Ex2, const int16_t *row, const double *K, size_t n) {
+    active()->removeShiftedInt16(Ex, Ex2, row, K, n);
+}
+
+inline void ColumnKernels::replaceShifted(double *Ex, double *Ex2, const int16_t *oldRow, const int16_t *newRow,
+                                          const double *K, size_t n) {
+    active()->replaceShiftedInt16(Ex, Ex2, oldRow, newRow, K, n);
+}
+
+inline void ColumnKernels::addShiftedRows(double *Ex, double *Ex2, const int16_t *rows, size_t numRows, const double *K,
+                                          size_t n) {
+    active()->addShiftedRowsInt16(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::removeShiftedRows(double *Ex, double *Ex2, const int16_t *rows, size_t numRows,
+                                             const double *K, size_t n) {
+    active()->removeShiftedRowsInt16(Ex, Ex2, rows, numRows, K, n);
+}
+
+inline void ColumnKernels::replaceShiftedRows(double *Ex, double *Ex2, const int16_t *oldRows, const int16_t *newRows,
+                                              size_t numRows, const double *K, size_t n) {
+    active()->replaceShiftedRowsInt16(Ex, Ex2, oldRows, newRows, numRows, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::addShifted(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->addShifted(Ex + i, Ex2 + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShifted(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->removeShifted(Ex + i, Ex2 + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShifted(double *Ex, double *Ex2, const T_value *oldRow, const T_value *newRow,
+                                          const double *K, size_t n) {
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wideOld, oldRow + i, chunk);
+        ColumnKernelsDetail::widen(wideNew, newRow + i, chunk);
+        active()->replaceShifted(Ex + i, Ex2 + i, wideOld, wideNew, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::addShiftedRows(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                          const double *K, size_t n) {
+    if (n > ColumnKernelsDetail::widenChunk) {
+        for (size_t r = 0; r < numRows; r++)
+            addShifted(Ex, Ex2, rows + r*n, K, n);
+        return;
+    }
+    // As many whole rows as fit are widened together and passed to the double kernel at once
+    double wide[ColumnKernelsDetail::widenChunk];
+    const size_t rowsPerChunk = ColumnKernelsDetail::widenChunk / n;
+    for (size_t r = 0; r < numRows; r += rowsPerChunk) {
+        const size_t chunk = std::min(rowsPerChunk, numRows - r);
+        ColumnKernelsDetail::widen(wide, rows + r*n, chunk*n);
+        active()->addShiftedRows(Ex, Ex2, wide, chunk, K, n);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShiftedRows(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                             const double *K, size_t n) {
+    if (n > ColumnKernelsDetail::widenChunk) {
+        for (size_t r = 0; r < numRows; r++)
+            removeShifted(Ex, Ex2, rows + r*n, K, n);
+        return;
+    }
+    double wide[ColumnKernelsDetail::widenChunk];
+    const size_t rowsPerChunk = ColumnKernelsDetail::widenChunk / n;
+    for (size_t r = 0; r < numRows; r += rowsPerChunk) {
+        const size_t chunk = std::min(rowsPerChunk, numRows - r);
+        ColumnKernelsDetail::widen(wide, rows + r*n, chunk*n);
+        active()->removeShiftedRows(Ex, Ex2, wide, chunk, K, n);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShiftedRows(double *Ex, double *Ex2, const T_value *oldRows, const T_value *newRows,
+                                              size_t numRows, const double *K, size_t n) {
+    if (n > ColumnKernelsDetail::widenChunk) {
+        for (size_t r = 0; r < numRows; r++)
+            replaceShifted(Ex, Ex2, oldRows + r*n, newRows + r*n, K, n);
+        return;
+    }
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    const size_t rowsPerChunk = ColumnKernelsDetail::widenChunk / n;
+    for (size_t r = 0; r < numRows; r += rowsPerChunk) {
+        const size_t chunk = std::min(rowsPerChunk, numRows - r);
+        ColumnKernelsDetail::widen(wideOld, oldRows + r*n, chunk*n);
+        ColumnKernelsDetail::widen(wideNew, newRows + r*n, chunk*n);
+        active()->replaceShiftedRows(Ex, Ex2, wideOld, wideNew, chunk, K, n);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::addShiftedMean(double *Ex, const T_value *row, const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->addShiftedMean(Ex + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShiftedMean(double *Ex, const T_value *row, const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->removeShiftedMean(Ex + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShiftedMean(double *Ex, const T_value *oldRow, const T_value *newRow, const double *K,
+                                              size_t n) {
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wideOld, oldRow + i, chunk);
+        ColumnKernelsDetail::widen(wideNew, newRow + i, chunk);
+        active()->replaceShiftedMean(Ex + i, wideOld, wideNew, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::addShiftedMeanRows(double *Ex, const T_value *rows, size_t numRows, const double *K,
+                                              size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        addShiftedMean(Ex, rows + r*n, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShiftedMeanRows(double *Ex, const T_value *rows, size_t numRows, const double *K,
+                                                 size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        removeShiftedMean(Ex, rows + r*n, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShiftedMeanRows(double *Ex, const T_value *oldRows, const T_value *newRows,
+                                                  size_t numRows, const double *K, size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        replaceShiftedMean(Ex, oldRows + r*n, newRows + r*n, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::addShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *row,
+                                       const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->addShifted4(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *row,
+                                          const double *K, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        active()->removeShifted4(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, wide, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShifted4(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *oldRow,
+                                           const T_value *newRow, const double *K, size_t n) {
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wideOld, oldRow + i, chunk);
+        ColumnKernelsDetail::widen(wideNew, newRow + i, chunk);
+        active()->replaceShifted4(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, wideOld, wideNew, K + i, chunk);
+    }
+}
+
+template <class T_value>
+inline void ColumnKernels::addShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *rows,
+                                           size_t numRows, const double *K, size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        addShifted4(Ex, Ex2, Ex3, Ex4, rows + r*n, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::removeShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *rows,
+                                              size_t numRows, const double *K, size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        removeShifted4(Ex, Ex2, Ex3, Ex4, rows + r*n, K, n);
+}
+
+template <class T_value>
+inline void ColumnKernels::replaceShifted4Rows(double *Ex, double *Ex2, double *Ex3, double *Ex4, const T_value *oldRows,
+                                               const T_value *newRows, size_t numRows, const double *K, size_t n) {
+    for (size_t r = 0; r < numRows; r++)
+        replaceShifted4(Ex, Ex2, Ex3, Ex4, oldRows + r*n, newRows + r*n, K, n);
+}
+
+template <class T_value>
+inline double ColumnKernels::addShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                              const T_value *row, const double *K, const double *squaredThresholds,
+                                              double count, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        largest = std::max(largest, active()->addShiftedScored(Ex + i, Ex2 + i, deviation + i, sumSquares + i, wide,
+                                                               K + i, squaredThresholds + i, count, chunk));
+    }
+    return largest;
+}
+
+template <class T_value>
+inline double ColumnKernels::replaceShiftedScored(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                                  const T_value *oldRow, const T_value *newRow, const double *K,
+                                                  const double *squaredThresholds, double count, size_t n) {
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wideOld, oldRow + i, chunk);
+        ColumnKernelsDetail::widen(wideNew, newRow + i, chunk);
+        largest = std::max(largest, active()->replaceShiftedScored(Ex + i, Ex2 + i, deviation + i, sumSquares + i,
+                                                                   wideOld, wideNew, K + i, squaredThresholds + i,
+                                                                   count, chunk));
+    }
+    return largest;
+}
+
+template <class T_value>
+inline double ColumnKernels::addShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4, double *deviation,
+                                               double *sumSquares, const T_value *row, const double *K,
+                                               const double *squaredThresholds, double count, size_t n) {
+    double wide[ColumnKernelsDetail::widenChunk];
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wide, row + i, chunk);
+        largest = std::max(largest, active()->addShifted4Scored(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, deviation + i,
+                                                                sumSquares + i, wide, K + i, squaredThresholds + i,
+                                                                count, chunk));
+    }
+    return largest;
+}
+
+template <class T_value>
+inline double ColumnKernels::replaceShifted4Scored(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                   double *deviation, double *sumSquares, const T_value *oldRow,
+                                                   const T_value *newRow, const double *K,
+                                                   const double *squaredThresholds, double count, size_t n) {
+    double wideOld[ColumnKernelsDetail::widenChunk], wideNew[ColumnKernelsDetail::widenChunk];
+    double largest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; i += ColumnKernelsDetail::widenChunk) {
+        const size_t chunk = std::min(ColumnKernelsDetail::widenChunk, n - i);
+        ColumnKernelsDetail::widen(wideOld, oldRow + i, chunk);
+        ColumnKernelsDetail::widen(wideNew, newRow + i, chunk);
+        largest = std::max(largest, active()->replaceShifted4Scored(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i,
+                                                                    deviation + i, sumSquares + i, wideOld, wideNew,
+                                                                    K + i, squaredThresholds + i, count, chunk));
+    }
+    return largest;
+}
@@ -0,0 +1,905 @@
+/* Kernel bodies for one SIMD instruction set. This file is included several
+ * times by ColumnKernels_impl.h, once per instruction set, with the CK_* macros
+ * below defined. Do not include it directly.
+ *
+ * Each kernel runs the vector loop over as many full lanes as fit, then
+ * finishes the remaining columns with the scalar kernel, which performs the
+ * same operations in the same order.
+ *
+ * CK_NAME(name)   appends the instruction set suffix to a kernel name
+ * CK_TARGET       function attribute enabling the instruction set
+ * CK_VEC          vector type holding CK_LANES doubles
+ * CK_LOAD/STORE   unaligned load/store
+ * CK_LOAD_FLOAT/INT16  unaligned load of CK_LANES floats or int16_ts, converted to doubles
+ * CK_SET1         broadcast a double to every lane
+ * CK_ADD/SUB/MUL/DIV/MAX/SQRT  lanewise arithmetic
+ */
+
+namespace ColumnKernelsDetail {
+
+CK_TARGET inline void CK_NAME(add)(double *lhs, const double *rhs, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(lhs + i, CK_ADD(CK_LOAD(lhs + i), CK_LOAD(rhs + i)));
+    add_scalar(lhs + i, rhs + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(subtract)(double *lhs, const double *rhs, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(lhs + i, CK_SUB(CK_LOAD(lhs + i), CK_LOAD(rhs + i)));
+    subtract_scalar(lhs + i, rhs + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(divide)(double *lhs, double constant, size_t n) {
+    const CK_VEC c = CK_SET1(constant);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(lhs + i, CK_DIV(CK_LOAD(lhs + i), c));
+    divide_scalar(lhs + i, constant, n - i);
+}
+
+CK_TARGET inline void CK_NAME(addScaled)(double *lhs, const double *rhs, double scale, size_t n) {
+    const CK_VEC s = CK_SET1(scale);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(lhs + i, CK_ADD(CK_LOAD(lhs + i), CK_MUL(s, CK_LOAD(rhs + i))));
+    addScaled_scalar(lhs + i, rhs + i, scale, n - i);
+}
+
+CK_TARGET inline void CK_NAME(square)(double *lhs, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC x = CK_LOAD(lhs + i);
+        CK_STORE(lhs + i, CK_MUL(x, x));
+    }
+    square_scalar(lhs + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(sqrt)(double *lhs, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(lhs + i, CK_SQRT(CK_LOAD(lhs + i)));
+    sqrt_scalar(lhs + i, n - i);
+}
+
+// Loads CK_LANES columns of a row as doubles; narrow rows are converted in registers, exactly
+CK_TARGET inline CK_VEC CK_NAME(loadRow)(const double *row) {
+    return CK_LOAD(row);
+}
+
+CK_TARGET inline CK_VEC CK_NAME(loadRow)(const float *row) {
+    return CK_LOAD_FLOAT(row);
+}
+
+CK_TARGET inline CK_VEC CK_NAME(loadRow)(const int16_t *row) {
+    return CK_LOAD_INT16(row);
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(addShifted)(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_NAME(loadRow)(row + i), CK_LOAD(K + i));
+        CK_STORE(Ex + i, CK_ADD(CK_LOAD(Ex + i), diff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_LOAD(Ex2 + i), CK_MUL(diff, diff)));
+    }
+    addShifted_scalar(Ex + i, Ex2 + i, row + i, K + i, n - i);
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(removeShifted)(double *Ex, double *Ex2, const T_value *row, const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_NAME(loadRow)(row + i), CK_LOAD(K + i));
+        CK_STORE(Ex + i, CK_SUB(CK_LOAD(Ex + i), diff));
+        CK_STORE(Ex2 + i, CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(diff, diff)));
+    }
+    removeShifted_scalar(Ex + i, Ex2 + i, row + i, K + i, n - i);
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(replaceShifted)(double *Ex, double *Ex2, const T_value *oldRow, const T_value *newRow,
+                                              const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC oldDiff = CK_SUB(CK_NAME(loadRow)(oldRow + i), k);
+        CK_VEC newDiff = CK_SUB(CK_NAME(loadRow)(newRow + i), k);
+        CK_STORE(Ex + i, CK_ADD(CK_SUB(CK_LOAD(Ex + i), oldDiff), newDiff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(oldDiff, oldDiff)),
+                                 CK_MUL(newDiff, newDiff)));
+    }
+    replaceShifted_scalar(Ex + i, Ex2 + i, oldRow + i, newRow + i, K + i, n - i);
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(addShiftedRows)(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                              const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const T_value *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_NAME(loadRow)(block + r*n + i), k);
+                ex = CK_ADD(ex, diff);
+                ex2 = CK_ADD(ex2, CK_MUL(diff, diff));
+                CK_VEC diffHi = CK_SUB(CK_NAME(loadRow)(block + r*n + i + CK_LANES), kHi);
+                exHi = CK_ADD(exHi, diffHi);
+                ex2Hi = CK_ADD(ex2Hi, CK_MUL(diffHi, diffHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_NAME(loadRow)(block + r*n + i), k);
+                ex = CK_ADD(ex, diff);
+                ex2 = CK_ADD(ex2, CK_MUL(diff, diff));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+        }
+        addShiftedRowsStrided_scalar(Ex + i, Ex2 + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(removeShiftedRows)(double *Ex, double *Ex2, const T_value *rows, size_t numRows,
+                                                 const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const T_value *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_NAME(loadRow)(block + r*n + i), k);
+                ex = CK_SUB(ex, diff);
+                ex2 = CK_SUB(ex2, CK_MUL(diff, diff));
+                CK_VEC diffHi = CK_SUB(CK_NAME(loadRow)(block + r*n + i + CK_LANES), kHi);
+                exHi = CK_SUB(exHi, diffHi);
+                ex2Hi = CK_SUB(ex2Hi, CK_MUL(diffHi, diffHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_NAME(loadRow)(block + r*n + i), k);
+                ex = CK_SUB(ex, diff);
+                ex2 = CK_SUB(ex2, CK_MUL(diff, diff));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+        }
+        removeShiftedRowsStrided_scalar(Ex + i, Ex2 + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+template <class T_value>
+CK_TARGET inline void CK_NAME(replaceShiftedRows)(double *Ex, double *Ex2, const T_value *oldRows,
+                                                  const T_value *newRows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const T_value *oldBlock = oldRows + start*n;
+        const T_value *newBlock = newRows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC oldDiff = CK_SUB(CK_NAME(loadRow)(oldBlock + r*n + i), k);
+                CK_VEC newDiff = CK_SUB(CK_NAME(loadRow)(newBlock + r*n + i), k);
+                ex = CK_ADD(CK_SUB(ex, oldDiff), newDiff);
+                ex2 = CK_ADD(CK_SUB(ex2, CK_MUL(oldDiff, oldDiff)), CK_MUL(newDiff, newDiff));
+                CK_VEC oldDiffHi = CK_SUB(CK_NAME(loadRow)(oldBlock + r*n + i + CK_LANES), kHi);
+                CK_VEC newDiffHi = CK_SUB(CK_NAME(loadRow)(newBlock + r*n + i + CK_LANES), kHi);
+                exHi = CK_ADD(CK_SUB(exHi, oldDiffHi), newDiffHi);
+                ex2Hi = CK_ADD(CK_SUB(ex2Hi, CK_MUL(oldDiffHi, oldDiffHi)), CK_MUL(newDiffHi, newDiffHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC oldDiff = CK_SUB(CK_NAME(loadRow)(oldBlock + r*n + i), k);
+                CK_VEC newDiff = CK_SUB(CK_NAME(loadRow)(newBlock + r*n + i), k);
+                ex = CK_ADD(CK_SUB(ex, oldDiff), newDiff);
+                ex2 = CK_ADD(CK_SUB(ex2, CK_MUL(oldDiff, oldDiff)), CK_MUL(newDiff, newDiff));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+        }
+        replaceShiftedRowsStrided_scalar(Ex + i, Ex2 + i, oldBlock + i, newBlock + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(addShiftedMean)(double *Ex, const double *row, const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(Ex + i, CK_ADD(CK_LOAD(Ex + i), CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i))));
+    addShiftedMean_scalar(Ex + i, row + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(removeShiftedMean)(double *Ex, const double *row, const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(Ex + i, CK_SUB(CK_LOAD(Ex + i), CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i))));
+    removeShiftedMean_scalar(Ex + i, row + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(replaceShiftedMean)(double *Ex, const double *oldRow, const double *newRow,
+                                                  const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_STORE(Ex + i, CK_ADD(CK_SUB(CK_LOAD(Ex + i), CK_SUB(CK_LOAD(oldRow + i), k)),
+                                CK_SUB(CK_LOAD(newRow + i), k)));
+    }
+    replaceShiftedMean_scalar(Ex + i, oldRow + i, newRow + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(addShiftedMeanRows)(double *Ex, const double *rows, size_t numRows, const double *K,
+                                                  size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                ex = CK_ADD(ex, CK_SUB(CK_LOAD(block + r*n + i), k));
+                exHi = CK_ADD(exHi, CK_SUB(CK_LOAD(block + r*n + i + CK_LANES), kHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            for (size_t r = 0; r < count; r++)
+                ex = CK_ADD(ex, CK_SUB(CK_LOAD(block + r*n + i), k));
+            CK_STORE(Ex + i, ex);
+        }
+        addShiftedMeanRowsStrided_scalar(Ex + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(removeShiftedMeanRows)(double *Ex, const double *rows, size_t numRows,
+                                                     const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                ex = CK_SUB(ex, CK_SUB(CK_LOAD(block + r*n + i), k));
+                exHi = CK_SUB(exHi, CK_SUB(CK_LOAD(block + r*n + i + CK_LANES), kHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            for (size_t r = 0; r < count; r++)
+                ex = CK_SUB(ex, CK_SUB(CK_LOAD(block + r*n + i), k));
+            CK_STORE(Ex + i, ex);
+        }
+        removeShiftedMeanRowsStrided_scalar(Ex + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(replaceShiftedMeanRows)(double *Ex, const double *oldRows, const double *newRows,
+                                                      size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *oldBlock = oldRows + start*n;
+        const double *newBlock = newRows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                ex = CK_ADD(CK_SUB(ex, CK_SUB(CK_LOAD(oldBlock + r*n + i), k)), CK_SUB(CK_LOAD(newBlock + r*n + i), k));
+                exHi = CK_ADD(CK_SUB(exHi, CK_SUB(CK_LOAD(oldBlock + r*n + i + CK_LANES), kHi)),
+                              CK_SUB(CK_LOAD(newBlock + r*n + i + CK_LANES), kHi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            for (size_t r = 0; r < count; r++)
+                ex = CK_ADD(CK_SUB(ex, CK_SUB(CK_LOAD(oldBlock + r*n + i), k)), CK_SUB(CK_LOAD(newBlock + r*n + i), k));
+            CK_STORE(Ex + i, ex);
+        }
+        replaceShiftedMeanRowsStrided_scalar(Ex + i, oldBlock + i, newBlock + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(addShifted4)(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row,
+                                           const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i));
+        CK_VEC diff2 = CK_MUL(diff, diff);
+        CK_STORE(Ex + i, CK_ADD(CK_LOAD(Ex + i), diff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_LOAD(Ex2 + i), diff2));
+        CK_STORE(Ex3 + i, CK_ADD(CK_LOAD(Ex3 + i), CK_MUL(diff2, diff)));
+        CK_STORE(Ex4 + i, CK_ADD(CK_LOAD(Ex4 + i), CK_MUL(diff2, diff2)));
+    }
+    addShifted4_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, row + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(removeShifted4)(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *row,
+                                              const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i));
+        CK_VEC diff2 = CK_MUL(diff, diff);
+        CK_STORE(Ex + i, CK_SUB(CK_LOAD(Ex + i), diff));
+        CK_STORE(Ex2 + i, CK_SUB(CK_LOAD(Ex2 + i), diff2));
+        CK_STORE(Ex3 + i, CK_SUB(CK_LOAD(Ex3 + i), CK_MUL(diff2, diff)));
+        CK_STORE(Ex4 + i, CK_SUB(CK_LOAD(Ex4 + i), CK_MUL(diff2, diff2)));
+    }
+    removeShifted4_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, row + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(replaceShifted4)(double *Ex, double *Ex2, double *Ex3, double *Ex4, const double *oldRow,
+                                               const double *newRow, const double *K, size_t n) {
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC oldDiff = CK_SUB(CK_LOAD(oldRow + i), k);
+        CK_VEC newDiff = CK_SUB(CK_LOAD(newRow + i), k);
+        CK_VEC oldDiff2 = CK_MUL(oldDiff, oldDiff);
+        CK_VEC newDiff2 = CK_MUL(newDiff, newDiff);
+        CK_STORE(Ex + i, CK_ADD(CK_SUB(CK_LOAD(Ex + i), oldDiff), newDiff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_SUB(CK_LOAD(Ex2 + i), oldDiff2), newDiff2));
+        CK_STORE(Ex3 + i, CK_ADD(CK_SUB(CK_LOAD(Ex3 + i), CK_MUL(oldDiff2, oldDiff)), CK_MUL(newDiff2, newDiff)));
+        CK_STORE(Ex4 + i, CK_ADD(CK_SUB(CK_LOAD(Ex4 + i), CK_MUL(oldDiff2, oldDiff2)), CK_MUL(newDiff2, newDiff2)));
+    }
+    replaceShifted4_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, oldRow + i, newRow + i, K + i, n - i);
+}
+
+CK_TARGET inline void CK_NAME(addShifted4Rows)(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                               const double *rows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex3Hi = CK_LOAD(Ex3 + i + CK_LANES);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            CK_VEC ex4Hi = CK_LOAD(Ex4 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_LOAD(block + r*n + i), k);
+                CK_VEC diff2 = CK_MUL(diff, diff);
+                ex = CK_ADD(ex, diff);
+                ex2 = CK_ADD(ex2, diff2);
+                ex3 = CK_ADD(ex3, CK_MUL(diff2, diff));
+                ex4 = CK_ADD(ex4, CK_MUL(diff2, diff2));
+                CK_VEC diffHi = CK_SUB(CK_LOAD(block + r*n + i + CK_LANES), kHi);
+                CK_VEC diff2Hi = CK_MUL(diffHi, diffHi);
+                exHi = CK_ADD(exHi, diffHi);
+                ex2Hi = CK_ADD(ex2Hi, diff2Hi);
+                ex3Hi = CK_ADD(ex3Hi, CK_MUL(diff2Hi, diffHi));
+                ex4Hi = CK_ADD(ex4Hi, CK_MUL(diff2Hi, diff2Hi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex3 + i + CK_LANES, ex3Hi);
+            CK_STORE(Ex4 + i, ex4);
+            CK_STORE(Ex4 + i + CK_LANES, ex4Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_LOAD(block + r*n + i), k);
+                CK_VEC diff2 = CK_MUL(diff, diff);
+                ex = CK_ADD(ex, diff);
+                ex2 = CK_ADD(ex2, diff2);
+                ex3 = CK_ADD(ex3, CK_MUL(diff2, diff));
+                ex4 = CK_ADD(ex4, CK_MUL(diff2, diff2));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex4 + i, ex4);
+        }
+        addShifted4RowsStrided_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(removeShifted4Rows)(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                  const double *rows, size_t numRows, const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *block = rows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex3Hi = CK_LOAD(Ex3 + i + CK_LANES);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            CK_VEC ex4Hi = CK_LOAD(Ex4 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_LOAD(block + r*n + i), k);
+                CK_VEC diff2 = CK_MUL(diff, diff);
+                ex = CK_SUB(ex, diff);
+                ex2 = CK_SUB(ex2, diff2);
+                ex3 = CK_SUB(ex3, CK_MUL(diff2, diff));
+                ex4 = CK_SUB(ex4, CK_MUL(diff2, diff2));
+                CK_VEC diffHi = CK_SUB(CK_LOAD(block + r*n + i + CK_LANES), kHi);
+                CK_VEC diff2Hi = CK_MUL(diffHi, diffHi);
+                exHi = CK_SUB(exHi, diffHi);
+                ex2Hi = CK_SUB(ex2Hi, diff2Hi);
+                ex3Hi = CK_SUB(ex3Hi, CK_MUL(diff2Hi, diffHi));
+                ex4Hi = CK_SUB(ex4Hi, CK_MUL(diff2Hi, diff2Hi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex3 + i + CK_LANES, ex3Hi);
+            CK_STORE(Ex4 + i, ex4);
+            CK_STORE(Ex4 + i + CK_LANES, ex4Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC diff = CK_SUB(CK_LOAD(block + r*n + i), k);
+                CK_VEC diff2 = CK_MUL(diff, diff);
+                ex = CK_SUB(ex, diff);
+                ex2 = CK_SUB(ex2, diff2);
+                ex3 = CK_SUB(ex3, CK_MUL(diff2, diff));
+                ex4 = CK_SUB(ex4, CK_MUL(diff2, diff2));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex4 + i, ex4);
+        }
+        removeShifted4RowsStrided_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, block + i, count, n, K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(replaceShifted4Rows)(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                   const double *oldRows, const double *newRows, size_t numRows,
+                                                   const double *K, size_t n) {
+    const size_t sweep = sweepRows(n);
+    for (size_t start = 0; start < numRows; start += sweep) {
+        const size_t count = std::min(sweep, numRows - start);
+        const double *oldBlock = oldRows + start*n;
+        const double *newBlock = newRows + start*n;
+        size_t i = 0;
+        for (; i + 2*CK_LANES <= n; i += 2*CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            const CK_VEC kHi = CK_LOAD(K + i + CK_LANES);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC exHi = CK_LOAD(Ex + i + CK_LANES);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex2Hi = CK_LOAD(Ex2 + i + CK_LANES);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex3Hi = CK_LOAD(Ex3 + i + CK_LANES);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            CK_VEC ex4Hi = CK_LOAD(Ex4 + i + CK_LANES);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC oldDiff = CK_SUB(CK_LOAD(oldBlock + r*n + i), k);
+                CK_VEC newDiff = CK_SUB(CK_LOAD(newBlock + r*n + i), k);
+                CK_VEC oldDiff2 = CK_MUL(oldDiff, oldDiff);
+                CK_VEC newDiff2 = CK_MUL(newDiff, newDiff);
+                ex = CK_ADD(CK_SUB(ex, oldDiff), newDiff);
+                ex2 = CK_ADD(CK_SUB(ex2, oldDiff2), newDiff2);
+                ex3 = CK_ADD(CK_SUB(ex3, CK_MUL(oldDiff2, oldDiff)), CK_MUL(newDiff2, newDiff));
+                ex4 = CK_ADD(CK_SUB(ex4, CK_MUL(oldDiff2, oldDiff2)), CK_MUL(newDiff2, newDiff2));
+                CK_VEC oldDiffHi = CK_SUB(CK_LOAD(oldBlock + r*n + i + CK_LANES), kHi);
+                CK_VEC newDiffHi = CK_SUB(CK_LOAD(newBlock + r*n + i + CK_LANES), kHi);
+                CK_VEC oldDiff2Hi = CK_MUL(oldDiffHi, oldDiffHi);
+                CK_VEC newDiff2Hi = CK_MUL(newDiffHi, newDiffHi);
+                exHi = CK_ADD(CK_SUB(exHi, oldDiffHi), newDiffHi);
+                ex2Hi = CK_ADD(CK_SUB(ex2Hi, oldDiff2Hi), newDiff2Hi);
+                ex3Hi = CK_ADD(CK_SUB(ex3Hi, CK_MUL(oldDiff2Hi, oldDiffHi)), CK_MUL(newDiff2Hi, newDiffHi));
+                ex4Hi = CK_ADD(CK_SUB(ex4Hi, CK_MUL(oldDiff2Hi, oldDiff2Hi)), CK_MUL(newDiff2Hi, newDiff2Hi));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex + i + CK_LANES, exHi);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex2 + i + CK_LANES, ex2Hi);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex3 + i + CK_LANES, ex3Hi);
+            CK_STORE(Ex4 + i, ex4);
+            CK_STORE(Ex4 + i + CK_LANES, ex4Hi);
+        }
+        for (; i + CK_LANES <= n; i += CK_LANES) {
+            const CK_VEC k = CK_LOAD(K + i);
+            CK_VEC ex = CK_LOAD(Ex + i);
+            CK_VEC ex2 = CK_LOAD(Ex2 + i);
+            CK_VEC ex3 = CK_LOAD(Ex3 + i);
+            CK_VEC ex4 = CK_LOAD(Ex4 + i);
+            for (size_t r = 0; r < count; r++) {
+                CK_VEC oldDiff = CK_SUB(CK_LOAD(oldBlock + r*n + i), k);
+                CK_VEC newDiff = CK_SUB(CK_LOAD(newBlock + r*n + i), k);
+                CK_VEC oldDiff2 = CK_MUL(oldDiff, oldDiff);
+                CK_VEC newDiff2 = CK_MUL(newDiff, newDiff);
+                ex = CK_ADD(CK_SUB(ex, oldDiff), newDiff);
+                ex2 = CK_ADD(CK_SUB(ex2, oldDiff2), newDiff2);
+                ex3 = CK_ADD(CK_SUB(ex3, CK_MUL(oldDiff2, oldDiff)), CK_MUL(newDiff2, newDiff));
+                ex4 = CK_ADD(CK_SUB(ex4, CK_MUL(oldDiff2, oldDiff2)), CK_MUL(newDiff2, newDiff2));
+            }
+            CK_STORE(Ex + i, ex);
+            CK_STORE(Ex2 + i, ex2);
+            CK_STORE(Ex3 + i, ex3);
+            CK_STORE(Ex4 + i, ex4);
+        }
+        replaceShifted4RowsStrided_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, oldBlock + i, newBlock + i, count, n,
+                                          K + i, n - i);
+    }
+}
+
+CK_TARGET inline void CK_NAME(mergeShifted)(const double *KA, double *ExA, double *Ex2A, const double *KB,
+                                            const double *ExB, const double *Ex2B, double countB, size_t n) {
+    const CK_VEC c = CK_SET1(countB);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC shift = CK_SUB(CK_LOAD(KB + i), CK_LOAD(KA + i));
+        CK_VEC countShift = CK_MUL(c, shift);
+        CK_VEC exB = CK_LOAD(ExB + i);
+        CK_STORE(Ex2A + i, CK_ADD(CK_LOAD(Ex2A + i),
+                                  CK_ADD(CK_LOAD(Ex2B + i), CK_MUL(shift, CK_ADD(CK_ADD(exB, exB), countShift)))));
+        CK_STORE(ExA + i, CK_ADD(CK_LOAD(ExA + i), CK_ADD(exB, countShift)));
+    }
+    mergeShifted_scalar(KA + i, ExA + i, Ex2A + i, KB + i, ExB + i, Ex2B + i, countB, n - i);
+}
+
+CK_TARGET inline void CK_NAME(mean)(double *mean, const double *K, const double *Ex, double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES)
+        CK_STORE(mean + i, CK_ADD(CK_LOAD(K + i), CK_DIV(CK_LOAD(Ex + i), c)));
+    mean_scalar(mean + i, K + i, Ex + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(stdDev)(double *stdDev, const double *Ex, const double *Ex2, double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    const CK_VEC c1 = CK_SET1(count - 1);
+    const CK_VEC zero = CK_SET1(0.0);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC sumSquares = CK_MAX(CK_SUB(CK_LOAD(Ex2 + i), CK_DIV(CK_MUL(ex, ex), c)), zero);
+        CK_STORE(stdDev + i, CK_SQRT(CK_DIV(sumSquares, c1)));
+    }
+    stdDev_scalar(stdDev + i, Ex + i, Ex2 + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(recenter)(double *K, double *Ex, double *Ex2, double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC newK = CK_ADD(k, CK_DIV(ex, c));
+        CK_VEC shift = CK_SUB(newK, k);
+        CK_VEC countShift = CK_MUL(c, shift);
+        CK_STORE(Ex2 + i, CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(shift, CK_SUB(CK_ADD(ex, ex), countShift))));
+        CK_STORE(Ex + i, CK_SUB(ex, countShift));
+        CK_STORE(K + i, newK);
+    }
+    recenter_scalar(K + i, Ex + i, Ex2 + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(recenterMean)(double *K, double *Ex, double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC newK = CK_ADD(k, CK_DIV(ex, c));
+        CK_STORE(Ex + i, CK_SUB(ex, CK_MUL(c, CK_SUB(newK, k))));
+        CK_STORE(K + i, newK);
+    }
+    recenterMean_scalar(K + i, Ex + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(recenter4)(double *K, double *Ex, double *Ex2, double *Ex3, double *Ex4, double count,
+                                         size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    const CK_VEC three = CK_SET1(3.0);
+    const CK_VEC four = CK_SET1(4.0);
+    const CK_VEC six = CK_SET1(6.0);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC ex2 = CK_LOAD(Ex2 + i);
+        CK_VEC ex3 = CK_LOAD(Ex3 + i);
+        CK_VEC newK = CK_ADD(k, CK_DIV(ex, c));
+        CK_VEC shift = CK_SUB(newK, k);
+        CK_VEC countShift = CK_MUL(c, shift);
+        CK_VEC inner4 = CK_SUB(CK_MUL(six, ex2), CK_MUL(shift, CK_SUB(CK_MUL(four, ex), countShift)));
+        CK_STORE(Ex4 + i, CK_SUB(CK_LOAD(Ex4 + i), CK_MUL(shift, CK_SUB(CK_MUL(four, ex3), CK_MUL(shift, inner4)))));
+        CK_VEC inner3 = CK_SUB(CK_MUL(three, ex), countShift);
+        CK_STORE(Ex3 + i, CK_SUB(ex3, CK_MUL(shift, CK_SUB(CK_MUL(three, ex2), CK_MUL(shift, inner3)))));
+        CK_STORE(Ex2 + i, CK_SUB(ex2, CK_MUL(shift, CK_SUB(CK_ADD(ex, ex), countShift))));
+        CK_STORE(Ex + i, CK_SUB(ex, countShift));
+        CK_STORE(K + i, newK);
+    }
+    recenter4_scalar(K + i, Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(skewness)(double *skewness, const double *Ex, const double *Ex2, const double *Ex3,
+                                        double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    const CK_VEC rootCount = CK_SET1(std::sqrt(count));
+    const CK_VEC two = CK_SET1(2.0);
+    const CK_VEC three = CK_SET1(3.0);
+    const CK_VEC zero = CK_SET1(0.0);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC ex2 = CK_LOAD(Ex2 + i);
+        CK_VEC offset = CK_DIV(ex, c);
+        CK_VEC m2 = CK_MAX(CK_SUB(ex2, CK_MUL(ex, offset)), zero);
+        CK_VEC m3 = CK_SUB(CK_LOAD(Ex3 + i), CK_MUL(offset, CK_SUB(CK_MUL(three, ex2), CK_MUL(CK_MUL(two, ex), offset))));
+        CK_STORE(skewness + i, CK_DIV(CK_MUL(rootCount, m3), CK_MUL(m2, CK_SQRT(m2))));
+    }
+    skewness_scalar(skewness + i, Ex + i, Ex2 + i, Ex3 + i, count, n - i);
+}
+
+CK_TARGET inline void CK_NAME(kurtosis)(double *kurtosis, const double *Ex, const double *Ex2, const double *Ex3,
+                                        const double *Ex4, double count, size_t n) {
+    const CK_VEC c = CK_SET1(count);
+    const CK_VEC three = CK_SET1(3.0);
+    const CK_VEC four = CK_SET1(4.0);
+    const CK_VEC six = CK_SET1(6.0);
+    const CK_VEC zero = CK_SET1(0.0);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC ex2 = CK_LOAD(Ex2 + i);
+        CK_VEC offset = CK_DIV(ex, c);
+        CK_VEC m2 = CK_MAX(CK_SUB(ex2, CK_MUL(ex, offset)), zero);
+        CK_VEC inner = CK_SUB(CK_MUL(six, ex2), CK_MUL(CK_MUL(three, ex), offset));
+        CK_VEC m4 = CK_SUB(CK_LOAD(Ex4 + i), CK_MUL(offset, CK_SUB(CK_MUL(four, CK_LOAD(Ex3 + i)), CK_MUL(offset, inner))));
+        CK_STORE(kurtosis + i, CK_SUB(CK_DIV(CK_MUL(c, m4), CK_MUL(m2, m2)), three));
+    }
+    kurtosis_scalar(kurtosis + i, Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, count, n - i);
+}
+
+// The scored kernels score each column against the sums before updating them, as
+// scoreShifted_scalar does, in the same pass; the largest excess is kept per lane and
+// folded with the scalar remainder's at the end.
+CK_TARGET inline double CK_NAME(addShiftedScored)(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                                  const double *row, const double *K,
+                                                  const double *squaredThresholds, double count, size_t n) {
+    const CK_VEC inverse = CK_SET1(1.0 / count);
+    const CK_VEC c1 = CK_SET1(count - 1);
+    const CK_VEC zero = CK_SET1(0.0);
+    CK_VEC largest = CK_SET1(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i));
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC offset = CK_MUL(ex, inverse);
+        CK_VEC dev = CK_SUB(diff, offset);
+        CK_VEC squares = CK_MAX(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(ex, offset)), zero);
+        CK_STORE(deviation + i, dev);
+        CK_STORE(sumSquares + i, squares);
+        largest = CK_MAX(largest, CK_SUB(CK_MUL(CK_MUL(dev, dev), c1),
+                                         CK_MUL(CK_LOAD(squaredThresholds + i), squares)));
+        CK_STORE(Ex + i, CK_ADD(ex, diff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_LOAD(Ex2 + i), CK_MUL(diff, diff)));
+    }
+    double result = addShiftedScored_scalar(Ex + i, Ex2 + i, deviation + i, sumSquares + i, row + i, K + i,
+                                            squaredThresholds + i, count, n - i);
+    if (i > 0) {
+        double lanes[CK_LANES];
+        CK_STORE(lanes, largest);
+        for (size_t lane = 0; lane < CK_LANES; lane++)
+            result = result > lanes[lane] ? result : lanes[lane];
+    }
+    return result;
+}
+
+CK_TARGET inline double CK_NAME(replaceShiftedScored)(double *Ex, double *Ex2, double *deviation, double *sumSquares,
+                                                      const double *oldRow, const double *newRow, const double *K,
+                                                      const double *squaredThresholds, double count, size_t n) {
+    const CK_VEC inverse = CK_SET1(1.0 / count);
+    const CK_VEC c1 = CK_SET1(count - 1);
+    const CK_VEC zero = CK_SET1(0.0);
+    CK_VEC largest = CK_SET1(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC oldDiff = CK_SUB(CK_LOAD(oldRow + i), k);
+        CK_VEC newDiff = CK_SUB(CK_LOAD(newRow + i), k);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC offset = CK_MUL(ex, inverse);
+        CK_VEC dev = CK_SUB(newDiff, offset);
+        CK_VEC squares = CK_MAX(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(ex, offset)), zero);
+        CK_STORE(deviation + i, dev);
+        CK_STORE(sumSquares + i, squares);
+        largest = CK_MAX(largest, CK_SUB(CK_MUL(CK_MUL(dev, dev), c1),
+                                         CK_MUL(CK_LOAD(squaredThresholds + i), squares)));
+        CK_STORE(Ex + i, CK_ADD(CK_SUB(ex, oldDiff), newDiff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(oldDiff, oldDiff)),
+                                 CK_MUL(newDiff, newDiff)));
+    }
+    double result = replaceShiftedScored_scalar(Ex + i, Ex2 + i, deviation + i, sumSquares + i, oldRow + i,
+                                                newRow + i, K + i, squaredThresholds + i, count, n - i);
+    if (i > 0) {
+        double lanes[CK_LANES];
+        CK_STORE(lanes, largest);
+        for (size_t lane = 0; lane < CK_LANES; lane++)
+            result = result > lanes[lane] ? result : lanes[lane];
+    }
+    return result;
+}
+
+CK_TARGET inline double CK_NAME(addShifted4Scored)(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                   double *deviation, double *sumSquares, const double *row,
+                                                   const double *K, const double *squaredThresholds, double count,
+                                                   size_t n) {
+    const CK_VEC inverse = CK_SET1(1.0 / count);
+    const CK_VEC c1 = CK_SET1(count - 1);
+    const CK_VEC zero = CK_SET1(0.0);
+    CK_VEC largest = CK_SET1(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC diff = CK_SUB(CK_LOAD(row + i), CK_LOAD(K + i));
+        CK_VEC diff2 = CK_MUL(diff, diff);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC offset = CK_MUL(ex, inverse);
+        CK_VEC dev = CK_SUB(diff, offset);
+        CK_VEC squares = CK_MAX(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(ex, offset)), zero);
+        CK_STORE(deviation + i, dev);
+        CK_STORE(sumSquares + i, squares);
+        largest = CK_MAX(largest, CK_SUB(CK_MUL(CK_MUL(dev, dev), c1),
+                                         CK_MUL(CK_LOAD(squaredThresholds + i), squares)));
+        CK_STORE(Ex + i, CK_ADD(ex, diff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_LOAD(Ex2 + i), diff2));
+        CK_STORE(Ex3 + i, CK_ADD(CK_LOAD(Ex3 + i), CK_MUL(diff2, diff)));
+        CK_STORE(Ex4 + i, CK_ADD(CK_LOAD(Ex4 + i), CK_MUL(diff2, diff2)));
+    }
+    double result = addShifted4Scored_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, deviation + i, sumSquares + i,
+                                             row + i, K + i, squaredThresholds + i, count, n - i);
+    if (i > 0) {
+        double lanes[CK_LANES];
+        CK_STORE(lanes, largest);
+        for (size_t lane = 0; lane < CK_LANES; lane++)
+            result = result > lanes[lane] ? result : lanes[lane];
+    }
+    return result;
+}
+
+CK_TARGET inline double CK_NAME(replaceShifted4Scored)(double *Ex, double *Ex2, double *Ex3, double *Ex4,
+                                                       double *deviation, double *sumSquares, const double *oldRow,
+                                                       const double *newRow, const double *K,
+                                                       const double *squaredThresholds, double count, size_t n) {
+    const CK_VEC inverse = CK_SET1(1.0 / count);
+    const CK_VEC c1 = CK_SET1(count - 1);
+    const CK_VEC zero = CK_SET1(0.0);
+    CK_VEC largest = CK_SET1(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC k = CK_LOAD(K + i);
+        CK_VEC oldDiff = CK_SUB(CK_LOAD(oldRow + i), k);
+        CK_VEC newDiff = CK_SUB(CK_LOAD(newRow + i), k);
+        CK_VEC oldDiff2 = CK_MUL(oldDiff, oldDiff);
+        CK_VEC newDiff2 = CK_MUL(newDiff, newDiff);
+        CK_VEC ex = CK_LOAD(Ex + i);
+        CK_VEC offset = CK_MUL(ex, inverse);
+        CK_VEC dev = CK_SUB(newDiff, offset);
+        CK_VEC squares = CK_MAX(CK_SUB(CK_LOAD(Ex2 + i), CK_MUL(ex, offset)), zero);
+        CK_STORE(deviation + i, dev);
+        CK_STORE(sumSquares + i, squares);
+        largest = CK_MAX(largest, CK_SUB(CK_MUL(CK_MUL(dev, dev), c1),
+                                         CK_MUL(CK_LOAD(squaredThresholds + i), squares)));
+        CK_STORE(Ex + i, CK_ADD(CK_SUB(ex, oldDiff), newDiff));
+        CK_STORE(Ex2 + i, CK_ADD(CK_SUB(CK_LOAD(Ex2 + i), oldDiff2), newDiff2));
+        CK_STORE(Ex3 + i, CK_ADD(CK_SUB(CK_LOAD(Ex3 + i), CK_MUL(oldDiff2, oldDiff)), CK_MUL(newDiff2, newDiff)));
+        CK_STORE(Ex4 + i, CK_ADD(CK_SUB(CK_LOAD(Ex4 + i), CK_MUL(oldDiff2, oldDiff2)), CK_MUL(newDiff2, newDiff2)));
+    }
+    double result = replaceShifted4Scored_scalar(Ex + i, Ex2 + i, Ex3 + i, Ex4 + i, deviation + i, sumSquares + i,
+                                                 oldRow + i, newRow + i, K + i, squaredThresholds + i, count, n - i);
+    if (i > 0) {
+        double lanes[CK_LANES];
+        CK_STORE(lanes, largest);
+        for (size_t lane = 0; lane < CK_LANES; lane++)
+            result = result > lanes[lane] ? result : lanes[lane];
+    }
+    return result;
+}
+
+CK_TARGET inline void CK_NAME(addDecayed)(double *mean, double *variance, const double *row, double alpha,
+                                          double retain, size_t n) {
+    const CK_VEC a = CK_SET1(alpha);
+    const CK_VEC r = CK_SET1(retain);
+    size_t i = 0;
+    for (; i + CK_LANES <= n; i += CK_LANES) {
+        CK_VEC m = CK_LOAD(mean + i);
+        CK_VEC diff = CK_SUB(CK_LOAD(row + i), m);
+        CK_VEC step = CK_MUL(a, diff);
+        CK_STORE(mean + i, CK_ADD(m, step));
+        CK_STORE(variance + i, CK_MUL(r, CK_ADD(CK_LOAD(variance + i), CK_MUL(diff, step))));
+    }
+    addDecayed_scalar(mean + i, variance + i, row + i, alpha, retain, n - i);
+}
+
+} // namespace ColumnKernelsDetail
@@ -0,0 +1,167 @@
+/* Header for ColumnarStatisticsBuffer class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include "DataContainer.h"
+#include "RingView.h"
+
+/**
+ * A column-major (structure-of-arrays) counterpart to StatisticsBuffer. Each column
+ * is kept in its own contiguous circular buffer, so a column can be scanned over the
+ * whole window with unit stride and handed out without copying via getColumn().
+ *
+ * Rows are still added and removed whole: addRow() scatters the row into the column
+ * buffers. The mean and standard deviation are computed incrementally (and K re-centered)
+ * exactly as in StatisticsBuffer, so for the same rows both give identical results.
+ */
+template <size_t T_length, size_t T_width>
+class ColumnarStatisticsBuffer {
+public:
+    /**
+     * Constructor, initializes internal K_, Ex_, and Ex2_ variables used for incrementally
+     * keeping track of mean and standard-deviation.
+     */
+    ColumnarStatisticsBuffer();
+
+    /**
+     * Adds a copy of the input row to the column buffers, cycling out the oldest entry if necessary.
+     * Incrementally adds the new entries to the stats, and removes old entries.
+     *
+     * @param data  the DataContainer instance to be added.
+     */
+    void addRow(const DataContainer<T_width> & data);
+
+    /**
+     * Removes the oldest row from the column buffers. Simply calls removeRows(1);
+     */
+    void removeRow();
+
+    /**
+     * Removes the oldest numRowsToRemove rows from the column buffers. If there are less rows
+     * than specified, it stops after removing what it can. Each column's removed entries are
+     * swept with unit stride.
+     */
+    void removeRows(unsigned int numRowsToRemove);
+
+    /**
+     * Adds a copy of the input row. Simply calls the addRow() method.
+     *
+     * @param rhs  the DataContainer instance to be added
+     * @return     a reference to the current ColumnarStatisticsBuffer
+     */
+    ColumnarStatisticsBuffer & operator += (const DataContainer<T_width> & rhs);
+
+    /**
+     * Returns the entries of one column in chronological order from oldest to newest, as at
+     * most two contiguous spans into the column buffer. Nothing is copied.
+     *
+     * @param column  the column to be returned, less than T_width
+     * @return        a RingView of the column, valid until the buffer is next modified
+     */
+    RingView<double> getColumn(size_t column) const;
+
+    /**
+     * Returns the row specified by the index, in chronological order from oldest to newest,
+     * gathered from the column buffers.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param index  the row to be returned
+     * @return       a copy of the DataContainer requested
+     */
+    const DataContainer<T_width> getRow(unsigned int index) const;
+
+    /**
+     * Returns the row most recently added. Equivalent to getRow(currentLength() - 1).
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return       a copy of the DataContainer requested
+     */
+    const DataContainer<T_width> getLatestRow() const;
+
+    /**
+     * Returns the current mean of each column as a DataContainer.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the current standard deviation of each column as a DataContainer.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Moves the internal location parameter of each column to its current mean, as
+     * StatisticsBuffer::recenter() does. Called automatically once per T_length rows added.
+     */
+    void recenter();
+
+    /**
+     * Returns the maximum length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the maximum number of rows.
+     */
+    size_t maxLength() const;
+
+    /**
+     * Returns the current length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the current number of rows.
+     */
+    size_t currentLength() const;
+
+    /**
+     * Returns true if the buffer no longer contains any entries, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+    /**
+     * Returns true if the buffer is full, otherwise false.
+     * Note that this does NOT imply that entries cannot be added.
+     *
+     * @return boolean result of test
+     */
+    bool isFull() const;
+
+private:
+    /**
+     * The column buffers: columns_[j][k] is column j of the row in slot k.
+     */
+    std::array<std::array<double, T_length>, T_width> columns_;
+    /**
+     * Slot corresponding to the oldest entry.
+     */
+    int headIndex_ = 0;
+    /**
+     * Slot corresponding to the newest entry.
+     */
+    int tailIndex_ = -1; // -1 so we can pre-increment in addRow
+    /**
+     * Current length of the buffer.
+     */
+    unsigned int numRows_ = 0;
+
+    /**
+     * Internal "location parameter", used to ensure subtractions are not too far from the mean.
+     */
+    DataContainer<T_width> K_;
+    /**
+     * Internal parameter containing the difference between the datapoint and the location parameter
+     */
+    DataContainer<T_width> Ex_;
+    /**
+     * Internal parameter containing the square of Ex_
+     */
+    DataContainer<T_width> Ex2_;
+};
+
+#include "ColumnarStatisticsBuffer_impl.h"
@@ -0,0 +1,148 @@
+#include "ColumnarStatisticsBuffer.h"
+
+template <size_t T_length, size_t T_width>
+ColumnarStatisticsBuffer<T_length, T_width>::ColumnarStatisticsBuffer() {
+    this->K_.fill(0);
+    this->Ex_.fill(0);
+    this->Ex2_.fill(0);
+}
+
+template <size_t T_length, size_t T_width>
+void ColumnarStatisticsBuffer<T_length, T_width>::addRow(const DataContainer<T_width> &data) {
+    if (this->numRows_ == 0) {
+        // K must be initialized to a value within the sample range.
+        // Close to mean is preferable, but not required.
+        this->K_ = data;
+    }
+
+    this->tailIndex_ = (this->tailIndex_ + 1) % T_length;
+
+    if (this->numRows_ < T_length) {
+        this->numRows_++;
+        ColumnKernels::addShifted(this->Ex_.data(), this->Ex2_.data(), data.data(), this->K_.data(), T_width);
+    } else {
+        // the tail slot holds the current head; gather it so it can be replaced in one pass
+        DataContainer<T_width> oldest;
+        for (unsigned int i = 0; i < T_width; i++)
+            oldest[i] = this->columns_[i][this->tailIndex_];
+        ColumnKernels::replaceShifted(this->Ex_.data(), this->Ex2_.data(), oldest.data(), data.data(),
+                                      this->K_.data(), T_width);
+        this->headIndex_ = (this->headIndex_ + 1) % T_length;
+    }
+
+    // Scatter the row into the column buffers
+    for (unsigned int i = 0; i < T_width; i++)
+        this->columns_[i][this->tailIndex_] = data[i];
+
+    if (this->tailIndex_ == static_cast<int>(T_length) - 1)
+        this->recenter();
+}
+
+template <size_t T_length, size_t T_width>
+void ColumnarStatisticsBuffer<T_length, T_width>::removeRow() {
+    this->removeRows(1);
+}
+
+template <size_t T_length, size_t T_width>
+void ColumnarStatisticsBuffer<T_length, T_width>::removeRows(unsigned int numRowsToRemove) {
+    assert(!this->isEmpty());
+
+    const size_t numRemoved = std::min<size_t>(numRowsToRemove, this->numRows_);
+    const size_t firstLength = std::min<size_t>(numRemoved, T_length - this->headIndex_);
+    const size_t segmentStart[2] = {static_cast<size_t>(this->headIndex_), 0};
+    const size_t segmentLength[2] = {firstLength, numRemoved - firstLength};
+
+    // Column by column, oldest first, so each column sees the same operations as in StatisticsBuffer
+    double diff;
+    for (unsigned int i = 0; i < T_width; i++) {
+        const double *column = this->columns_[i].data();
+        for (unsigned int segment = 0; segment < 2; segment++) {
+            for (size_t k = segmentStart[segment]; k < segmentStart[segment] + segmentLength[segment]; k++) {
+                diff = column[k] - this->K_[i];
+                this->Ex_[i] -= diff;
+                this->Ex2_[i] -= diff*diff;
+            }
+        }
+    }
+
+    this->numRows_ -= numRemoved;
+    this->headIndex_ = (this->headIndex_ + numRemoved) % T_length;
+}
+
+template <size_t T_length, size_t T_width>
+ColumnarStatisticsBuffer<T_length, T_width> &
+ColumnarStatisticsBuffer<T_length, T_width>::operator+=(const DataContainer<T_width> &data) {
+    this->addRow(data);
+    return *this;
+}
+
+template <size_t T_length, size_t T_width>
+RingView<double> ColumnarStatisticsBuffer<T_length, T_width>::getColumn(size_t column) const {
+    assert(column < T_width);
+    const double *data = this->columns_[column].data();
+    RingView<double> view;
+    view.firstSize = std::min<size_t>(this->numRows_, T_length - this->headIndex_);
+    view.first = view.firstSize ? data + this->headIndex_ : nullptr;
+    view.secondSize = this->numRows_ - view.firstSize;
+    view.second = view.secondSize ? data : nullptr;
+    return view;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ColumnarStatisticsBuffer<T_length, T_width>::getRow(unsigned int index) const {
+    assert(!this->isEmpty());
+    const size_t slot = (this->headIndex_ + index) % T_length;
+    DataContainer<T_width> row;
+    for (unsigned int i = 0; i < T_width; i++)
+        row[i] = this->columns_[i][slot];
+    return row;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ColumnarStatisticsBuffer<T_length, T_width>::getLatestRow() const {
+    assert(!this->isEmpty());
+    return this->getRow(this->numRows_ - 1);
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ColumnarStatisticsBuffer<T_length, T_width>::getMean() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> mean;
+    ColumnKernels::mean(mean.data(), this->K_.data(), this->Ex_.data(), this->numRows_, T_width);
+    return mean;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ColumnarStatisticsBuffer<T_length, T_width>::getStdDev() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> stdDev;
+    ColumnKernels::stdDev(stdDev.data(), this->Ex_.data(), this->Ex2_.data(), this->numRows_, T_width);
+    return stdDev;
+}
+
+template <size_t T_length, size_t T_width>
+void ColumnarStatisticsBuffer<T_length, T_width>::recenter() {
+    if (this->numRows_ == 0)
+        return;
+    ColumnKernels::recenter(this->K_.data(), this->Ex_.data(), this->Ex2_.data(), this->numRows_, T_width);
+}
+
+template <size_t T_length, size_t T_width>
+size_t ColumnarStatisticsBuffer<T_length, T_width>::maxLength() const {
+    return T_length;
+}
+
+template <size_t T_length, size_t T_width>
+size_t ColumnarStatisticsBuffer<T_length, T_width>::currentLength() const {
+    return this->numRows_;
+}
+
+template <size_t T_length, size_t T_width>
+bool ColumnarStatisticsBuffer<T_length, T_width>::isEmpty() const {
+    return this->numRows_ == 0;
+}
+
+template <size_t T_length, size_t T_width>
+bool ColumnarStatisticsBuffer<T_length, T_width>::isFull() const {
+    return this->numRows_ == T_length;
+}
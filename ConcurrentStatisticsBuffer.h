@@ -0,0 +1,145 @@
+/* Header for ConcurrentStatisticsBuffer class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "StatisticsBuffer.h"
+#include "StatisticsSummary.h"
+
+/**
+ * A StatisticsBuffer for one writer thread and any number of reader threads.
+ *
+ * The writer updates its own StatisticsBuffer exactly as StatisticsBuffer does,
+ * then publishes a copy of K, Ex, Ex2 and the row count inside a sequence lock:
+ * the sequence number is odd only while that O(T_width) copy is being stored.
+ * Readers copy the published words and retry if the sequence number was odd or
+ * changed meanwhile, so they always get a consistent snapshot. The published
+ * words are atomics, stored with release and loaded with acquire ordering, which
+ * on x86 compile to plain stores and loads but make the overlapping copies well
+ * defined without fences. The writer never waits on readers.
+ *
+ * Methods marked "writer only" must be called from a single thread. The
+ * getSummary(), getMean(), getStdDev() and currentLength() methods may be called
+ * from any thread.
+ */
+template <size_t T_length, size_t T_width>
+class ConcurrentStatisticsBuffer {
+public:
+    /**
+     * Constructor, publishes the empty state.
+     */
+    ConcurrentStatisticsBuffer();
+
+    /**
+     * Writer only. Adds a copy of the input row, cycling out the oldest entry if necessary,
+     * and publishes the updated statistics.
+     *
+     * @param data  the DataContainer instance to be added.
+     * @see StatisticsBuffer#addRow(const DataContainer<T_width> & data)
+     */
+    void addRow(const DataContainer<T_width> & data);
+
+    /**
+     * Writer only. Adds copies of a contiguous block of rows, publishing the updated
+     * statistics once for the whole block.
+     *
+     * @param rows     pointer to the first of the rows to be added
+     * @param numRows  the number of rows to be added
+     * @see StatisticsBuffer#addRows(const DataContainer<T_width> * rows, size_t numRows)
+     */
+    void addRows(const DataContainer<T_width> * rows, size_t numRows);
+
+    /**
+     * Writer only. Removes the oldest numRowsToRemove rows and publishes the updated statistics.
+     *
+     * @see StatisticsBuffer#removeRows(unsigned int numRowsToRemove)
+     */
+    void removeRows(unsigned int numRowsToRemove);
+
+    /**
+     * Writer only. Adds a copy of the input row. Simply calls the addRow() method.
+     *
+     * @param rhs  the DataContainer instance to be added
+     * @return     a reference to the current ConcurrentStatisticsBuffer
+     */
+    ConcurrentStatisticsBuffer & operator += (const DataContainer<T_width> & rhs);
+
+    /**
+     * Writer only. Returns the underlying StatisticsBuffer, for access to the rows.
+     *
+     * @return a const reference to the writer's StatisticsBuffer
+     */
+    const StatisticsBuffer<T_length, T_width> & writerBuffer() const;
+
+    /**
+     * Returns a consistent snapshot of the most recently published statistics.
+     * Retries (yielding) while the writer is mid-publish, which takes O(T_width).
+     *
+     * @return a new StatisticsSummary of the published state
+     */
+    const StatisticsSummary<T_width> getSummary() const;
+
+    /**
+     * Returns the mean of each column, from a consistent snapshot.
+     * Asserts that the snapshot is not empty! Check currentLength() or use getSummary() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the standard deviation of each column, from a consistent snapshot.
+     * Asserts that the snapshot is not empty! Check currentLength() or use getSummary() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Returns the number of rows in the most recently published state, from a consistent snapshot.
+     *
+     * @return a size_t value of the current number of rows.
+     */
+    size_t currentLength() const;
+
+private:
+    /**
+     * Copies the writer's statistics into the published words, inside the sequence lock.
+     */
+    void publish();
+
+    /**
+     * Marks the start of a writer update: makes the sequence number odd.
+     */
+    void beginUpdate();
+
+    /**
+     * Marks the end of a writer update: makes the sequence number even again, publishing the update.
+     */
+    void endUpdate();
+
+    /**
+     * The writer's buffer. Readers never touch it, only the copy published from it below.
+     */
+    StatisticsBuffer<T_length, T_width> buffer_;
+
+    /**
+     * The statistics as of the last publish(), word by word for readers to copy.
+     */
+    std::array<std::atomic<double>, T_width> publishedK_;
+    std::array<std::atomic<double>, T_width> publishedEx_;
+    std::array<std::atomic<double>, T_width> publishedEx2_;
+    std::atomic<uint64_t> publishedNumRows_;
+
+    /**
+     * Sequence lock counter: odd while the writer is storing the published words, incremented
+     * twice per update.
+     */
+    std::atomic<unsigned int> sequence_;
+};
+
+#include "ConcurrentStatisticsBuffer_impl.h"
@@ -0,0 +1,104 @@
+#include "ConcurrentStatisticsBuffer.h"
+
+template <size_t T_length, size_t T_width>
+ConcurrentStatisticsBuffer<T_length, T_width>::ConcurrentStatisticsBuffer() : publishedNumRows_(0), sequence_(0) {
+    this->publish();
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::addRow(const DataContainer<T_width> &data) {
+    this->buffer_.addRow(data);
+    this->publish();
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::addRows(const DataContainer<T_width> *rows, size_t numRows) {
+    this->buffer_.addRows(rows, numRows);
+    this->publish();
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::removeRows(unsigned int numRowsToRemove) {
+    this->buffer_.removeRows(numRowsToRemove);
+    this->publish();
+}
+
+template <size_t T_length, size_t T_width>
+ConcurrentStatisticsBuffer<T_length, T_width> &
+ConcurrentStatisticsBuffer<T_length, T_width>::operator+=(const DataContainer<T_width> &data) {
+    this->addRow(data);
+    return *this;
+}
+
+template <size_t T_length, size_t T_width>
+const StatisticsBuffer<T_length, T_width> & ConcurrentStatisticsBuffer<T_length, T_width>::writerBuffer() const {
+    return this->buffer_;
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::publish() {
+    // Taken before the lock, so readers only ever wait out the stores below
+    const StatisticsSummary<T_width> summary = this->buffer_.getSummary();
+    this->beginUpdate();
+    // Release stores, so a reader that sees any of them also sees the odd sequence number
+    for (unsigned int i = 0; i < T_width; i++) {
+        this->publishedK_[i].store(summary.K[i], std::memory_order_release);
+        this->publishedEx_[i].store(summary.Ex[i], std::memory_order_release);
+        this->publishedEx2_[i].store(summary.Ex2[i], std::memory_order_release);
+    }
+    this->publishedNumRows_.store(summary.numRows, std::memory_order_release);
+    this->endUpdate();
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::beginUpdate() {
+    // Only the writer changes sequence_, so a relaxed load of our own last value is enough
+    this->sequence_.store(this->sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+template <size_t T_length, size_t T_width>
+void ConcurrentStatisticsBuffer<T_length, T_width>::endUpdate() {
+    this->sequence_.store(this->sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <size_t T_length, size_t T_width>
+const StatisticsSummary<T_width> ConcurrentStatisticsBuffer<T_length, T_width>::getSummary() const {
+    StatisticsSummary<T_width> summary;
+    unsigned int before, after;
+    while (true) {
+        before = this->sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Writer is mid-publish; let it finish rather than spin against it
+            std::this_thread::yield();
+            continue;
+        }
+
+        // These reads may overlap the next publish, in which case the copy is thrown away below.
+        // Acquire loads, so none of them can move past the re-check of the sequence number.
+        for (unsigned int i = 0; i < T_width; i++) {
+            summary.K[i] = this->publishedK_[i].load(std::memory_order_acquire);
+            summary.Ex[i] = this->publishedEx_[i].load(std::memory_order_acquire);
+            summary.Ex2[i] = this->publishedEx2_[i].load(std::memory_order_acquire);
+        }
+        summary.numRows = this->publishedNumRows_.load(std::memory_order_acquire);
+
+        after = this->sequence_.load(std::memory_order_relaxed);
+        if (before == after)
+            return summary;
+    }
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ConcurrentStatisticsBuffer<T_length, T_width>::getMean() const {
+    return this->getSummary().getMean();
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> ConcurrentStatisticsBuffer<T_length, T_width>::getStdDev() const {
+    return this->getSummary().getStdDev();
+}
+
+template <size_t T_length, size_t T_width>
+size_t ConcurrentStatisticsBuffer<T_length, T_width>::currentLength() const {
+    return this->getSummary().currentLength();
+}
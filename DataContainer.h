@@ -10,51 +10,55 @@
 #include <iterator>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include "ColumnKernels.h"
+#include "DataExpression.h"
 
 /**
- * A class for augmenting a double std::array. Defines operators for +, -, /,
+ * A class for augmenting a std::array, of doubles by default. Defines operators for +, -, /,
  * +=, and -=, along with Pow and Sqrt functions.
  *
+ * The element type T_value can be narrower than double (float, int16_t, ...) to store
+ * rows more compactly. Expressions are still computed in double, and assigning one to
+ * a DataContainer converts the result to T_value as by static_cast.
+ *
+ * The +, -, /, Pow and Sqrt operators return DataExpressions (see DataExpression.h),
+ * which are evaluated in one fused loop when assigned to a DataContainer, so compound
+ * expressions make no temporaries. They are const, so they work on const rows too.
+ * += and -= with another double DataContainer, and a lone /, Pow(2) or Sqrt of a whole
+ * double DataContainer assigned to one, run on ColumnKernels, so they use the widest
+ * SIMD instruction set available.
+ *
  */
-template<size_t T_width>
-class DataContainer : public std::array<double, T_width> {
+template<size_t T_width, class T_value = double>
+class DataContainer : public std::array<T_value, T_width>, public DataExpression<DataContainer<T_width, T_value>, T_width> {
 public:
     /**
-     * Returns a new DataContainer from the addition of two DataContainers. 
-     * The DataContainers must be the same length.
-     * This method simply calls the += operator.
-     *
-     * Example: d3 = d1 + d2;
-     *
-     * "this" is the left-hand-side of the + operator.
-     * @param rhs   the DataContainer instance on the right-hand-side of the + operator.
-     * @return      the new DataContainer containing the results
+     * Constructor, leaves the elements uninitialized like std::array.
      */
-    const DataContainer<T_width> operator + (const DataContainer<T_width> &rhs);
+    DataContainer() = default;
 
     /**
-     * Returns a new DataContainer from the subtraction of two DataContainers. 
-     * The DataContainers must be the same length.
-     * This method simply calls the -= operator.
+     * Constructor, evaluates an expression into the new DataContainer.
      *
-     * Example: d3 = d1 - d2;
+     * Example: DataContainer<4> d3 = d1 + d2;
      *
-     * "this" is the left-hand-side of the - operator.
-     * @param rhs   the DataContainer instance on the right-hand-side of the - operator.
-     * @return      the new DataContainer containing the results
+     * @param expression  the expression to be evaluated
      */
-    const DataContainer<T_width> operator - (const DataContainer<T_width> &rhs);
+    template <class T_expression>
+    DataContainer(const DataExpression<T_expression, T_width> & expression);
 
     /**
-     * Returns a new DataContainer from the division of a DataContainer by a constant.
+     * Evaluates an expression into the current DataContainer, in a single loop over the
+     * columns. The expression may refer to the current DataContainer.
      *
-     * Example: d3 = d1 / 5;
+     * Example: d3 = (d1 - d2).Pow(2) / 2;
      *
-     * "this" is the left-hand-side of the / operator.
-     * @param rhs   the constant on the right-hand-side of the / operator.
-     * @return      the new DataContainer containing the reuslts
+     * @param expression  the expression to be evaluated
+     * @return            returns reference to "this"
      */
-    const DataContainer<T_width> operator / (const double constant);
+    template <class T_expression>
+    DataContainer<T_width, T_value>& operator = (const DataExpression<T_expression, T_width> & expression);
 
     /**
      * Adds a DataContainer to the current DataContainer.
@@ -66,7 +70,7 @@ public:
      * @param rhs   the DataContainer instance on the right-hand-side of the += operator.
      * @return      returns reference to "this"
      */
-    DataContainer<T_width>& operator += (const DataContainer &rhs);
+    DataContainer<T_width, T_value>& operator += (const DataContainer &rhs);
 
     /**
      * Subtracts a DataContainer from the current DataContainer.
@@ -78,27 +82,27 @@ public:
      * @param rhs   the DataContainer instance on the right-hand-side of the -= operator.
      * @return      returns reference to "this"
      */
-    DataContainer<T_width>& operator -= (const DataContainer &rhs);
+    DataContainer<T_width, T_value>& operator -= (const DataContainer &rhs);
 
     /**
-     * Returns a new DataContainer with each element to the power of the exponent parameter.
+     * Adds an expression to the current DataContainer, in a single loop over the columns.
      *
-     * Example: d3 = d2.Pow(2);
+     * Example: d3 += (d1 - d2).Pow(2);
      *
-     * @param exponent   the exponent to be applied
-     * @return           a new DataContainer containing the results
+     * @param expression  the expression on the right-hand-side of the += operator.
+     * @return            returns reference to "this"
      */
-    const DataContainer<T_width> Pow(const double exponent);
+    template <class T_expression>
+    DataContainer<T_width, T_value>& operator += (const DataExpression<T_expression, T_width> & expression);
 
     /**
-     * Returns a new DataContainer with the square-root of each element.
+     * Subtracts an expression from the current DataContainer, in a single loop over the columns.
      *
-     * Example: d3 = d2.Sqrt();
-     *
-     * @return           a new DataContainer containing the results
+     * @param expression  the expression on the right-hand-side of the -= operator.
+     * @return            returns reference to "this"
      */
-    const DataContainer<T_width> Sqrt(); 
-
+    template <class T_expression>
+    DataContainer<T_width, T_value>& operator -= (const DataExpression<T_expression, T_width> & expression);
 
     /**
      * Returns an ostream object with a print-out of the DataContainer.
@@ -110,8 +114,8 @@ public:
      * @param data  DataContainer to be printed
      * @return      reference to the same input ostream object with added content
      */
-    template <size_t T>
-    friend std::ostream& operator << (std::ostream &os, const DataContainer<T> &data);
+    template <size_t T, class T_type>
+    friend std::ostream& operator << (std::ostream &os, const DataContainer<T, T_type> &data);
 };
 
 #include "DataContainer_impl.h"
@@ -1,56 +1,146 @@
 
-template <size_t T_width>
-const DataContainer<T_width> DataContainer<T_width>::operator + (const DataContainer<T_width> &rhs) {
-    return DataContainer<T_width>(*this) += rhs;
+// Rows are packed back to back and handed to ColumnKernels as plain arrays of doubles,
+// so the (empty) expression base must not add any size
+static_assert(sizeof(DataContainer<4>) == sizeof(std::array<double, 4>) &&
+              sizeof(DataContainer<4, float>) == sizeof(std::array<float, 4>),
+              "DataContainer must have the layout of std::array<T_value, T_width>");
+
+template <size_t T_width, class T_value>
+template <class T_expression>
+DataContainer<T_width, T_value>::DataContainer(const DataExpression<T_expression, T_width> &expression) {
+    *this = expression;
 }
+
+namespace DataContainerDetail {
+
+/**
+ * Whether an expression is a single division, power or square root of a whole row of
+ * doubles, which assigning to a row of doubles hands to ColumnKernels.
+ */
+template <class T_operand>
+struct IsDoubleRow : std::false_type {
+};
+
 template <size_t T_width>
-const DataContainer<T_width> DataContainer<T_width>::operator - (const DataContainer<T_width> &rhs) {
-    return DataContainer<T_width>(*this) -= rhs;
-}
+struct IsDoubleRow<DataContainer<T_width> > : std::true_type {
+};
 
 template <size_t T_width>
-const DataContainer<T_width> DataContainer<T_width>::operator / (const double constant) {
-    DataContainer<T_width> result = *this;
-    for (auto &r: result)
-        r /= constant;
-    return result;
+struct IsDoubleRow<DataReference<DataContainer<T_width> > > : std::true_type {
+};
+
+template <class T_value, class T_expression>
+struct UsesKernel : std::false_type {
+};
+
+template <class T_operand, class T_operation, size_t T_width>
+struct UsesKernel<double, DataUnaryExpression<T_operand, T_operation, T_width> > : IsDoubleRow<T_operand> {
+};
+
+template <size_t T_width>
+inline const DataContainer<T_width> & rowOf(const DataContainer<T_width> &row) {
+    return row;
 }
 
 template <size_t T_width>
-DataContainer<T_width> & DataContainer<T_width>::operator += (const DataContainer &rhs) {
-    // Not the prettiest iterator, but C++ doesn't have a zip function, it would seem :(
-    for (unsigned int i = 0; i < this->size(); i++) {
-        (*this)[i] = (*this)[i] + rhs[i];
+inline const DataContainer<T_width> & rowOf(const DataReference<DataContainer<T_width> > &row) {
+    return row.get();
+}
+
+inline void applyKernel(double *lhs, double constant, size_t n, DataDivide) {
+    ColumnKernels::divide(lhs, constant, n);
+}
+
+inline void applyKernel(double *lhs, double exponent, size_t n, DataPow) {
+    if (exponent == 2) {
+        ColumnKernels::square(lhs, n);
+        return;
     }
+    for (size_t i = 0; i < n; i++)
+        lhs[i] = std::pow(lhs[i], exponent);
+}
+
+inline void applyKernel(double *lhs, double, size_t n, DataSqrt) {
+    ColumnKernels::sqrt(lhs, n);
+}
+
+// Anything else is evaluated in one fused loop
+template <size_t T_width, class T_value, class T_expression>
+inline void assign(DataContainer<T_width, T_value> &lhs, const T_expression &e, std::false_type) {
+    for (size_t i = 0; i < T_width; i++)
+        lhs[i] = static_cast<T_value>(e[i]);
+}
+
+template <size_t T_width, class T_operand, class T_operation>
+inline void assign(DataContainer<T_width> &lhs, const DataUnaryExpression<T_operand, T_operation, T_width> &e,
+                   std::true_type) {
+    const DataContainer<T_width> &operand = rowOf(e.operand());
+    if (&operand != &lhs)
+        std::copy(operand.begin(), operand.end(), lhs.begin());
+    applyKernel(lhs.data(), e.constant(), T_width, T_operation());
+}
+
+// Doubles go to ColumnKernels; other element types take a plain loop
+inline void add(double *lhs, const double *rhs, size_t n) {
+    ColumnKernels::add(lhs, rhs, n);
+}
+
+template <class T_value>
+inline void add(T_value *lhs, const T_value *rhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] += rhs[i];
+}
+
+inline void subtract(double *lhs, const double *rhs, size_t n) {
+    ColumnKernels::subtract(lhs, rhs, n);
+}
+
+template <class T_value>
+inline void subtract(T_value *lhs, const T_value *rhs, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        lhs[i] -= rhs[i];
+}
+
+} // namespace DataContainerDetail
+
+template <size_t T_width, class T_value>
+template <class T_expression>
+DataContainer<T_width, T_value> & DataContainer<T_width, T_value>::operator = (const DataExpression<T_expression, T_width> &expression) {
+    DataContainerDetail::assign(*this, expression.self(), DataContainerDetail::UsesKernel<T_value, T_expression>());
     return *this;
 }
-template <size_t T_width>
-DataContainer<T_width> & DataContainer<T_width>::operator-=(const DataContainer &rhs) {
-    // Not the prettiest iterator, but C++ doesn't have a zip function, it would seem :(
-    for (unsigned int i = 0; i < this->size(); i++) {
-        (*this)[i] = (*this)[i] - rhs[i];
-    }
+
+template <size_t T_width, class T_value>
+DataContainer<T_width, T_value> & DataContainer<T_width, T_value>::operator += (const DataContainer &rhs) {
+    DataContainerDetail::add(this->data(), rhs.data(), T_width);
+    return *this;
+}
+template <size_t T_width, class T_value>
+DataContainer<T_width, T_value> & DataContainer<T_width, T_value>::operator-=(const DataContainer &rhs) {
+    DataContainerDetail::subtract(this->data(), rhs.data(), T_width);
     return *this;
 }
 
-template <size_t T_width>
-const DataContainer<T_width> DataContainer<T_width>::Pow(const double exponent) {
-    DataContainer<T_width> result = *this;
-    for (auto &r: result)
-        r = std::pow(r, exponent);
-    return result;
+template <size_t T_width, class T_value>
+template <class T_expression>
+DataContainer<T_width, T_value> & DataContainer<T_width, T_value>::operator += (const DataExpression<T_expression, T_width> &expression) {
+    const T_expression &e = expression.self();
+    for (size_t i = 0; i < T_width; i++)
+        (*this)[i] = static_cast<T_value>((*this)[i] + e[i]);
+    return *this;
 }
 
-template <size_t T_width>
-const DataContainer<T_width> DataContainer<T_width>::Sqrt() {
-    DataContainer<T_width> result = *this;
-    for (auto &r: result)
-        r = std::sqrt(r);
-    return result;
+template <size_t T_width, class T_value>
+template <class T_expression>
+DataContainer<T_width, T_value> & DataContainer<T_width, T_value>::operator -= (const DataExpression<T_expression, T_width> &expression) {
+    const T_expression &e = expression.self();
+    for (size_t i = 0; i < T_width; i++)
+        (*this)[i] = static_cast<T_value>((*this)[i] - e[i]);
+    return *this;
 }
 
-template <size_t T_width>
-inline std::ostream& operator << (std::ostream &os, const DataContainer<T_width> &data) {
+template <size_t T_width, class T_value>
+inline std::ostream& operator << (std::ostream &os, const DataContainer<T_width, T_value> &data) {
     for (auto d: data)
         os << d << ' ';
     return os;
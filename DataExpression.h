@@ -0,0 +1,256 @@
+/* Header for the DataExpression templates behind DataContainer's arithmetic operators.
+ * Everything here is templated and defined inline.
+ *
+ * An operator on DataContainers does not compute anything itself: it returns a small
+ * expression object recording the operation and (references to) its operands. The
+ * work happens when the expression is assigned to a DataContainer, in a single loop
+ * over the columns that evaluates the whole expression for one column at a time. So
+ * d3 = (d1 - d2).Pow(2) / n makes no intermediate arrays, and the loop is left to the
+ * compiler to vectorize.
+ *
+ * Expressions hold references to the named DataContainers they were built from, and
+ * copies of temporary ones (such as the result of getMean()), so an expression kept in
+ * an auto variable stays valid for as long as the named DataContainers in it.
+ */
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+template <size_t T_width, class T_value>
+class DataContainer;
+
+template <class T_operand, class T_operation, size_t T_width>
+class DataUnaryExpression;
+
+/**
+ * Elementwise operations, as used by the expression nodes.
+ */
+struct DataAdd {
+    static constexpr double apply(double lhs, double rhs) { return lhs + rhs; }
+};
+
+struct DataSubtract {
+    static constexpr double apply(double lhs, double rhs) { return lhs - rhs; }
+};
+
+struct DataDivide {
+    static constexpr double apply(double lhs, double rhs) { return lhs / rhs; }
+};
+
+struct DataPow {
+    // Squaring is by far the common case (variances), and x*x is exactly what std::pow(x, 2) returns
+    static double apply(double value, double exponent) {
+        return exponent == 2 ? value * value : std::pow(value, exponent);
+    }
+};
+
+struct DataSqrt {
+    static double apply(double value, double) { return std::sqrt(value); }
+};
+
+/**
+ * A named DataContainer as an expression operand, held by reference so it is not copied.
+ */
+template <class T_container>
+class DataReference {
+public:
+    DataReference(const T_container & container) : container_(container) {}
+
+    double operator[](size_t i) const { return this->container_[i]; }
+
+    const T_container & get() const { return this->container_; }
+
+private:
+    const T_container &container_;
+};
+
+/**
+ * How an expression node stores an operand, given its type as deduced by a forwarding
+ * reference: named DataContainers through a DataReference, and everything else (small
+ * expression nodes, and temporary DataContainers that would otherwise dangle) by value.
+ */
+template <class T_operand>
+struct DataOperand {
+    typedef typename std::decay<T_operand>::type type;
+};
+
+template <size_t T_width, class T_value>
+struct DataOperand<DataContainer<T_width, T_value> &> {
+    typedef DataReference<DataContainer<T_width, T_value> > type;
+};
+
+template <size_t T_width, class T_value>
+struct DataOperand<const DataContainer<T_width, T_value> &> {
+    typedef DataReference<DataContainer<T_width, T_value> > type;
+};
+
+/**
+ * Base of every expression over T_width columns, including DataContainer itself
+ * (the curiously recurring template pattern). T_expression provides
+ * double operator[](size_t) const giving the value of one column. Expressions are
+ * evaluated in double whatever the element type of the DataContainers involved.
+ */
+template <class T_expression, size_t T_width>
+class DataExpression {
+public:
+    /**
+     * Returns the expression as its actual type.
+     */
+    constexpr const T_expression & self() const { return static_cast<const T_expression &>(*this); }
+
+    /**
+     * Returns an expression raising each element to the power of the exponent. Called on
+     * a temporary, the expression keeps a copy of it.
+     *
+     * Example: d3 = (d1 - d2).Pow(2);
+     *
+     * @param exponent   the exponent to be applied
+     * @return           the expression
+     */
+    const DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataPow, T_width>
+    Pow(double exponent) const &;
+    const DataUnaryExpression<T_expression, DataPow, T_width> Pow(double exponent) const &&;
+
+    /**
+     * Returns an expression taking the square-root of each element. Called on a
+     * temporary, the expression keeps a copy of it.
+     *
+     * Example: d3 = d2.Sqrt();
+     *
+     * @return           the expression
+     */
+    const DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataSqrt, T_width> Sqrt() const &;
+    const DataUnaryExpression<T_expression, DataSqrt, T_width> Sqrt() const &&;
+};
+
+/**
+ * The width of an expression type, or of two with the same width; no value otherwise, so
+ * the operators below only take DataExpressions.
+ */
+template <class T_expression, size_t T_width>
+std::integral_constant<size_t, T_width> dataWidthOf(const DataExpression<T_expression, T_width> *);
+
+template <class T_lhs, class T_rhs = T_lhs, class = void>
+struct DataWidth {
+};
+
+template <class T_lhs, class T_rhs>
+struct DataWidth<T_lhs, T_rhs, typename std::enable_if<
+        decltype(dataWidthOf(static_cast<typename std::decay<T_lhs>::type *>(nullptr)))::value ==
+        decltype(dataWidthOf(static_cast<typename std::decay<T_rhs>::type *>(nullptr)))::value>::type>
+        : decltype(dataWidthOf(static_cast<typename std::decay<T_lhs>::type *>(nullptr))) {
+};
+
+/**
+ * Elementwise operation between two expressions, stored as given by DataOperand.
+ */
+template <class T_lhs, class T_rhs, class T_operation, size_t T_width>
+class DataBinaryExpression : public DataExpression<DataBinaryExpression<T_lhs, T_rhs, T_operation, T_width>, T_width> {
+public:
+    template <class T_lhsArg, class T_rhsArg>
+    DataBinaryExpression(T_lhsArg && lhs, T_rhsArg && rhs)
+        : lhs_(std::forward<T_lhsArg>(lhs)), rhs_(std::forward<T_rhsArg>(rhs)) {}
+
+    double operator[](size_t i) const { return T_operation::apply(this->lhs_[i], this->rhs_[i]); }
+
+private:
+    T_lhs lhs_;
+    T_rhs rhs_;
+};
+
+/**
+ * Elementwise operation between an expression, stored as given by DataOperand, and a constant.
+ */
+template <class T_operand, class T_operation, size_t T_width>
+class DataUnaryExpression : public DataExpression<DataUnaryExpression<T_operand, T_operation, T_width>, T_width> {
+public:
+    template <class T_operandArg>
+    DataUnaryExpression(T_operandArg && operand, double constant)
+        : operand_(std::forward<T_operandArg>(operand)), constant_(constant) {}
+
+    double operator[](size_t i) const { return T_operation::apply(this->operand_[i], this->constant_); }
+
+    /**
+     * The operand and constant, so that DataContainer can hand a whole-row operation to ColumnKernels.
+     */
+    const T_operand & operand() const { return this->operand_; }
+    double constant() const { return this->constant_; }
+
+private:
+    T_operand operand_;
+    double constant_;
+};
+
+template <class T_expression, size_t T_width>
+inline const DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataPow, T_width>
+DataExpression<T_expression, T_width>::Pow(double exponent) const & {
+    return DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataPow, T_width>(this->self(), exponent);
+}
+
+template <class T_expression, size_t T_width>
+inline const DataUnaryExpression<T_expression, DataPow, T_width>
+DataExpression<T_expression, T_width>::Pow(double exponent) const && {
+    return DataUnaryExpression<T_expression, DataPow, T_width>(this->self(), exponent);
+}
+
+template <class T_expression, size_t T_width>
+inline const DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataSqrt, T_width>
+DataExpression<T_expression, T_width>::Sqrt() const & {
+    return DataUnaryExpression<typename DataOperand<const T_expression &>::type, DataSqrt, T_width>(this->self(), 0);
+}
+
+template <class T_expression, size_t T_width>
+inline const DataUnaryExpression<T_expression, DataSqrt, T_width> DataExpression<T_expression, T_width>::Sqrt() const && {
+    return DataUnaryExpression<T_expression, DataSqrt, T_width>(this->self(), 0);
+}
+
+/**
+ * Returns an expression adding two expressions elementwise.
+ *
+ * Example: d3 = d1 + d2;
+ */
+template <class T_lhs, class T_rhs>
+inline const DataBinaryExpression<typename DataOperand<T_lhs>::type, typename DataOperand<T_rhs>::type, DataAdd,
+                                  DataWidth<T_lhs, T_rhs>::value>
+operator + (T_lhs && lhs, T_rhs && rhs) {
+    return DataBinaryExpression<typename DataOperand<T_lhs>::type, typename DataOperand<T_rhs>::type, DataAdd,
+                                DataWidth<T_lhs, T_rhs>::value>(std::forward<T_lhs>(lhs), std::forward<T_rhs>(rhs));
+}
+
+/**
+ * Returns an expression subtracting two expressions elementwise.
+ *
+ * Example: d3 = d1 - d2;
+ */
+template <class T_lhs, class T_rhs>
+inline const DataBinaryExpression<typename DataOperand<T_lhs>::type, typename DataOperand<T_rhs>::type, DataSubtract,
+                                  DataWidth<T_lhs, T_rhs>::value>
+operator - (T_lhs && lhs, T_rhs && rhs) {
+    return DataBinaryExpression<typename DataOperand<T_lhs>::type, typename DataOperand<T_rhs>::type, DataSubtract,
+                                DataWidth<T_lhs, T_rhs>::value>(std::forward<T_lhs>(lhs), std::forward<T_rhs>(rhs));
+}
+
+/**
+ * Returns an expression dividing each element of an expression by a constant.
+ *
+ * Example: d3 = d1 / 5;
+ */
+template <class T_operand>
+inline const DataUnaryExpression<typename DataOperand<T_operand>::type, DataDivide, DataWidth<T_operand>::value>
+operator / (T_operand && lhs, double constant) {
+    return DataUnaryExpression<typename DataOperand<T_operand>::type, DataDivide, DataWidth<T_operand>::value>(
+            std::forward<T_operand>(lhs), constant);
+}
+
+/**
+ * Prints the value of an expression, as for a DataContainer.
+ */
+template <class T_expression, size_t T_width>
+inline std::ostream & operator << (std::ostream & os, const DataExpression<T_expression, T_width> & expression) {
+    for (size_t i = 0; i < T_width; i++)
+        os << expression.self()[i] << ' ';
+    return os;
+}
@@ -0,0 +1,282 @@
+/* Header for DynamicStatisticsBuffer class. The implementations of the functions
+ * are included directly by this header, like the templated classes.
+ */
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * A StatisticsBuffer whose length and width are chosen at runtime, for windows too
+ * large to live inside an object or sized from configuration.
+ *
+ * The rows and the K, Ex and Ex2 accumulators live in a single 64-byte aligned slab.
+ * The slab comes from the heap, from huge pages (falling back to transparent huge
+ * pages, then normal pages, if none are reserved), or from memory supplied by the
+ * caller. Rows are passed in and out as pointers to width contiguous doubles.
+ *
+ * The statistics are computed (and K re-centered) exactly as in StatisticsBuffer, so
+ * for the same rows both give identical results. As there, the ring is indexed with a
+ * mask when the length is a power of two, and otherwise with a compare-and-reset.
+ */
+class DynamicStatisticsBuffer {
+public:
+    /**
+     * Where the slab is allocated when the buffer allocates it itself.
+     */
+    enum Backing { Heap, HugePages };
+
+    /**
+     * Constructor, allocates the slab and initializes internal K_, Ex_, and Ex2_ variables.
+     * Throws std::bad_alloc if the slab cannot be allocated.
+     *
+     * @param length   the maximum number of rows
+     * @param width    the number of columns in each row
+     * @param backing  where to allocate the slab from
+     */
+    DynamicStatisticsBuffer(size_t length, size_t width, Backing backing = Heap);
+
+    /**
+     * Constructor, places the slab in memory owned by the caller (an arena), which must
+     * outlive the buffer and be at least requiredBytes(length, width) long, or
+     * alignedBytes(length, width) if it is already 64-byte aligned. Throws
+     * std::invalid_argument if it is too small.
+     *
+     * @param length      the maximum number of rows
+     * @param width       the number of columns in each row
+     * @param arena       the memory to place the slab in; need not be aligned
+     * @param arenaBytes  the size of the memory
+     */
+    DynamicStatisticsBuffer(size_t length, size_t width, void * arena, size_t arenaBytes);
+
+    /**
+     * Destructor, releases the slab unless it was supplied by the caller.
+     */
+    ~DynamicStatisticsBuffer();
+
+    DynamicStatisticsBuffer(const DynamicStatisticsBuffer &) = delete;
+    DynamicStatisticsBuffer & operator = (const DynamicStatisticsBuffer &) = delete;
+
+    /**
+     * Returns the number of bytes of arena memory needed for a buffer of the given shape.
+     *
+     * @param length  the maximum number of rows
+     * @param width   the number of columns in each row
+     * @return        the arena size in bytes, including slack for alignment
+     */
+    static size_t requiredBytes(size_t length, size_t width);
+
+    /**
+     * Returns the number of bytes of arena memory needed for a buffer of the given shape when
+     * the arena is 64-byte aligned, rounded up so buffers packed back to back stay aligned.
+     *
+     * @param length  the maximum number of rows
+     * @param width   the number of columns in each row
+     * @return        the arena size in bytes
+     */
+    static size_t alignedBytes(size_t length, size_t width);
+
+    /**
+     * Adds a copy of the input row to the circular buffer, cycling out the oldest entry if necessary.
+     *
+     * @param data  pointer to width() doubles to be added
+     * @see StatisticsBuffer#addRow(const DataContainer<T_width> & data)
+     */
+    void addRow(const double * data);
+
+    /**
+     * Adds copies of a contiguous block of rows, oldest first, in one pass over the stats, each
+     * kernel sweep of rows copied into the buffer while still in cache.
+     *
+     * @param rows     pointer to numRows * width() doubles
+     * @param numRows  the number of rows to be added
+     * @see StatisticsBuffer#addRows(const DataContainer<T_width> * rows, size_t numRows)
+     */
+    void addRows(const double * rows, size_t numRows);
+
+    /**
+     * Removes the oldest row from the circular buffer. Simply calls removeRows(1);
+     */
+    void removeRow();
+
+    /**
+     * Removes the oldest numRowsToRemove rows from the circular buffer. If there are less rows
+     * than specified, it stops after removing what it can.
+     */
+    void removeRows(unsigned int numRowsToRemove);
+
+    /**
+     * Returns the row specified by the index, in chronological order from oldest to newest.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param index  the row to be returned
+     * @return       pointer to the width() doubles of the row, valid until it is cycled out
+     */
+    const double * getRow(unsigned int index) const;
+
+    /**
+     * Returns the row most recently added. Equivalent to getRow(currentLength() - 1).
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return       pointer to the width() doubles of the row, valid until it is cycled out
+     */
+    const double * getLatestRow() const;
+
+    /**
+     * Returns the current mean of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new vector containing the mean of each column.
+     */
+    std::vector<double> getMean() const;
+
+    /**
+     * Writes the current mean of each column to mean, without allocating.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param mean  pointer to width() doubles to be overwritten
+     */
+    void getMean(double * mean) const;
+
+    /**
+     * Returns the current standard deviation of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new vector containing the standard deviation of each column.
+     */
+    std::vector<double> getStdDev() const;
+
+    /**
+     * Writes the current standard deviation of each column to stdDev, without allocating.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param stdDev  pointer to width() doubles to be overwritten
+     */
+    void getStdDev(double * stdDev) const;
+
+    /**
+     * Moves the internal location parameter of each column to its current mean, as
+     * StatisticsBuffer::recenter() does. Called automatically once per length rows added.
+     */
+    void recenter();
+
+    /**
+     * Returns the maximum length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the maximum number of rows.
+     */
+    size_t maxLength() const;
+
+    /**
+     * Returns the number of columns in each row.
+     *
+     * @return a size_t value of the width.
+     */
+    size_t width() const;
+
+    /**
+     * Returns the current length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the current number of rows.
+     */
+    size_t currentLength() const;
+
+    /**
+     * Returns true if the buffer no longer contains any entries, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+    /**
+     * Returns true if the buffer is full, otherwise false.
+     * Note that this does NOT imply that entries cannot be added.
+     *
+     * @return boolean result of test
+     */
+    bool isFull() const;
+
+private:
+    /**
+     * Alignment of the slab and of each accumulator in it: one cache line.
+     */
+    static constexpr size_t alignment = 64;
+    /**
+     * Size of a huge page, which a HugePages slab is rounded up to.
+     */
+    static constexpr size_t hugePageBytes = 2 * 1024 * 1024;
+
+    /**
+     * Number of doubles in each accumulator, rounded up to whole cache lines.
+     */
+    static size_t paddedWidth(size_t width);
+
+    /**
+     * Number of bytes in the slab itself, without alignment slack.
+     */
+    static size_t slabBytes(size_t length, size_t width);
+
+    /**
+     * Points K_, Ex_, Ex2_ and rows_ into the (aligned) slab and zeroes the accumulators.
+     */
+    void layOut(void * slab);
+
+    /**
+     * Returns index, less than 2 * length_, wrapped into the ring.
+     */
+    size_t wrap(size_t index) const;
+
+    /**
+     * Returns the index following index in the ring.
+     */
+    size_t next(size_t index) const;
+
+    /**
+     * Returns the row stored in the given slot of the circular buffer.
+     */
+    double * slot(size_t index) const;
+
+    size_t length_;
+    size_t width_;
+    Backing backing_;
+    /**
+     * Start of the memory allocated for the slab, or nullptr if it was supplied by the caller.
+     */
+    void * allocation_ = nullptr;
+    /**
+     * Size of allocation_ in bytes, needed to unmap huge pages.
+     */
+    size_t allocationBytes_ = 0;
+
+    /**
+     * The rows of the circular buffer, length_ rows of width_ doubles each, inside the slab.
+     */
+    double * rows_;
+    /**
+     * Index of the circular buffer corresponding to the oldest entry.
+     */
+    size_t headIndex_ = 0;
+    /**
+     * Index of the circular buffer corresponding to the newest entry.
+     * Starts at length_ - 1 so we can pre-increment in addRow.
+     */
+    size_t tailIndex_;
+    /**
+     * Current length of the buffer.
+     */
+    size_t numRows_ = 0;
+
+    /**
+     * Internal "location parameter", used to ensure subtractions are not too far from the mean.
+     */
+    double * K_;
+    /**
+     * Internal parameter containing the difference between the datapoint and the location parameter
+     */
+    double * Ex_;
+    /**
+     * Internal parameter containing the square of Ex_
+     */
+    double * Ex2_;
+};
+
+#include "DynamicStatisticsBuffer_impl.h"
@@ -0,0 +1,252 @@
+#include "DynamicStatisticsBuffer.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include "ColumnKernels.h"
+#include "RingAppend.h"
+
+inline DynamicStatisticsBuffer::DynamicStatisticsBuffer(size_t length, size_t width, Backing backing)
+        : length_(length), width_(width), backing_(backing) {
+    assert(length > 0 && width > 0);
+    size_t bytes = slabBytes(length, width);
+    void *slab = nullptr;
+
+    if (backing == HugePages) {
+        this->allocationBytes_ = (bytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes;
+        slab = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        // Reserved huge pages, if the system has any left
+        slab = mmap(nullptr, this->allocationBytes_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (slab == MAP_FAILED) {
+            // Otherwise ask for transparent huge pages on ordinary memory
+            slab = mmap(nullptr, this->allocationBytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (slab == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(slab, this->allocationBytes_, MADV_HUGEPAGE);
+#endif
+        }
+    } else {
+        this->allocationBytes_ = bytes;
+        if (posix_memalign(&slab, alignment, bytes) != 0)
+            throw std::bad_alloc();
+    }
+    this->allocation_ = slab;
+    this->layOut(slab);
+}
+
+inline DynamicStatisticsBuffer::DynamicStatisticsBuffer(size_t length, size_t width, void *arena, size_t arenaBytes)
+        : length_(length), width_(width), backing_(Heap) {
+    assert(length > 0 && width > 0);
+    uintptr_t address = reinterpret_cast<uintptr_t>(arena);
+    address = (address + alignment - 1) & ~uintptr_t(alignment - 1);
+    if (address + slabBytes(length, width) > reinterpret_cast<uintptr_t>(arena) + arenaBytes)
+        throw std::invalid_argument("DynamicStatisticsBuffer: arena too small for the buffer's slab");
+    this->layOut(reinterpret_cast<void *>(address));
+}
+
+inline DynamicStatisticsBuffer::~DynamicStatisticsBuffer() {
+    if (this->allocation_ == nullptr)
+        return; // the caller's arena
+    if (this->backing_ == HugePages)
+        munmap(this->allocation_, this->allocationBytes_);
+    else
+        free(this->allocation_);
+}
+
+inline size_t DynamicStatisticsBuffer::requiredBytes(size_t length, size_t width) {
+    return slabBytes(length, width) + alignment - 1;
+}
+
+inline size_t DynamicStatisticsBuffer::alignedBytes(size_t length, size_t width) {
+    return (slabBytes(length, width) + alignment - 1) / alignment * alignment;
+}
+
+inline size_t DynamicStatisticsBuffer::paddedWidth(size_t width) {
+    const size_t doublesPerLine = alignment / sizeof(double);
+    return (width + doublesPerLine - 1) / doublesPerLine * doublesPerLine;
+}
+
+inline size_t DynamicStatisticsBuffer::slabBytes(size_t length, size_t width) {
+    // K, Ex and Ex2 each start on a cache line, followed by the rows packed back to back
+    return (3 * paddedWidth(width) + length * width) * sizeof(double);
+}
+
+inline void DynamicStatisticsBuffer::layOut(void *slab) {
+    double *doubles = static_cast<double *>(slab);
+    size_t stride = paddedWidth(this->width_);
+    this->K_ = doubles;
+    this->Ex_ = doubles + stride;
+    this->Ex2_ = doubles + 2 * stride;
+    this->rows_ = doubles + 3 * stride;
+    std::fill(this->K_, this->rows_, 0.0);
+    this->tailIndex_ = this->length_ - 1;
+}
+
+inline size_t DynamicStatisticsBuffer::wrap(size_t index) const {
+    // The length never changes, so the branch always goes the same way
+    if ((this->length_ & (this->length_ - 1)) == 0)
+        return index & (this->length_ - 1);
+    return index < this->length_ ? index : index - this->length_;
+}
+
+inline size_t DynamicStatisticsBuffer::next(size_t index) const {
+    return this->wrap(index + 1);
+}
+
+inline double * DynamicStatisticsBuffer::slot(size_t index) const {
+    return this->rows_ + index * this->width_;
+}
+
+inline void DynamicStatisticsBuffer::addRow(const double *data) {
+    if (this->numRows_ == 0) {
+        // K must be initialized to a value within the sample range.
+        // Close to mean is preferable, but not required.
+        std::copy(data, data + this->width_, this->K_);
+    }
+
+    this->tailIndex_ = this->next(this->tailIndex_);
+    double *tail = this->slot(this->tailIndex_);
+
+    if (this->numRows_ < this->length_) {
+        this->numRows_++;
+        ColumnKernels::addShifted(this->Ex_, this->Ex2_, data, this->K_, this->width_);
+    } else {
+        // the tail slot holds the current head, which is replaced in the same pass
+        ColumnKernels::replaceShifted(this->Ex_, this->Ex2_, tail, data, this->K_, this->width_);
+        this->headIndex_ = this->next(this->headIndex_);
+    }
+
+    std::copy(data, data + this->width_, tail);
+
+    if (this->tailIndex_ == this->length_ - 1)
+        this->recenter();
+}
+
+inline void DynamicStatisticsBuffer::addRows(const double *rows, size_t numRows) {
+    if (numRows == 0)
+        return;
+
+    const size_t width = this->width_, length = this->length_;
+    if (this->numRows_ == 0)
+        std::copy(rows, rows + width, this->K_);
+
+    if (numRows > length) {
+        // Rows that would be cycled out again by the end of the block are skipped (keeping K)
+        rows += (numRows - length) * width;
+        numRows = length;
+        this->numRows_ = 0;
+        this->headIndex_ = 0;
+        this->tailIndex_ = length - 1;
+        std::fill(this->Ex_, this->Ex_ + width, 0.0);
+        std::fill(this->Ex2_, this->Ex2_ + width, 0.0);
+    }
+
+    // The first numFree new rows land in empty slots; each one after that evicts the current head
+    const size_t start = this->next(this->tailIndex_);
+    const size_t numFree = length - this->numRows_;
+    const size_t numEvicted = numRows > numFree ? numRows - numFree : 0;
+
+    appendToRing(length, start, numFree, numRows, ColumnKernels::sweepRows(width),
+                 [&](size_t first, size_t, size_t count) {
+                     ColumnKernels::addShiftedRows(this->Ex_, this->Ex2_, rows + first * width, count, this->K_, width);
+                 },
+                 [&](size_t first, size_t slot, size_t count) {
+                     ColumnKernels::replaceShiftedRows(this->Ex_, this->Ex2_, this->slot(slot), rows + first * width,
+                                                       count, this->K_, width);
+                 },
+                 [&](size_t first, size_t slot, size_t count) {
+                     std::copy(rows + first * width, rows + (first + count) * width, this->slot(slot));
+                 },
+                 [&](size_t numRowsNow) {
+                     ColumnKernels::recenter(this->K_, this->Ex_, this->Ex2_, numRowsNow, width);
+                 });
+
+    this->numRows_ += numRows - numEvicted;
+    this->headIndex_ = this->wrap(this->headIndex_ + numEvicted);
+    this->tailIndex_ = this->wrap(start + numRows - 1);
+}
+
+inline void DynamicStatisticsBuffer::removeRow() {
+    this->removeRows(1);
+}
+
+inline void DynamicStatisticsBuffer::removeRows(unsigned int numRowsToRemove) {
+    assert(!this->isEmpty());
+
+    const size_t numRemoved = std::min<size_t>(numRowsToRemove, this->numRows_);
+    const size_t firstLength = std::min(numRemoved, this->length_ - this->headIndex_);
+    ColumnKernels::removeShiftedRows(this->Ex_, this->Ex2_, this->slot(this->headIndex_), firstLength,
+                                     this->K_, this->width_);
+    ColumnKernels::removeShiftedRows(this->Ex_, this->Ex2_, this->slot(0), numRemoved - firstLength,
+                                     this->K_, this->width_);
+
+    this->numRows_ -= numRemoved;
+    this->headIndex_ = this->wrap(this->headIndex_ + numRemoved);
+}
+
+inline const double * DynamicStatisticsBuffer::getRow(unsigned int index) const {
+    assert(!this->isEmpty());
+    return this->slot(this->wrap(this->headIndex_ + index));
+}
+
+inline const double * DynamicStatisticsBuffer::getLatestRow() const {
+    assert(!this->isEmpty());
+    return this->slot(this->tailIndex_);
+}
+
+inline std::vector<double> DynamicStatisticsBuffer::getMean() const {
+    std::vector<double> mean(this->width_);
+    this->getMean(mean.data());
+    return mean;
+}
+
+inline void DynamicStatisticsBuffer::getMean(double *mean) const {
+    assert(!this->isEmpty());
+    ColumnKernels::mean(mean, this->K_, this->Ex_, this->numRows_, this->width_);
+}
+
+inline std::vector<double> DynamicStatisticsBuffer::getStdDev() const {
+    std::vector<double> stdDev(this->width_);
+    this->getStdDev(stdDev.data());
+    return stdDev;
+}
+
+inline void DynamicStatisticsBuffer::getStdDev(double *stdDev) const {
+    assert(!this->isEmpty());
+    ColumnKernels::stdDev(stdDev, this->Ex_, this->Ex2_, this->numRows_, this->width_);
+}
+
+inline void DynamicStatisticsBuffer::recenter() {
+    if (this->numRows_ == 0)
+        return;
+    ColumnKernels::recenter(this->K_, this->Ex_, this->Ex2_, this->numRows_, this->width_);
+}
+
+inline size_t DynamicStatisticsBuffer::maxLength() const {
+    return this->length_;
+}
+
+inline size_t DynamicStatisticsBuffer::width() const {
+    return this->width_;
+}
+
+inline size_t DynamicStatisticsBuffer::currentLength() const {
+    return this->numRows_;
+}
+
+inline bool DynamicStatisticsBuffer::isEmpty() const {
+    return this->numRows_ == 0;
+}
+
+inline bool DynamicStatisticsBuffer::isFull() const {
+    return this->numRows_ == this->length_;
+}
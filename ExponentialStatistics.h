@@ -0,0 +1,131 @@
+/* Header for ExponentialStatistics class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <assert.h>
+#include <cstdint>
+#include "DataContainer.h"
+
+/**
+ * Exponentially weighted mean and standard deviation of each column, for series that
+ * need a recent-history estimate rather than an exact rectangular window. No rows are
+ * kept: the state is the current mean and variance of each column, 2 * T_width doubles,
+ * so a series costs a few cache lines instead of T_length rows.
+ *
+ * Each row added moves the estimates towards it by the smoothing factor alpha, so a row
+ * k rows old carries (1 - alpha)^k of the weight of the newest. The decay can be given as
+ * alpha, as a half-life (the number of rows after which a row's weight has halved), or
+ * as the length of the rectangular window with the same average row age (alpha = 2 / (length + 1)).
+ * The update (West's incremental weighted variance) runs on ColumnKernels::addDecayed.
+ *
+ * The first row starts the estimates, with zero variance; there is no warm-up correction.
+ * The standard deviation is that of the weighted rows, without a small-sample correction.
+ *
+ * Example: ExponentialStatistics<4> stats = ExponentialStatistics<4>::fromHalfLife(500); stats.addRow(row);
+ */
+template <size_t T_width>
+class ExponentialStatistics {
+public:
+    /**
+     * Constructor, with the decay given as the smoothing factor.
+     *
+     * @param alpha  the weight of each new row, in (0, 1]
+     */
+    explicit ExponentialStatistics(double alpha);
+
+    /**
+     * Returns estimates whose rows' weight halves every halfLife rows.
+     *
+     * @param halfLife  the half-life in rows, greater than 0
+     * @return          a new, empty ExponentialStatistics
+     */
+    static ExponentialStatistics fromHalfLife(double halfLife);
+
+    /**
+     * Returns estimates with the same average row age as a rectangular window of the given length.
+     *
+     * @param length  the equivalent window length in rows, at least 1
+     * @return        a new, empty ExponentialStatistics
+     */
+    static ExponentialStatistics fromWindowLength(double length);
+
+    /**
+     * Adds a row to the estimates.
+     *
+     * @param data  the DataContainer instance to be added
+     */
+    void addRow(const DataContainer<T_width> & data);
+
+    /**
+     * Adds a contiguous block of rows, oldest first. Equivalent to calling addRow() on each.
+     *
+     * @param rows     pointer to the first of the rows to be added
+     * @param numRows  the number of rows to be added
+     */
+    void addRows(const DataContainer<T_width> * rows, size_t numRows);
+
+    /**
+     * Adds a row to the estimates. Simply calls the addRow() method.
+     *
+     * @param rhs  the DataContainer instance to be added
+     * @return     a reference to the current ExponentialStatistics
+     */
+    ExponentialStatistics & operator += (const DataContainer<T_width> & rhs);
+
+    /**
+     * Returns the exponentially weighted mean of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the exponentially weighted standard deviation of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Forgets every row added, as if newly constructed.
+     */
+    void clear();
+
+    /**
+     * Returns the smoothing factor, the weight of each new row.
+     *
+     * @return the smoothing factor alpha
+     */
+    double alpha() const;
+
+    /**
+     * Returns the number of rows added since construction or the last clear().
+     *
+     * @return a uint64_t value of the number of rows.
+     */
+    uint64_t rowsAdded() const;
+
+    /**
+     * Returns true if no rows have been added, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+private:
+    double alpha_;
+    uint64_t rowsAdded_ = 0;
+    /**
+     * The exponentially weighted mean of each column.
+     */
+    DataContainer<T_width> mean_;
+    /**
+     * The exponentially weighted variance of each column.
+     */
+    DataContainer<T_width> variance_;
+};
+
+#include "ExponentialStatistics_impl.h"
@@ -0,0 +1,81 @@
+#include "ExponentialStatistics.h"
+#include <cmath>
+#include "ColumnKernels.h"
+
+template <size_t T_width>
+ExponentialStatistics<T_width>::ExponentialStatistics(double alpha) : alpha_(alpha) {
+    assert(alpha > 0 && alpha <= 1);
+    this->mean_.fill(0);
+    this->variance_.fill(0);
+}
+
+template <size_t T_width>
+ExponentialStatistics<T_width> ExponentialStatistics<T_width>::fromHalfLife(double halfLife) {
+    assert(halfLife > 0);
+    // (1 - alpha)^halfLife = 1/2
+    return ExponentialStatistics(-std::expm1(-std::log(2.0) / halfLife));
+}
+
+template <size_t T_width>
+ExponentialStatistics<T_width> ExponentialStatistics<T_width>::fromWindowLength(double length) {
+    assert(length >= 1);
+    return ExponentialStatistics(2 / (length + 1));
+}
+
+template <size_t T_width>
+void ExponentialStatistics<T_width>::addRow(const DataContainer<T_width> &data) {
+    if (this->rowsAdded_ == 0) {
+        this->mean_ = data;
+    } else {
+        ColumnKernels::addDecayed(this->mean_.data(), this->variance_.data(), data.data(), this->alpha_, T_width);
+    }
+    this->rowsAdded_++;
+}
+
+template <size_t T_width>
+void ExponentialStatistics<T_width>::addRows(const DataContainer<T_width> *rows, size_t numRows) {
+    for (size_t r = 0; r < numRows; r++)
+        this->addRow(rows[r]);
+}
+
+template <size_t T_width>
+ExponentialStatistics<T_width> & ExponentialStatistics<T_width>::operator+=(const DataContainer<T_width> &data) {
+    this->addRow(data);
+    return *this;
+}
+
+template <size_t T_width>
+const DataContainer<T_width> ExponentialStatistics<T_width>::getMean() const {
+    assert(!this->isEmpty());
+    return this->mean_;
+}
+
+template <size_t T_width>
+const DataContainer<T_width> ExponentialStatistics<T_width>::getStdDev() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> stdDev = this->variance_;
+    ColumnKernels::sqrt(stdDev.data(), T_width);
+    return stdDev;
+}
+
+template <size_t T_width>
+void ExponentialStatistics<T_width>::clear() {
+    this->rowsAdded_ = 0;
+    this->mean_.fill(0);
+    this->variance_.fill(0);
+}
+
+template <size_t T_width>
+double ExponentialStatistics<T_width>::alpha() const {
+    return this->alpha_;
+}
+
+template <size_t T_width>
+uint64_t ExponentialStatistics<T_width>::rowsAdded() const {
+    return this->rowsAdded_;
+}
+
+template <size_t T_width>
+bool ExponentialStatistics<T_width>::isEmpty() const {
+    return this->rowsAdded_ == 0;
+}
@@ -0,0 +1,119 @@
+/* Header for OrderStatisticTree class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include <cstdint>
+
+/**
+ * A multiset of doubles with rank selection, holding at most T_capacity values, in
+ * fixed storage (no allocation after construction).
+ *
+ * Implemented as a treap (a binary search tree kept balanced in expectation by random
+ * heap priorities) whose nodes also count their subtree sizes. insert(), erase() and
+ * select() each take expected O(log n).
+ *
+ * Values are ordered as by <, except that NaN sorts after +inf and all NaNs are equal,
+ * so every value inserted can be found again by erase().
+ */
+template <size_t T_capacity>
+class OrderStatisticTree {
+public:
+    /**
+     * Constructor, initializes an empty tree.
+     */
+    OrderStatisticTree();
+
+    /**
+     * Adds a value. Asserts that the tree is not full.
+     *
+     * @param value  the value to be added
+     */
+    void insert(double value);
+
+    /**
+     * Removes one occurrence of a value, if present.
+     *
+     * @param value  the value to be removed
+     * @return       true if a value was removed, otherwise false
+     */
+    bool erase(double value);
+
+    /**
+     * Returns the value of the given rank, 0 being the smallest.
+     * Asserts that rank < size().
+     *
+     * @param rank  the rank of the value to be returned
+     * @return      the rank-th smallest value
+     */
+    double select(size_t rank) const;
+
+    /**
+     * Returns the number of values in the tree.
+     *
+     * @return a size_t value of the number of values
+     */
+    size_t size() const;
+
+    /**
+     * Removes every value.
+     */
+    void clear();
+
+private:
+    /**
+     * Index standing for "no node".
+     */
+    static const uint32_t none = UINT32_MAX;
+
+    struct Node {
+        double value;
+        uint32_t priority;
+        uint32_t size;
+        uint32_t left;
+        uint32_t right;
+    };
+
+    /**
+     * Returns the size of the subtree rooted at node, 0 for none.
+     */
+    uint32_t sizeOf(uint32_t node) const;
+
+    /**
+     * Recomputes node's subtree size from its children.
+     */
+    void update(uint32_t node);
+
+    /**
+     * Splits the subtree at node into values less than value (left), and the rest (right).
+     * If orEqual, values equal to value go left instead.
+     */
+    void split(uint32_t node, double value, bool orEqual, uint32_t & left, uint32_t & right);
+
+    /**
+     * Joins two subtrees, every value in left being no greater than every value in right.
+     */
+    uint32_t merge(uint32_t left, uint32_t right);
+
+    /**
+     * Returns whether a sorts before b: as a < b, with NaN after everything else.
+     */
+    static bool less(double a, double b);
+
+    /**
+     * Returns the next pseudo-random priority (xorshift32).
+     */
+    uint32_t nextPriority();
+
+    std::array<Node, T_capacity> nodes_;
+    /**
+     * Head of the list of unused nodes, linked through their right index.
+     */
+    uint32_t free_;
+    uint32_t root_;
+    uint32_t random_;
+};
+
+#include "OrderStatisticTree_impl.h"
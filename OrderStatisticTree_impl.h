@@ -0,0 +1,127 @@
+#include "OrderStatisticTree.h"
+#include <cmath>
+
+template <size_t T_capacity>
+OrderStatisticTree<T_capacity>::OrderStatisticTree() : random_(2463534242u) {
+    this->clear();
+}
+
+template <size_t T_capacity>
+void OrderStatisticTree<T_capacity>::insert(double value) {
+    assert(this->free_ != none);
+    uint32_t node = this->free_;
+    this->free_ = this->nodes_[node].right;
+    this->nodes_[node].value = value;
+    this->nodes_[node].priority = this->nextPriority();
+    this->nodes_[node].size = 1;
+    this->nodes_[node].left = this->nodes_[node].right = none;
+
+    uint32_t less, rest;
+    this->split(this->root_, value, false, less, rest);
+    this->root_ = this->merge(this->merge(less, node), rest);
+}
+
+template <size_t T_capacity>
+bool OrderStatisticTree<T_capacity>::erase(double value) {
+    uint32_t less, rest, equal, greater;
+    this->split(this->root_, value, false, less, rest);
+    this->split(rest, value, true, equal, greater);
+
+    bool found = equal != none;
+    if (found) {
+        // Drop the root of the run of equal values
+        uint32_t node = equal;
+        equal = this->merge(this->nodes_[node].left, this->nodes_[node].right);
+        this->nodes_[node].right = this->free_;
+        this->free_ = node;
+    }
+    this->root_ = this->merge(less, this->merge(equal, greater));
+    return found;
+}
+
+template <size_t T_capacity>
+double OrderStatisticTree<T_capacity>::select(size_t rank) const {
+    assert(rank < this->size());
+    uint32_t node = this->root_;
+    while (true) {
+        uint32_t leftSize = this->sizeOf(this->nodes_[node].left);
+        if (rank < leftSize) {
+            node = this->nodes_[node].left;
+        } else if (rank == leftSize) {
+            return this->nodes_[node].value;
+        } else {
+            rank -= leftSize + 1;
+            node = this->nodes_[node].right;
+        }
+    }
+}
+
+template <size_t T_capacity>
+size_t OrderStatisticTree<T_capacity>::size() const {
+    return this->sizeOf(this->root_);
+}
+
+template <size_t T_capacity>
+void OrderStatisticTree<T_capacity>::clear() {
+    for (uint32_t i = 0; i < T_capacity; i++)
+        this->nodes_[i].right = i + 1 < T_capacity ? i + 1 : none;
+    this->free_ = T_capacity > 0 ? 0 : none;
+    this->root_ = none;
+}
+
+template <size_t T_capacity>
+uint32_t OrderStatisticTree<T_capacity>::sizeOf(uint32_t node) const {
+    return node == none ? 0 : this->nodes_[node].size;
+}
+
+template <size_t T_capacity>
+void OrderStatisticTree<T_capacity>::update(uint32_t node) {
+    this->nodes_[node].size = 1 + this->sizeOf(this->nodes_[node].left) + this->sizeOf(this->nodes_[node].right);
+}
+
+template <size_t T_capacity>
+void OrderStatisticTree<T_capacity>::split(uint32_t node, double value, bool orEqual, uint32_t &left, uint32_t &right) {
+    if (node == none) {
+        left = right = none;
+        return;
+    }
+    Node &n = this->nodes_[node];
+    bool goesLeft = orEqual ? !less(value, n.value) : less(n.value, value);
+    if (goesLeft) {
+        this->split(n.right, value, orEqual, n.right, right);
+        left = node;
+    } else {
+        this->split(n.left, value, orEqual, left, n.left);
+        right = node;
+    }
+    this->update(node);
+}
+
+template <size_t T_capacity>
+uint32_t OrderStatisticTree<T_capacity>::merge(uint32_t left, uint32_t right) {
+    if (left == none)
+        return right;
+    if (right == none)
+        return left;
+    if (this->nodes_[left].priority > this->nodes_[right].priority) {
+        this->nodes_[left].right = this->merge(this->nodes_[left].right, right);
+        this->update(left);
+        return left;
+    }
+    this->nodes_[right].left = this->merge(left, this->nodes_[right].left);
+    this->update(right);
+    return right;
+}
+
+template <size_t T_capacity>
+bool OrderStatisticTree<T_capacity>::less(double a, double b) {
+    return std::isnan(b) ? !std::isnan(a) : a < b;
+}
+
+template <size_t T_capacity>
+uint32_t OrderStatisticTree<T_capacity>::nextPriority() {
+    this->random_ ^= this->random_ << 13;
+    this->random_ ^= this->random_ >> 17;
+    this->random_ ^= this->random_ << 5;
+    return this->random_;
+}
@@ -0,0 +1,283 @@
+/* Header for PersistentStatisticsBuffer class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include <cstdint>
+#include <string>
+#include "DataContainer.h"
+#include "StatisticsSummary.h"
+
+/**
+ * A StatisticsBuffer whose rows and state (head and tail indices, row count and the K,
+ * Ex and Ex2 accumulators) live in a memory-mapped file, so a restarted process picks
+ * up the window where the last one left off instead of starting empty. Reattaching
+ * maps the file and checks its header, in O(1): no rows are read or replayed.
+ *
+ * The file starts with a versioned header recording the layout version, T_length,
+ * T_width and the element size; a file that does not match is rejected rather than
+ * misread. Each update first copies the state, and the row slot it will overwrite,
+ * into an undo journal in the file. If the process dies partway through the update,
+ * the next process to attach rolls it back, so the reloaded buffer is always exactly
+ * the one left by some whole number of updates. That covers the process being
+ * killed; against a power loss or kernel crash, only what was written before the last
+ * sync() is safe.
+ *
+ * The statistics are computed (and K re-centered) exactly as in StatisticsBuffer, so
+ * for the same rows both give identical results. Only one buffer may have a given
+ * file attached at a time, which an exclusive flock() on the file enforces.
+ *
+ * Example: PersistentStatisticsBuffer<100000, 4> statBuffer("/var/lib/app/window.stats");
+ */
+template <size_t T_length, size_t T_width>
+class PersistentStatisticsBuffer {
+public:
+    /**
+     * Constructor, attaches to the buffer stored in the file at path, creating an empty
+     * one if the file does not exist or is empty. Rolls back any update the previous
+     * process did not finish. Throws std::runtime_error if the file cannot be opened,
+     * locked or mapped, is attached by another buffer, or holds a buffer of a different
+     * version or shape or whose indices or journal are out of range.
+     *
+     * @param path  the file holding the buffer
+     */
+    explicit PersistentStatisticsBuffer(const std::string & path);
+
+    /**
+     * Destructor, unmaps the file. The buffer stays in the file.
+     */
+    ~PersistentStatisticsBuffer();
+
+    PersistentStatisticsBuffer(const PersistentStatisticsBuffer &) = delete;
+    PersistentStatisticsBuffer & operator = (const PersistentStatisticsBuffer &) = delete;
+
+    /**
+     * Returns true if the constructor found an existing buffer in the file, false if it
+     * started an empty one.
+     *
+     * @return boolean result of test
+     */
+    bool wasReattached() const;
+
+    /**
+     * Returns true if the constructor found an unfinished update in the file and rolled it back.
+     *
+     * @return boolean result of test
+     */
+    bool wasRecovered() const;
+
+    /**
+     * Adds a copy of the input row to the circular buffer, cycling out the oldest entry if necessary.
+     *
+     * @param data  the DataContainer instance to be added.
+     * @see StatisticsBuffer#addRow(const DataContainer<T_width> & data)
+     */
+    void addRow(const DataContainer<T_width> & data);
+
+    /**
+     * Adds a contiguous block of rows, oldest first. Each row is journaled as its own
+     * update, so a crash partway through keeps the rows added before it.
+     *
+     * @param rows     pointer to the first of the rows to be added
+     * @param numRows  the number of rows to be added
+     */
+    void addRows(const DataContainer<T_width> * rows, size_t numRows);
+
+    /**
+     * Removes the oldest row from the circular buffer. Simply calls removeRows(1);
+     */
+    void removeRow();
+
+    /**
+     * Removes the oldest numRowsToRemove rows from the circular buffer, as one update.
+     * If there are less rows than specified, it stops after removing what it can.
+     */
+    void removeRows(unsigned int numRowsToRemove);
+
+    /**
+     * Adds a copy of the input row. Simply calls the addRow() method.
+     *
+     * @param rhs  the DataContainer instance to be added
+     * @return     a reference to the current PersistentStatisticsBuffer
+     */
+    PersistentStatisticsBuffer & operator += (const DataContainer<T_width> & rhs);
+
+    /**
+     * Returns the row specified by the index, in chronological order from oldest to newest.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param index  the instance to be returned
+     * @return       a const reference to the row in the mapped file
+     */
+    const DataContainer<T_width> & getRow(unsigned int index) const;
+
+    /**
+     * Returns the row most recently added. Equivalent to getRow(currentLength() - 1).
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return       a const reference to the row in the mapped file
+     */
+    const DataContainer<T_width> & getLatestRow() const;
+
+    /**
+     * Returns the current mean of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the current standard deviation of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Returns a copy of the current statistics state (K, Ex, Ex2 and the number of rows).
+     *
+     * @return a new StatisticsSummary of the current rows
+     */
+    const StatisticsSummary<T_width> getSummary() const;
+
+    /**
+     * Moves the internal location parameter of each column to its current mean, as
+     * StatisticsBuffer::recenter() does. Called automatically once per T_length rows added.
+     */
+    void recenter();
+
+    /**
+     * Writes the mapped file back to disk and waits for it, so that the buffer as it is
+     * now survives a power loss or kernel crash, not just the process dying.
+     */
+    void sync();
+
+    /**
+     * Returns the maximum length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the maximum number of rows.
+     */
+    size_t maxLength() const;
+
+    /**
+     * Returns the current length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the current number of rows.
+     */
+    size_t currentLength() const;
+
+    /**
+     * Returns true if the buffer no longer contains any entries, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+    /**
+     * Returns true if the buffer is full, otherwise false.
+     * Note that this does NOT imply that entries cannot be added.
+     *
+     * @return boolean result of test
+     */
+    bool isFull() const;
+
+private:
+    /**
+     * The first bytes of the header, without a terminating NUL.
+     */
+    static constexpr char magic[9] = "STATSBUF";
+    /**
+     * The file layout's version, bumped when the layout changes.
+     */
+    static constexpr uint32_t layoutVersion = 1;
+
+    /**
+     * Everything about the buffer except its rows.
+     */
+    struct State {
+        /**
+         * Index of the slot holding the oldest row.
+         */
+        uint64_t headIndex;
+        /**
+         * Index of the slot holding the newest row, T_length - 1 when empty so addRow can pre-increment.
+         */
+        uint64_t tailIndex;
+        uint64_t numRows;
+        DataContainer<T_width> K;
+        DataContainer<T_width> Ex;
+        DataContainer<T_width> Ex2;
+    };
+
+    /**
+     * Enough to undo the update in progress: the state before it, and the one row slot it overwrites.
+     */
+    struct Journal {
+        /**
+         * Nonzero while an update is in progress; the other fields are only valid then.
+         */
+        uint64_t active;
+        uint64_t slot;
+        State saved;
+        DataContainer<T_width> row;
+    };
+
+    /**
+     * Identifies the layout and shape of the buffer in the file. Written last when a
+     * file is created, so a file whose creation was interrupted has no valid magic.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t valueBytes;
+        uint64_t length;
+        uint64_t width;
+    };
+
+    /**
+     * The whole file.
+     */
+    struct File {
+        Header header;
+        State state;
+        Journal journal;
+        std::array<DataContainer<T_width>, T_length> rows;
+    };
+
+    /**
+     * Saves the state and the row in the given slot to the journal, then marks it active.
+     */
+    void beginUpdate(size_t slot);
+
+    /**
+     * Marks the journal inactive once the update is complete.
+     */
+    void commitUpdate();
+
+    /**
+     * Undoes an update left in progress by a previous process, if any.
+     */
+    void recover();
+
+    /**
+     * Returns whether a state's indices and row count are in range and agree with each other.
+     */
+    static bool isConsistent(const State & state);
+
+    /**
+     * Closes the file descriptor and unmaps the file, if mapped. Used by the destructor
+     * and when the constructor fails.
+     */
+    void release();
+
+    int fd_ = -1;
+    File * file_ = nullptr;
+    bool reattached_ = false;
+    bool recovered_ = false;
+};
+
+#include "PersistentStatisticsBuffer_impl.h"
@@ -0,0 +1,299 @@
+#include "PersistentStatisticsBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ColumnKernels.h"
+
+template <size_t T_length, size_t T_width>
+constexpr char PersistentStatisticsBuffer<T_length, T_width>::magic[9];
+
+template <size_t T_length, size_t T_width>
+constexpr uint32_t PersistentStatisticsBuffer<T_length, T_width>::layoutVersion;
+
+template <size_t T_length, size_t T_width>
+PersistentStatisticsBuffer<T_length, T_width>::PersistentStatisticsBuffer(const std::string &path) {
+    this->fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (this->fd_ < 0)
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    // Held until the file is closed, by the destructor or the process exiting or dying
+    if (flock(this->fd_, LOCK_EX | LOCK_NB) != 0) {
+        const int error = errno;
+        this->release();
+        throw std::runtime_error(error == EWOULDBLOCK ? path + " is attached by another buffer"
+                                                      : "cannot lock " + path + ": " + std::strerror(error));
+    }
+
+    struct stat status;
+    if (fstat(this->fd_, &status) != 0) {
+        this->release();
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+    }
+    const bool created = status.st_size == 0;
+    if (!created && static_cast<size_t>(status.st_size) != sizeof(File)) {
+        this->release();
+        throw std::runtime_error(path + " does not hold a buffer of this length and width");
+    }
+    if (created && ftruncate(this->fd_, sizeof(File)) != 0) {
+        this->release();
+        throw std::runtime_error("cannot size " + path + ": " + std::strerror(errno));
+    }
+
+    void *mapping = mmap(nullptr, sizeof(File), PROT_READ | PROT_WRITE, MAP_SHARED, this->fd_, 0);
+    if (mapping == MAP_FAILED) {
+        this->release();
+        throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+    }
+    this->file_ = static_cast<File *>(mapping);
+
+    Header &header = this->file_->header;
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) == 0) {
+        if (header.version != layoutVersion || header.valueBytes != sizeof(double)
+                || header.length != T_length || header.width != T_width) {
+            this->release();
+            throw std::runtime_error(path + " holds a buffer of a different version or shape");
+        }
+        // Everything recovery and the indexing go on to trust, so a damaged file cannot
+        // send a write out of bounds. A state left mid-update is replaced by the saved one.
+        const Journal &journal = this->file_->journal;
+        const bool intact = journal.active == 0 ? isConsistent(this->file_->state)
+                            : journal.active == 1 && journal.slot < T_length && isConsistent(journal.saved);
+        if (!intact) {
+            this->release();
+            throw std::runtime_error(path + " holds a corrupt buffer");
+        }
+        this->reattached_ = true;
+        this->recover();
+        return;
+    }
+
+    // A new file, or one whose creation was interrupted before the magic was written
+    State &state = this->file_->state;
+    state.headIndex = 0;
+    state.tailIndex = T_length - 1;
+    state.numRows = 0;
+    state.K.fill(0);
+    state.Ex.fill(0);
+    state.Ex2.fill(0);
+    this->file_->journal.active = 0;
+    header.version = layoutVersion;
+    header.valueBytes = sizeof(double);
+    header.length = T_length;
+    header.width = T_width;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+}
+
+template <size_t T_length, size_t T_width>
+PersistentStatisticsBuffer<T_length, T_width>::~PersistentStatisticsBuffer() {
+    this->release();
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::release() {
+    if (this->file_ != nullptr)
+        munmap(this->file_, sizeof(File));
+    if (this->fd_ >= 0)
+        close(this->fd_);
+    this->file_ = nullptr;
+    this->fd_ = -1;
+}
+
+template <size_t T_length, size_t T_width>
+bool PersistentStatisticsBuffer<T_length, T_width>::wasReattached() const {
+    return this->reattached_;
+}
+
+template <size_t T_length, size_t T_width>
+bool PersistentStatisticsBuffer<T_length, T_width>::wasRecovered() const {
+    return this->recovered_;
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::beginUpdate(size_t slot) {
+    Journal &journal = this->file_->journal;
+    journal.slot = slot;
+    journal.saved = this->file_->state;
+    journal.row = this->file_->rows[slot];
+    // The process dying can only lose stores it has not made yet, so ordering the
+    // stores in the program is enough: the journal is complete before it is marked active,
+    // and the update is complete before it is marked inactive
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    journal.active = 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::commitUpdate() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    this->file_->journal.active = 0;
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::recover() {
+    Journal &journal = this->file_->journal;
+    if (!journal.active)
+        return;
+    // Rolling back is idempotent, so dying here just means the next process does it again
+    this->file_->rows[journal.slot] = journal.row;
+    this->file_->state = journal.saved;
+    this->commitUpdate();
+    this->recovered_ = true;
+}
+
+template <size_t T_length, size_t T_width>
+bool PersistentStatisticsBuffer<T_length, T_width>::isConsistent(const State &state) {
+    // The tail is the last of numRows slots from the head, or the one before the head when empty
+    return state.headIndex < T_length && state.tailIndex < T_length && state.numRows <= T_length
+           && (state.headIndex + state.numRows + T_length - 1) % T_length == state.tailIndex;
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::addRow(const DataContainer<T_width> &data) {
+    State &state = this->file_->state;
+    const size_t tail = (state.tailIndex + 1) % T_length;
+    DataContainer<T_width> &slot = this->file_->rows[tail];
+    this->beginUpdate(tail);
+
+    if (state.numRows == 0) {
+        // K must be initialized to a value within the sample range.
+        // Close to mean is preferable, but not required.
+        state.K = data;
+    }
+    state.tailIndex = tail;
+
+    if (state.numRows < T_length) {
+        state.numRows++;
+        ColumnKernels::addShifted(state.Ex.data(), state.Ex2.data(), data.data(), state.K.data(), T_width);
+    } else {
+        // the tail slot holds the current head, which is replaced in the same pass
+        ColumnKernels::replaceShifted(state.Ex.data(), state.Ex2.data(), slot.data(), data.data(),
+                                      state.K.data(), T_width);
+        state.headIndex = (state.headIndex + 1) % T_length;
+    }
+    slot = data;
+
+    if (tail == T_length - 1)
+        ColumnKernels::recenter(state.K.data(), state.Ex.data(), state.Ex2.data(), state.numRows, T_width);
+
+    this->commitUpdate();
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::addRows(const DataContainer<T_width> *rows, size_t numRows) {
+    for (size_t r = 0; r < numRows; r++)
+        this->addRow(rows[r]);
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::removeRow() {
+    this->removeRows(1);
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::removeRows(unsigned int numRowsToRemove) {
+    assert(!this->isEmpty());
+    State &state = this->file_->state;
+    // No row is overwritten; the journal's row slot is just restored to what it already holds
+    this->beginUpdate(state.headIndex);
+
+    const size_t numRemoved = std::min<size_t>(numRowsToRemove, state.numRows);
+    const size_t firstLength = std::min<size_t>(numRemoved, T_length - state.headIndex);
+    ColumnKernels::removeShiftedRows(state.Ex.data(), state.Ex2.data(), this->file_->rows[state.headIndex].data(),
+                                     firstLength, state.K.data(), T_width);
+    ColumnKernels::removeShiftedRows(state.Ex.data(), state.Ex2.data(), this->file_->rows[0].data(),
+                                     numRemoved - firstLength, state.K.data(), T_width);
+    state.numRows -= numRemoved;
+    state.headIndex = (state.headIndex + numRemoved) % T_length;
+
+    this->commitUpdate();
+}
+
+template <size_t T_length, size_t T_width>
+PersistentStatisticsBuffer<T_length, T_width> &
+PersistentStatisticsBuffer<T_length, T_width>::operator+=(const DataContainer<T_width> &data) {
+    this->addRow(data);
+    return *this;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> & PersistentStatisticsBuffer<T_length, T_width>::getRow(unsigned int index) const {
+    assert(!this->isEmpty());
+    return this->file_->rows[(this->file_->state.headIndex + index) % T_length];
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> & PersistentStatisticsBuffer<T_length, T_width>::getLatestRow() const {
+    assert(!this->isEmpty());
+    return this->file_->rows[this->file_->state.tailIndex];
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> PersistentStatisticsBuffer<T_length, T_width>::getMean() const {
+    assert(!this->isEmpty());
+    const State &state = this->file_->state;
+    DataContainer<T_width> mean;
+    ColumnKernels::mean(mean.data(), state.K.data(), state.Ex.data(), state.numRows, T_width);
+    return mean;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> PersistentStatisticsBuffer<T_length, T_width>::getStdDev() const {
+    assert(!this->isEmpty());
+    const State &state = this->file_->state;
+    DataContainer<T_width> stdDev;
+    ColumnKernels::stdDev(stdDev.data(), state.Ex.data(), state.Ex2.data(), state.numRows, T_width);
+    return stdDev;
+}
+
+template <size_t T_length, size_t T_width>
+const StatisticsSummary<T_width> PersistentStatisticsBuffer<T_length, T_width>::getSummary() const {
+    const State &state = this->file_->state;
+    StatisticsSummary<T_width> summary;
+    summary.K = state.K;
+    summary.Ex = state.Ex;
+    summary.Ex2 = state.Ex2;
+    summary.numRows = state.numRows;
+    return summary;
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::recenter() {
+    State &state = this->file_->state;
+    if (state.numRows == 0)
+        return;
+    this->beginUpdate(state.headIndex);
+    ColumnKernels::recenter(state.K.data(), state.Ex.data(), state.Ex2.data(), state.numRows, T_width);
+    this->commitUpdate();
+}
+
+template <size_t T_length, size_t T_width>
+void PersistentStatisticsBuffer<T_length, T_width>::sync() {
+    msync(this->file_, sizeof(File), MS_SYNC);
+}
+
+template <size_t T_length, size_t T_width>
+size_t PersistentStatisticsBuffer<T_length, T_width>::maxLength() const {
+    return T_length;
+}
+
+template <size_t T_length, size_t T_width>
+size_t PersistentStatisticsBuffer<T_length, T_width>::currentLength() const {
+    return this->file_->state.numRows;
+}
+
+template <size_t T_length, size_t T_width>
+bool PersistentStatisticsBuffer<T_length, T_width>::isEmpty() const {
+    return this->file_->state.numRows == 0;
+}
+
+template <size_t T_length, size_t T_width>
+bool PersistentStatisticsBuffer<T_length, T_width>::isFull() const {
+    return this->file_->state.numRows == T_length;
+}
@@ -0,0 +1,47 @@
+/* Header for appendToRing, the walk of a block of rows into a circular buffer shared
+ * by the buffers' addRows().
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Walks a block of numRows new rows (at most length) into a ring of length slots, starting at
+ * slot start and wrapping around the end of the ring at most once. The ring holds
+ * length - numFree rows beforehand; the first numFree new rows land in empty slots, and each
+ * one after that evicts the row already in its slot.
+ *
+ * Each of the (at most two) contiguous segments is walked sweep rows at a time. For each
+ * sweep, with first the index in the block of its first row and slot where that row goes:
+ *   add(first, slot, count)      adds the rows landing in empty slots to the sums,
+ *   replace(first, slot, count)  swaps the rows they evict for the rows evicting them,
+ *   store(first, slot, count)    then copies the sweep's rows into their slots.
+ * Once the last slot before the wrap point is filled, recenter(numRows) is called with the
+ * number of rows then in the ring, at the same point addRow() would re-center.
+ */
+template <class T_add, class T_replace, class T_store, class T_recenter>
+void appendToRing(size_t length, size_t start, size_t numFree, size_t numRows, size_t sweep,
+                  T_add add, T_replace replace, T_store store, T_recenter recenter) {
+    const size_t firstLength = std::min(numRows, length - start);
+    const size_t segmentStart[2] = {start, 0};
+    const size_t segmentLength[2] = {firstLength, numRows - firstLength};
+
+    size_t row = 0;
+    for (unsigned int segment = 0; segment < 2; segment++) {
+        const size_t segmentRows = segmentLength[segment];
+        for (size_t done = 0; done < segmentRows; done += sweep) {
+            const size_t count = std::min(sweep, segmentRows - done);
+            const size_t first = row + done;
+            const size_t slot = segmentStart[segment] + done;
+            const size_t numAdded = first < numFree ? std::min(count, numFree - first) : 0;
+            if (numAdded > 0)
+                add(first, slot, numAdded);
+            if (numAdded < count)
+                replace(first + numAdded, slot + numAdded, count - numAdded);
+            store(first, slot, count);
+        }
+        row += segmentRows;
+        if (segmentRows > 0 && segmentStart[segment] + segmentRows == length)
+            recenter(std::min(length - numFree + row, length));
+    }
+}
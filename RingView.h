@@ -0,0 +1,129 @@
+/* Header for RingView, a non-owning chronological view into a circular buffer.
+ */
+#pragma once
+#include <assert.h>
+#include <cstddef>
+#include <iterator>
+
+/**
+ * The contents of a circular buffer in chronological order (oldest first), as at
+ * most two contiguous spans: from the oldest entry up to the end of the storage,
+ * then from the start of the storage up to the newest entry. Either span may be
+ * empty. No data is copied; the view is invalidated when the buffer is modified.
+ *
+ * Since each span is contiguous, it can be handed straight to memcpy() or writev()
+ * as firstSize * sizeof(T) and secondSize * sizeof(T) bytes. The view can also be
+ * walked with random-access iterators, oldest first.
+ *
+ * Example: process(view.first, view.firstSize); process(view.second, view.secondSize);
+ *          for (const T & entry: view) process(entry);
+ */
+template <class T>
+struct RingView {
+    /**
+     * The older span, or nullptr if empty.
+     */
+    const T *first;
+    /**
+     * Number of entries in the older span.
+     */
+    size_t firstSize;
+    /**
+     * The newer span, or nullptr if empty.
+     */
+    const T *second;
+    /**
+     * Number of entries in the newer span.
+     */
+    size_t secondSize;
+
+    /**
+     * Returns the total number of entries in the view.
+     *
+     * @return firstSize + secondSize
+     */
+    size_t size() const {
+        return this->firstSize + this->secondSize;
+    }
+
+    /**
+     * Returns the entry at the given chronological index, 0 being the oldest.
+     *
+     * @param index  the entry to be returned, less than size()
+     * @return       a reference to the entry
+     */
+    const T & operator [] (size_t index) const {
+        assert(index < this->size());
+        return index < this->firstSize ? this->first[index] : this->second[index - this->firstSize];
+    }
+
+    /**
+     * A random-access iterator over a RingView, in chronological order. Holds a copy of the
+     * spans, so it stays valid after the view it came from goes away, until the buffer is modified.
+     */
+    class const_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T * pointer;
+        typedef const T & reference;
+
+        const_iterator() : first_(nullptr), firstSize_(0), second_(nullptr), index_(0) {}
+        const_iterator(const RingView & view, size_t index)
+                : first_(view.first), firstSize_(view.firstSize), second_(view.second), index_(index) {}
+
+        reference operator * () const {
+            return this->index_ < this->firstSize_ ? this->first_[this->index_] : this->second_[this->index_ - this->firstSize_];
+        }
+        pointer operator -> () const { return &**this; }
+        reference operator [] (difference_type n) const { return *(*this + n); }
+
+        const_iterator & operator ++ () { ++this->index_; return *this; }
+        const_iterator & operator -- () { --this->index_; return *this; }
+        const_iterator operator ++ (int) { const_iterator old = *this; ++this->index_; return old; }
+        const_iterator operator -- (int) { const_iterator old = *this; --this->index_; return old; }
+        const_iterator & operator += (difference_type n) { this->index_ += n; return *this; }
+        const_iterator & operator -= (difference_type n) { this->index_ -= n; return *this; }
+        const_iterator operator + (difference_type n) const { return const_iterator(*this) += n; }
+        const_iterator operator - (difference_type n) const { return const_iterator(*this) -= n; }
+        friend const_iterator operator + (difference_type n, const const_iterator & it) { return it + n; }
+        difference_type operator - (const const_iterator & rhs) const {
+            return static_cast<difference_type>(this->index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        bool operator == (const const_iterator & rhs) const { return this->index_ == rhs.index_; }
+        bool operator != (const const_iterator & rhs) const { return this->index_ != rhs.index_; }
+        bool operator < (const const_iterator & rhs) const { return this->index_ < rhs.index_; }
+        bool operator > (const const_iterator & rhs) const { return this->index_ > rhs.index_; }
+        bool operator <= (const const_iterator & rhs) const { return this->index_ <= rhs.index_; }
+        bool operator >= (const const_iterator & rhs) const { return this->index_ >= rhs.index_; }
+
+    private:
+        const T *first_;
+        size_t firstSize_;
+        const T *second_;
+        /**
+         * Chronological index of the entry, 0 being the oldest.
+         */
+        size_t index_;
+    };
+
+    /**
+     * Returns an iterator to the oldest entry.
+     *
+     * @return the iterator
+     */
+    const_iterator begin() const {
+        return const_iterator(*this, 0);
+    }
+
+    /**
+     * Returns an iterator one past the newest entry.
+     *
+     * @return the iterator
+     */
+    const_iterator end() const {
+        return const_iterator(*this, this->size());
+    }
+};
@@ -0,0 +1,134 @@
+/* Header for RowLoader class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "DataContainer.h"
+
+/**
+ * Replays a file of rows into a StatisticsBuffer (or anything else taking blocks of
+ * rows), for backtesting on captures too large to read into memory first.
+ *
+ * The file is memory-mapped and read in one of two formats:
+ *   Csv     one row per line, T_width numbers separated by commas (spaces and tabs
+ *           around them are ignored, as are blank lines and "\r\n" line endings).
+ *           Numbers are parsed with strtod, so anything it reads (in the C locale) is accepted.
+ *   Binary  rows packed back to back as T_width native doubles each, with no header:
+ *           the layout of an array of DataContainer<T_width>, as written by
+ *           writing out a StatisticsBuffer's view() spans.
+ *
+ * CSV is parsed in chunks of about a megabyte (split at line boundaries) by several
+ * parser threads, while the calling thread ingests the parsed chunks in file order,
+ * so parsing and ingest overlap. Binary rows need no parsing and are handed over
+ * straight from the mapping, without copying.
+ *
+ * A malformed file (a CSV line without exactly T_width numbers, or a binary file that
+ * is not a whole number of rows) throws std::runtime_error, after the rows before the
+ * faulty chunk have been ingested.
+ *
+ * Example: RowLoader<4> loader("capture.csv", RowLoader<4>::Csv, 1); loader.loadInto(statBuffer);
+ */
+template <size_t T_width>
+class RowLoader {
+public:
+    /**
+     * The file formats that can be read.
+     */
+    enum Format { Csv, Binary };
+
+    /**
+     * Constructor, maps the file. Throws std::runtime_error if it cannot be opened or mapped.
+     *
+     * @param path         the file to be read
+     * @param format       the format of the file
+     * @param headerLines  number of lines to skip at the start of a CSV file
+     * @param numThreads   number of CSV parser threads, or 0 for one less than the number of cores
+     */
+    RowLoader(const std::string & path, Format format, size_t headerLines = 0, unsigned int numThreads = 0);
+
+    /**
+     * Destructor, unmaps the file.
+     */
+    ~RowLoader();
+
+    RowLoader(const RowLoader &) = delete;
+    RowLoader & operator = (const RowLoader &) = delete;
+
+    /**
+     * Reads every row of the file, passing them in order to sink(const DataContainer<T_width> * rows,
+     * size_t numRows) in blocks, on the calling thread. The rows are only valid during the call.
+     *
+     * @param sink  the function or function object receiving the blocks of rows
+     * @return      the number of rows read
+     */
+    template <class T_sink>
+    size_t forEachBlock(T_sink sink);
+
+    /**
+     * Reads every row of the file into buffer through its addRows() method.
+     *
+     * Example: loader.loadInto(statBuffer);
+     *
+     * @param buffer  a StatisticsBuffer, StatisticsPyramid or other class with addRows()
+     * @return        the number of rows read
+     */
+    template <class T_buffer>
+    size_t loadInto(T_buffer & buffer);
+
+    /**
+     * Returns the size of the file in bytes.
+     *
+     * @return a size_t value of the file size
+     */
+    size_t fileBytes() const;
+
+private:
+    /**
+     * Reads a binary file, a block of rows at a time straight from the mapping.
+     */
+    template <class T_sink>
+    size_t forEachBinaryBlock(T_sink sink);
+
+    /**
+     * Reads a CSV file, chunks parsed on the parser threads and passed to the sink in order.
+     */
+    template <class T_sink>
+    size_t forEachCsvBlock(T_sink sink);
+
+    /**
+     * Appends the rows of the CSV lines starting in [begin, end) of the data to rows.
+     */
+    void parseCsvChunk(size_t begin, size_t end, std::vector<DataContainer<T_width> > & rows) const;
+
+    /**
+     * Parses one line, without its newline. Returns false for a blank line.
+     * Throws std::runtime_error, naming the offset, if it does not hold T_width numbers.
+     */
+    bool parseCsvLine(const char * line, const char * lineEnd, size_t offset, DataContainer<T_width> & row) const;
+
+    /**
+     * Returns the offset just past the first newline at or after offset, or the end of the data.
+     */
+    size_t nextLine(size_t offset) const;
+
+    std::string path_;
+    Format format_;
+    unsigned int numThreads_;
+    const char * data_ = nullptr;
+    size_t bytes_ = 0;
+    /**
+     * Offset of the first row, after any header lines.
+     */
+    size_t dataStart_ = 0;
+    /**
+     * Offset just past the last newline. A final line without a newline is parsed from
+     * the copy in tail_ instead, since strtod could otherwise read past the mapping.
+     */
+    size_t safeEnd_ = 0;
+    std::string tail_;
+};
+
+#include "RowLoader_impl.h"
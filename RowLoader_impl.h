@@ -0,0 +1,265 @@
+#include "RowLoader.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ROW_LOADER_CHUNK_BYTES (1024 * 1024)
+// Parsed chunks each parser thread may have waiting for the ingesting thread
+#define ROW_LOADER_QUEUE_DEPTH 2
+
+template <size_t T_width>
+RowLoader<T_width>::RowLoader(const std::string &path, Format format, size_t headerLines, unsigned int numThreads)
+        : path_(path), format_(format), numThreads_(numThreads) {
+    if (this->numThreads_ == 0) {
+        // hardware_concurrency() may return 0 when it cannot tell
+        const unsigned int numCores = std::thread::hardware_concurrency();
+        this->numThreads_ = numCores > 1 ? numCores - 1 : 1;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+    }
+    this->bytes_ = status.st_size;
+    if (this->bytes_ > 0) {
+        void *mapping = mmap(nullptr, this->bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+        }
+        // Read once front to back, so ask for aggressive read-ahead
+        madvise(mapping, this->bytes_, MADV_SEQUENTIAL);
+        this->data_ = static_cast<const char *>(mapping);
+    }
+    close(fd);
+
+    if (format == Csv) {
+        for (size_t line = 0; line < headerLines; line++)
+            this->dataStart_ = this->nextLine(this->dataStart_);
+        const char *lastNewline = this->bytes_ > 0
+                ? static_cast<const char *>(memrchr(this->data_, '\n', this->bytes_)) : nullptr;
+        this->safeEnd_ = lastNewline ? lastNewline - this->data_ + 1 : 0;
+        this->safeEnd_ = std::max(this->safeEnd_, this->dataStart_);
+        this->tail_.assign(this->data_ + this->safeEnd_, this->data_ + this->bytes_);
+    }
+}
+
+template <size_t T_width>
+RowLoader<T_width>::~RowLoader() {
+    if (this->data_ != nullptr)
+        munmap(const_cast<char *>(this->data_), this->bytes_);
+}
+
+template <size_t T_width>
+size_t RowLoader<T_width>::fileBytes() const {
+    return this->bytes_;
+}
+
+template <size_t T_width>
+template <class T_sink>
+size_t RowLoader<T_width>::forEachBlock(T_sink sink) {
+    if (this->format_ == Binary)
+        return this->forEachBinaryBlock(sink);
+    return this->forEachCsvBlock(sink);
+}
+
+template <size_t T_width>
+template <class T_buffer>
+size_t RowLoader<T_width>::loadInto(T_buffer &buffer) {
+    return this->forEachBlock([&buffer](const DataContainer<T_width> *rows, size_t numRows) {
+        buffer.addRows(rows, numRows);
+    });
+}
+
+template <size_t T_width>
+template <class T_sink>
+size_t RowLoader<T_width>::forEachBinaryBlock(T_sink sink) {
+    const size_t rowBytes = sizeof(DataContainer<T_width>);
+    if (this->bytes_ % rowBytes != 0)
+        throw std::runtime_error(this->path_ + " is not a whole number of rows of " + std::to_string(T_width) + " doubles");
+
+    // The mapping is page aligned, so the rows in it are as aligned as any DataContainer
+    const DataContainer<T_width> *rows = reinterpret_cast<const DataContainer<T_width> *>(this->data_);
+    const size_t numRows = this->bytes_ / rowBytes;
+    const size_t blockRows = std::max<size_t>(1, ROW_LOADER_CHUNK_BYTES / rowBytes);
+    for (size_t row = 0; row < numRows; row += blockRows)
+        sink(rows + row, std::min(blockRows, numRows - row));
+    return numRows;
+}
+
+template <size_t T_width>
+template <class T_sink>
+size_t RowLoader<T_width>::forEachCsvBlock(T_sink sink) {
+    const size_t numChunks = (this->bytes_ - this->dataStart_ + ROW_LOADER_CHUNK_BYTES - 1) / ROW_LOADER_CHUNK_BYTES;
+    const unsigned int numThreads = std::min<size_t>(this->numThreads_, numChunks);
+
+    struct Chunk {
+        std::vector<DataContainer<T_width> > rows;
+        std::exception_ptr error;
+    };
+    // Chunk k is parsed by thread k % numThreads and queued in that thread's lane, so taking
+    // chunks from the lanes in turn gives them back in file order
+    struct Lane {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Chunk> ready;
+    };
+    std::vector<std::unique_ptr<Lane> > lanes;
+    for (unsigned int t = 0; t < numThreads; t++)
+        lanes.push_back(std::unique_ptr<Lane>(new Lane()));
+    std::atomic<bool> stop(false);
+
+    // Chunk k holds the lines starting in its nominal byte range
+    auto chunkStart = [this](size_t chunk) {
+        if (chunk == 0)
+            return this->dataStart_;
+        return this->nextLine(this->dataStart_ + chunk * ROW_LOADER_CHUNK_BYTES - 1);
+    };
+
+    // However the ingest ends, even by a thread failing to start, the parser threads already
+    // running are told to stop and joined. Reserved up front, so adding a thread never
+    // reallocates (and so never throws with the new thread still unowned).
+    std::vector<std::thread> parsers;
+    parsers.reserve(numThreads);
+    struct Joiner {
+        std::vector<std::thread> &parsers;
+        std::vector<std::unique_ptr<Lane> > &lanes;
+        std::atomic<bool> &stop;
+        ~Joiner() {
+            stop.store(true);
+            for (auto &lane: lanes) {
+                std::lock_guard<std::mutex> lock(lane->mutex);
+                lane->changed.notify_all();
+            }
+            for (auto &parser: parsers) {
+                if (parser.joinable())
+                    parser.join();
+            }
+        }
+    } joiner = {parsers, lanes, stop};
+
+    for (unsigned int t = 0; t < numThreads; t++) {
+        parsers.emplace_back([&, t]() {
+            Lane &lane = *lanes[t];
+            for (size_t k = t; k < numChunks && !stop.load(); k += numThreads) {
+                Chunk chunk;
+                try {
+                    this->parseCsvChunk(chunkStart(k), k + 1 < numChunks ? chunkStart(k + 1) : this->bytes_,
+                                        chunk.rows);
+                } catch (...) {
+                    chunk.error = std::current_exception();
+                }
+                const bool failed = chunk.error != nullptr;
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                lane.changed.wait(lock, [&]() { return lane.ready.size() < ROW_LOADER_QUEUE_DEPTH || stop.load(); });
+                lane.ready.push_back(std::move(chunk));
+                lane.changed.notify_all();
+                if (failed)
+                    return;
+            }
+        });
+    }
+
+    size_t numRows = 0;
+    for (size_t k = 0; k < numChunks; k++) {
+        Lane &lane = *lanes[k % numThreads];
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            lane.changed.wait(lock, [&]() { return !lane.ready.empty(); });
+            chunk = std::move(lane.ready.front());
+            lane.ready.pop_front();
+            lane.changed.notify_all();
+        }
+        if (chunk.error != nullptr)
+            std::rethrow_exception(chunk.error);
+        if (!chunk.rows.empty())
+            sink(static_cast<const DataContainer<T_width> *>(chunk.rows.data()), chunk.rows.size());
+        numRows += chunk.rows.size();
+    }
+    return numRows;
+}
+
+template <size_t T_width>
+void RowLoader<T_width>::parseCsvChunk(size_t begin, size_t end, std::vector<DataContainer<T_width> > &rows) const {
+    // A rough guess at the number of rows, to save most of the regrowth
+    rows.reserve((end - begin) / (8 * T_width));
+    DataContainer<T_width> row;
+    size_t offset = begin;
+    while (offset < std::min(end, this->safeEnd_)) {
+        const size_t next = this->nextLine(offset);
+        if (this->parseCsvLine(this->data_ + offset, this->data_ + next - 1, offset, row))
+            rows.push_back(row);
+        offset = next;
+    }
+    if (!this->tail_.empty() && begin <= this->safeEnd_ && this->safeEnd_ < end) {
+        const char *tail = this->tail_.c_str();
+        if (this->parseCsvLine(tail, tail + this->tail_.size(), this->safeEnd_, row))
+            rows.push_back(row);
+    }
+}
+
+template <size_t T_width>
+bool RowLoader<T_width>::parseCsvLine(const char *line, const char *lineEnd, size_t offset,
+                                      DataContainer<T_width> &row) const {
+    if (lineEnd > line && lineEnd[-1] == '\r')
+        lineEnd--;
+    const char *p = line;
+    auto skipBlanks = [&p, lineEnd]() {
+        while (p < lineEnd && (*p == ' ' || *p == '\t'))
+            p++;
+    };
+    auto malformed = [&]() {
+        return std::runtime_error(this->path_ + ": expected " + std::to_string(T_width)
+                                  + " comma-separated numbers on the line at byte " + std::to_string(offset));
+    };
+
+    skipBlanks();
+    if (p == lineEnd)
+        return false;
+    for (size_t i = 0; i < T_width; i++) {
+        skipBlanks();
+        // strtod would skip a newline as leading whitespace and carry on into the next line
+        if (p == lineEnd || *p == ',' || *p == '\n' || *p == '\r')
+            throw malformed();
+        char *numberEnd;
+        row[i] = std::strtod(p, &numberEnd);
+        if (numberEnd == p || numberEnd > lineEnd)
+            throw malformed();
+        p = numberEnd;
+        skipBlanks();
+        if (i + 1 < T_width) {
+            if (p == lineEnd || *p != ',')
+                throw malformed();
+            p++;
+        }
+    }
+    if (p != lineEnd)
+        throw malformed();
+    return true;
+}
+
+template <size_t T_width>
+size_t RowLoader<T_width>::nextLine(size_t offset) const {
+    if (offset >= this->bytes_)
+        return this->bytes_;
+    const char *newline = static_cast<const char *>(std::memchr(this->data_ + offset, '\n', this->bytes_ - offset));
+    return newline ? newline - this->data_ + 1 : this->bytes_;
+}
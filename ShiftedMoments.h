@@ -0,0 +1,294 @@
+/* Header for ShiftedMoments class and the moment policies. Unfortunately, templated
+ * functions must be visible to the compiler, so implementations of the functions are
+ * included directly by this header.
+ */
+#pragma once
+#include <type_traits>
+#include "DataContainer.h"
+
+/**
+ * Base of the moment policies, the StatisticsBuffer trackers that choose how many
+ * shifted-data sums the buffer keeps rather than adding statistics of their own.
+ * T_order is the highest power of (x - K) summed: 1 keeps only Ex (the mean), 2 adds
+ * Ex2 (the standard deviation), 4 adds Ex3 and Ex4 (skewness and kurtosis). A buffer
+ * listing no policy keeps order 2; one listing several keeps the highest order asked
+ * for. The hooks do nothing, and the buffer skips them when no other trackers are listed.
+ */
+template <size_t T_width, unsigned int T_order>
+class MomentPolicy {
+public:
+    static const unsigned int momentOrder = T_order;
+
+protected:
+    void onAddRow(const DataContainer<T_width> &) {}
+    void onRemoveRow(const DataContainer<T_width> &) {}
+    void onClear() {}
+};
+
+/**
+ * Moment policy keeping only the mean: the buffer stores and updates K and Ex, not
+ * Ex2, so each row costs one subtraction and one addition per column. getStdDev()
+ * and getSummary() do not compile on such a buffer.
+ *
+ * Example: StatisticsBuffer<1024, 16, MeanOnly> statBuffer; statBuffer.getMean();
+ */
+template <size_t T_length, size_t T_width>
+class MeanOnly : public MomentPolicy<T_width, 1> {
+};
+
+/**
+ * Moment policy adding the third- and fourth-power sums, for getSkewness() and
+ * getKurtosis(). All four sums are updated in one fused pass per row. The higher sums
+ * amplify the rounding the incremental updates leave behind, so each row is also added
+ * to a second, fresh set of sums, which replaces the first at each re-centering once it
+ * covers the whole buffer. This costs one more update per row, with no pass over the
+ * rows, and means the mean and standard deviation agree with those of a plain buffer up
+ * to rounding rather than bit for bit.
+ *
+ * Example: StatisticsBuffer<1024, 16, HigherMoments> statBuffer; statBuffer.getKurtosis();
+ */
+template <size_t T_length, size_t T_width>
+class HigherMoments : public MomentPolicy<T_width, 4> {
+};
+
+/**
+ * The shifted-data sums of a StatisticsBuffer up to power T_order, and the kernels
+ * updating them. Only the specializations for the orders the moment policies ask
+ * for are defined; each holds exactly the sums of its order, so an unused sum takes
+ * neither storage nor instructions. The sums of a lower order are updated with the
+ * same operations as in a higher one, so until order 4 swaps in its fresh sums their
+ * common statistics agree bit for bit.
+ *
+ * Order 4 takes the rows summed to leave oldest first, as they do a StatisticsBuffer.
+ *
+ * Rows are passed as pointers to their T_width values, of any type ColumnKernels widens.
+ */
+template <size_t T_width, unsigned int T_order>
+class ShiftedMoments;
+
+template <size_t T_width>
+class ShiftedMoments<T_width, 1> {
+public:
+    /**
+     * Constructor, initializes K and the sums to zero.
+     */
+    ShiftedMoments();
+
+    /**
+     * Zeroes the sums, keeping K.
+     */
+    void clear();
+
+    template <class T_value>
+    void add(const T_value *row);
+
+    template <class T_value>
+    void remove(const T_value *row);
+
+    template <class T_value>
+    void replace(const T_value *oldRow, const T_value *newRow);
+
+    template <class T_value>
+    void addRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void removeRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows);
+
+    /**
+     * Moves K to the mean of the count rows summed, adjusting the sums to match.
+     */
+    void recenter(double count);
+
+    /**
+     * Writes the mean of each column of the count rows summed to mean.
+     */
+    void getMean(double *mean, double count) const;
+
+    /**
+     * Internal "location parameter", used to ensure subtractions are not too far from the mean.
+     */
+    DataContainer<T_width> K;
+    /**
+     * Sum of the differences between the datapoints and the location parameter
+     */
+    DataContainer<T_width> Ex;
+};
+
+template <size_t T_width>
+class ShiftedMoments<T_width, 2> {
+public:
+    ShiftedMoments();
+
+    void clear();
+
+    template <class T_value>
+    void add(const T_value *row);
+
+    template <class T_value>
+    void remove(const T_value *row);
+
+    template <class T_value>
+    void replace(const T_value *oldRow, const T_value *newRow);
+
+    template <class T_value>
+    void addRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void removeRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows);
+
+    void recenter(double count);
+
+    void getMean(double *mean, double count) const;
+
+    /**
+     * Writes the sample standard deviation of each column of the count rows summed to stdDev.
+     */
+    void getStdDev(double *stdDev, double count) const;
+
+    /**
+     * add() and replace(), first scoring the new row against the count rows summed, in the
+     * same pass: writes the deviation of each column from their mean and their sum of squared
+     * deviations, and returns the largest z-score excess, positive exactly when some column is
+     * over its threshold (see ColumnKernels::addShiftedScored).
+     */
+    template <class T_value>
+    double addScored(double *deviation, double *sumSquares, const T_value *row, const double *squaredThresholds,
+                     double count);
+
+    template <class T_value>
+    double replaceScored(double *deviation, double *sumSquares, const T_value *oldRow, const T_value *newRow,
+                         const double *squaredThresholds, double count);
+
+    DataContainer<T_width> K;
+    DataContainer<T_width> Ex;
+    /**
+     * Sum of the squares of the differences
+     */
+    DataContainer<T_width> Ex2;
+};
+
+template <size_t T_width>
+class ShiftedMoments<T_width, 4> {
+public:
+    ShiftedMoments();
+
+    void clear();
+
+    template <class T_value>
+    void add(const T_value *row);
+
+    template <class T_value>
+    void remove(const T_value *row);
+
+    template <class T_value>
+    void replace(const T_value *oldRow, const T_value *newRow);
+
+    template <class T_value>
+    void addRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void removeRows(const T_value *rows, size_t numRows);
+
+    template <class T_value>
+    void replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows);
+
+    void recenter(double count);
+
+    void getMean(double *mean, double count) const;
+
+    void getStdDev(double *stdDev, double count) const;
+
+    template <class T_value>
+    double addScored(double *deviation, double *sumSquares, const T_value *row, const double *squaredThresholds,
+                     double count);
+
+    template <class T_value>
+    double replaceScored(double *deviation, double *sumSquares, const T_value *oldRow, const T_value *newRow,
+                         const double *squaredThresholds, double count);
+
+    /**
+     * Writes the skewness of each column of the count rows summed to skewness.
+     */
+    void getSkewness(double *skewness, double count) const;
+
+    /**
+     * Writes the excess kurtosis of each column of the count rows summed to kurtosis.
+     */
+    void getKurtosis(double *kurtosis, double count) const;
+
+    DataContainer<T_width> K;
+    DataContainer<T_width> Ex;
+    DataContainer<T_width> Ex2;
+    /**
+     * Sums of the third and fourth powers of the differences
+     */
+    DataContainer<T_width> Ex3;
+    DataContainer<T_width> Ex4;
+
+private:
+    /**
+     * Sums over the newest numFresh_ of the numRows_ rows summed, all added since the last
+     * recenter(). They have been through one pass of updates at most, so recenter() takes
+     * them in place of Ex to Ex4 when they cover every row.
+     */
+    DataContainer<T_width> freshEx_;
+    DataContainer<T_width> freshEx2_;
+    DataContainer<T_width> freshEx3_;
+    DataContainer<T_width> freshEx4_;
+    size_t numRows_;
+    size_t numFresh_;
+};
+
+namespace ShiftedMomentsDetail {
+
+/**
+ * The momentOrder of a tracker if it is a moment policy, otherwise 0.
+ */
+template <size_t T_width, unsigned int T_order>
+std::integral_constant<unsigned int, T_order> policyOrder(const MomentPolicy<T_width, T_order> *);
+std::integral_constant<unsigned int, 0> policyOrder(...);
+
+template <class T_tracker>
+struct MomentOrderOf : decltype(policyOrder(static_cast<T_tracker *>(nullptr))) {
+};
+
+/**
+ * The order a buffer keeps given the MomentOrderOf of each of its trackers: the
+ * highest asked for, or 2 if none is.
+ */
+template <unsigned int... T_orders>
+struct MaxOrder : std::integral_constant<unsigned int, 0> {
+};
+
+template <unsigned int T_first, unsigned int... T_rest>
+struct MaxOrder<T_first, T_rest...>
+        : std::integral_constant<unsigned int, (T_first > MaxOrder<T_rest...>::value ? T_first
+                                                                                   : MaxOrder<T_rest...>::value)> {
+};
+
+template <unsigned int... T_orders>
+struct BufferOrder : std::integral_constant<unsigned int, MaxOrder<T_orders...>::value ? MaxOrder<T_orders...>::value : 2> {
+};
+
+/**
+ * The number of trackers needing their hooks called, given whether each does: all but
+ * the moment policies and other markers.
+ */
+template <bool... T_hooked>
+struct NumHooked : std::integral_constant<size_t, 0> {
+};
+
+template <bool T_first, bool... T_rest>
+struct NumHooked<T_first, T_rest...>
+        : std::integral_constant<size_t, (T_first ? 1 : 0) + NumHooked<T_rest...>::value> {
+};
+
+} // namespace ShiftedMomentsDetail
+
+#include "ShiftedMoments_impl.h"
@@ -0,0 +1,308 @@
+#include "ShiftedMoments.h"
+#include "ColumnKernels.h"
+#include <algorithm>
+
+template <size_t T_width>
+ShiftedMoments<T_width, 1>::ShiftedMoments() {
+    this->K.fill(0);
+    this->Ex.fill(0);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 1>::clear() {
+    this->Ex.fill(0);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::add(const T_value *row) {
+    ColumnKernels::addShiftedMean(this->Ex.data(), row, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::remove(const T_value *row) {
+    ColumnKernels::removeShiftedMean(this->Ex.data(), row, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::replace(const T_value *oldRow, const T_value *newRow) {
+    ColumnKernels::replaceShiftedMean(this->Ex.data(), oldRow, newRow, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::addRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::addShiftedMeanRows(this->Ex.data(), rows, numRows, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::removeRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::removeShiftedMeanRows(this->Ex.data(), rows, numRows, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 1>::replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows) {
+    ColumnKernels::replaceShiftedMeanRows(this->Ex.data(), oldRows, newRows, numRows, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 1>::recenter(double count) {
+    ColumnKernels::recenterMean(this->K.data(), this->Ex.data(), count, T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 1>::getMean(double *mean, double count) const {
+    ColumnKernels::mean(mean, this->K.data(), this->Ex.data(), count, T_width);
+}
+
+template <size_t T_width>
+ShiftedMoments<T_width, 2>::ShiftedMoments() {
+    this->K.fill(0);
+    this->Ex.fill(0);
+    this->Ex2.fill(0);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 2>::clear() {
+    this->Ex.fill(0);
+    this->Ex2.fill(0);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::add(const T_value *row) {
+    ColumnKernels::addShifted(this->Ex.data(), this->Ex2.data(), row, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::remove(const T_value *row) {
+    ColumnKernels::removeShifted(this->Ex.data(), this->Ex2.data(), row, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::replace(const T_value *oldRow, const T_value *newRow) {
+    ColumnKernels::replaceShifted(this->Ex.data(), this->Ex2.data(), oldRow, newRow, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::addRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::addShiftedRows(this->Ex.data(), this->Ex2.data(), rows, numRows, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::removeRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::removeShiftedRows(this->Ex.data(), this->Ex2.data(), rows, numRows, this->K.data(), T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 2>::replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows) {
+    ColumnKernels::replaceShiftedRows(this->Ex.data(), this->Ex2.data(), oldRows, newRows, numRows,
+                                      this->K.data(), T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 2>::recenter(double count) {
+    ColumnKernels::recenter(this->K.data(), this->Ex.data(), this->Ex2.data(), count, T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 2>::getMean(double *mean, double count) const {
+    ColumnKernels::mean(mean, this->K.data(), this->Ex.data(), count, T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 2>::getStdDev(double *stdDev, double count) const {
+    ColumnKernels::stdDev(stdDev, this->Ex.data(), this->Ex2.data(), count, T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+double ShiftedMoments<T_width, 2>::addScored(double *deviation, double *sumSquares, const T_value *row,
+                                             const double *squaredThresholds, double count) {
+    return ColumnKernels::addShiftedScored(this->Ex.data(), this->Ex2.data(), deviation, sumSquares, row,
+                                           this->K.data(), squaredThresholds, count, T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+double ShiftedMoments<T_width, 2>::replaceScored(double *deviation, double *sumSquares, const T_value *oldRow,
+                                                 const T_value *newRow, const double *squaredThresholds,
+                                                 double count) {
+    return ColumnKernels::replaceShiftedScored(this->Ex.data(), this->Ex2.data(), deviation, sumSquares, oldRow,
+                                               newRow, this->K.data(), squaredThresholds, count, T_width);
+}
+
+template <size_t T_width>
+ShiftedMoments<T_width, 4>::ShiftedMoments() {
+    this->K.fill(0);
+    this->clear();
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::clear() {
+    this->Ex.fill(0);
+    this->Ex2.fill(0);
+    this->Ex3.fill(0);
+    this->Ex4.fill(0);
+    this->freshEx_.fill(0);
+    this->freshEx2_.fill(0);
+    this->freshEx3_.fill(0);
+    this->freshEx4_.fill(0);
+    this->numRows_ = 0;
+    this->numFresh_ = 0;
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::add(const T_value *row) {
+    ColumnKernels::addShifted4(this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(), row,
+                               this->K.data(), T_width);
+    ColumnKernels::addShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                               this->freshEx4_.data(), row, this->K.data(), T_width);
+    this->numRows_++;
+    this->numFresh_++;
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::remove(const T_value *row) {
+    this->removeRows(row, 1);
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::replace(const T_value *oldRow, const T_value *newRow) {
+    ColumnKernels::replaceShifted4(this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(), oldRow,
+                                   newRow, this->K.data(), T_width);
+    if (this->numFresh_ < this->numRows_) {
+        ColumnKernels::addShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                   this->freshEx4_.data(), newRow, this->K.data(), T_width);
+        this->numFresh_++;
+    } else {
+        ColumnKernels::replaceShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                       this->freshEx4_.data(), oldRow, newRow, this->K.data(), T_width);
+    }
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::addRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::addShifted4Rows(this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(), rows,
+                                   numRows, this->K.data(), T_width);
+    ColumnKernels::addShifted4Rows(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                   this->freshEx4_.data(), rows, numRows, this->K.data(), T_width);
+    this->numRows_ += numRows;
+    this->numFresh_ += numRows;
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::removeRows(const T_value *rows, size_t numRows) {
+    ColumnKernels::removeShifted4Rows(this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(), rows,
+                                      numRows, this->K.data(), T_width);
+    // Only the rows after the oldest numStale are in the fresh sums
+    const size_t numStale = this->numRows_ - this->numFresh_;
+    if (numRows > numStale) {
+        ColumnKernels::removeShifted4Rows(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                          this->freshEx4_.data(), rows + numStale * T_width, numRows - numStale,
+                                          this->K.data(), T_width);
+        this->numFresh_ -= numRows - numStale;
+    }
+    this->numRows_ -= numRows;
+}
+
+template <size_t T_width>
+template <class T_value>
+void ShiftedMoments<T_width, 4>::replaceRows(const T_value *oldRows, const T_value *newRows, size_t numRows) {
+    ColumnKernels::replaceShifted4Rows(this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(),
+                                       oldRows, newRows, numRows, this->K.data(), T_width);
+    // The first numStale rows replaced are not in the fresh sums, so their replacements are just added
+    const size_t numStale = std::min(numRows, this->numRows_ - this->numFresh_);
+    ColumnKernels::addShifted4Rows(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                   this->freshEx4_.data(), newRows, numStale, this->K.data(), T_width);
+    ColumnKernels::replaceShifted4Rows(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                       this->freshEx4_.data(), oldRows + numStale * T_width,
+                                       newRows + numStale * T_width, numRows - numStale, this->K.data(), T_width);
+    this->numFresh_ += numStale;
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::recenter(double count) {
+    if (this->numFresh_ == this->numRows_) {
+        this->Ex = this->freshEx_;
+        this->Ex2 = this->freshEx2_;
+        this->Ex3 = this->freshEx3_;
+        this->Ex4 = this->freshEx4_;
+    }
+    ColumnKernels::recenter4(this->K.data(), this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(),
+                             count, T_width);
+    this->freshEx_.fill(0);
+    this->freshEx2_.fill(0);
+    this->freshEx3_.fill(0);
+    this->freshEx4_.fill(0);
+    this->numFresh_ = 0;
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::getMean(double *mean, double count) const {
+    ColumnKernels::mean(mean, this->K.data(), this->Ex.data(), count, T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::getStdDev(double *stdDev, double count) const {
+    ColumnKernels::stdDev(stdDev, this->Ex.data(), this->Ex2.data(), count, T_width);
+}
+
+template <size_t T_width>
+template <class T_value>
+double ShiftedMoments<T_width, 4>::addScored(double *deviation, double *sumSquares, const T_value *row,
+                                             const double *squaredThresholds, double count) {
+    const double largest = ColumnKernels::addShifted4Scored(this->Ex.data(), this->Ex2.data(), this->Ex3.data(),
+                                                            this->Ex4.data(), deviation, sumSquares, row,
+                                                            this->K.data(), squaredThresholds, count, T_width);
+    ColumnKernels::addShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                               this->freshEx4_.data(), row, this->K.data(), T_width);
+    this->numRows_++;
+    this->numFresh_++;
+    return largest;
+}
+
+template <size_t T_width>
+template <class T_value>
+double ShiftedMoments<T_width, 4>::replaceScored(double *deviation, double *sumSquares, const T_value *oldRow,
+                                                 const T_value *newRow, const double *squaredThresholds,
+                                                 double count) {
+    const double largest = ColumnKernels::replaceShifted4Scored(this->Ex.data(), this->Ex2.data(), this->Ex3.data(),
+                                                                this->Ex4.data(), deviation, sumSquares, oldRow,
+                                                                newRow, this->K.data(), squaredThresholds, count,
+                                                                T_width);
+    if (this->numFresh_ < this->numRows_) {
+        ColumnKernels::addShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                   this->freshEx4_.data(), newRow, this->K.data(), T_width);
+        this->numFresh_++;
+    } else {
+        ColumnKernels::replaceShifted4(this->freshEx_.data(), this->freshEx2_.data(), this->freshEx3_.data(),
+                                       this->freshEx4_.data(), oldRow, newRow, this->K.data(), T_width);
+    }
+    return largest;
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::getSkewness(double *skewness, double count) const {
+    ColumnKernels::skewness(skewness, this->Ex.data(), this->Ex2.data(), this->Ex3.data(), count, T_width);
+}
+
+template <size_t T_width>
+void ShiftedMoments<T_width, 4>::getKurtosis(double *kurtosis, double count) const {
+    ColumnKernels::kurtosis(kurtosis, this->Ex.data(), this->Ex2.data(), this->Ex3.data(), this->Ex4.data(), count,
+                            T_width);
+}
@@ -0,0 +1,103 @@
+/* Header for SlidingCovariance class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include "ColumnKernels.h"
+#include "DataContainer.h"
+
+/**
+ * A StatisticsBuffer tracker keeping the covariance and correlation between every pair
+ * of columns over the rows currently in the buffer.
+ *
+ * Uses the same shifted-data algorithm as StatisticsBuffer, extended to co-moments: with
+ * d = row - K, each added row applies the rank-1 update C += d*d^T and each removed row
+ * C -= d*d^T, so ingest costs O(T_width^2) and a query O(T_width^2), however long the
+ * buffer. Only the upper triangle of C is updated, one contiguous row segment at a time
+ * on ColumnKernels. Like the buffer, K is moved to the current mean once per T_length
+ * rows added.
+ *
+ * The matrices are returned as T_width DataContainer rows, so element (i, j) is
+ * matrix[i][j]. Holds T_width^2 doubles, so prefer heap allocation for wide rows.
+ *
+ * Example: StatisticsBuffer<100, 4, SlidingCovariance> statBuffer; statBuffer.getCorrelation();
+ */
+template <size_t T_length, size_t T_width>
+class SlidingCovariance {
+public:
+    /**
+     * A T_width x T_width matrix, as rows.
+     */
+    typedef std::array<DataContainer<T_width>, T_width> Matrix;
+
+    /**
+     * Constructor, initializes empty accumulators.
+     */
+    SlidingCovariance();
+
+    /**
+     * Returns the sample covariance between each pair of columns. The diagonal holds each
+     * column's variance. Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new matrix of covariances
+     */
+    const Matrix getCovariance() const;
+
+    /**
+     * Returns the Pearson correlation between each pair of columns. A constant column has
+     * no defined correlation, so its row and column come out as NaN.
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new matrix of correlations
+     */
+    const Matrix getCorrelation() const;
+
+protected:
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row added.
+     */
+    void onAddRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row removed.
+     */
+    void onRemoveRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer when all rows are dropped at once.
+     */
+    void onClear();
+
+private:
+    /**
+     * Applies C += scale * d*d^T to the upper triangle, with d = row - K_, and Ex_ += scale * d.
+     */
+    void update(const DataContainer<T_width> & row, double scale);
+
+    /**
+     * Moves K_ to the current mean, adjusting Ex_ and the co-moments to match.
+     */
+    void recenter();
+
+    /**
+     * Location parameter of each column, independent of the buffer's own.
+     */
+    DataContainer<T_width> K_;
+    /**
+     * Sum of (x - K) for each column.
+     */
+    DataContainer<T_width> Ex_;
+    /**
+     * Co-moments: comoments_[i][j] is the sum of (x_i - K_i)*(x_j - K_j), for j >= i.
+     */
+    Matrix comoments_;
+    unsigned int numRows_;
+    /**
+     * Rows added since K_ was last moved.
+     */
+    unsigned int numAddedSinceRecenter_;
+};
+
+#include "SlidingCovariance_impl.h"
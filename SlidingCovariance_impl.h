@@ -0,0 +1,95 @@
+#include "SlidingCovariance.h"
+#include <cmath>
+
+template <size_t T_length, size_t T_width>
+SlidingCovariance<T_length, T_width>::SlidingCovariance() {
+    this->K_.fill(0);
+    this->onClear();
+}
+
+template <size_t T_length, size_t T_width>
+const typename SlidingCovariance<T_length, T_width>::Matrix SlidingCovariance<T_length, T_width>::getCovariance() const {
+    assert(this->numRows_ != 0);
+    const double count = this->numRows_;
+    Matrix covariance;
+    for (unsigned int i = 0; i < T_width; i++) {
+        for (unsigned int j = i; j < T_width; j++) {
+            covariance[i][j] = (this->comoments_[i][j] - (this->Ex_[i]*this->Ex_[j]) / count) / (count - 1);
+            covariance[j][i] = covariance[i][j];
+        }
+    }
+    return covariance;
+}
+
+template <size_t T_length, size_t T_width>
+const typename SlidingCovariance<T_length, T_width>::Matrix SlidingCovariance<T_length, T_width>::getCorrelation() const {
+    Matrix correlation = this->getCovariance();
+    DataContainer<T_width> stdDev;
+    for (unsigned int i = 0; i < T_width; i++)
+        stdDev[i] = std::sqrt(correlation[i][i]);
+    for (unsigned int i = 0; i < T_width; i++) {
+        for (unsigned int j = 0; j < T_width; j++)
+            correlation[i][j] /= stdDev[i] * stdDev[j];
+    }
+    return correlation;
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingCovariance<T_length, T_width>::onAddRow(const DataContainer<T_width> &row) {
+    if (this->numRows_ == 0)
+        this->K_ = row;
+    this->update(row, 1.0);
+    this->numRows_++;
+    if (++this->numAddedSinceRecenter_ == T_length)
+        this->recenter();
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingCovariance<T_length, T_width>::onRemoveRow(const DataContainer<T_width> &row) {
+    this->update(row, -1.0);
+    if (--this->numRows_ == 0) {
+        // Drop the rounding left over from the removed rows; the next row picks a new K
+        this->onClear();
+    }
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingCovariance<T_length, T_width>::onClear() {
+    this->Ex_.fill(0);
+    for (auto &comomentRow: this->comoments_)
+        comomentRow.fill(0);
+    this->numRows_ = 0;
+    this->numAddedSinceRecenter_ = 0;
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingCovariance<T_length, T_width>::update(const DataContainer<T_width> &row, double scale) {
+    DataContainer<T_width> diff = row;
+    ColumnKernels::subtract(diff.data(), this->K_.data(), T_width);
+    ColumnKernels::addScaled(this->Ex_.data(), diff.data(), scale, T_width);
+    // Row i of the upper triangle gains scale * d_i * d[i..]
+    for (unsigned int i = 0; i < T_width; i++)
+        ColumnKernels::addScaled(this->comoments_[i].data() + i, diff.data() + i, scale * diff[i], T_width - i);
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingCovariance<T_length, T_width>::recenter() {
+    this->numAddedSinceRecenter_ = 0;
+    if (this->numRows_ == 0)
+        return;
+
+    // With shift s = K' - K: C'_ij = C_ij - s_i*Ex_j + (count*s_i - Ex_i)*s_j, and Ex' = Ex - count*s
+    const double count = this->numRows_;
+    DataContainer<T_width> shift;
+    for (unsigned int i = 0; i < T_width; i++) {
+        double newK = this->K_[i] + this->Ex_[i] / count;
+        shift[i] = newK - this->K_[i];
+        this->K_[i] = newK;
+    }
+    for (unsigned int i = 0; i < T_width; i++) {
+        ColumnKernels::addScaled(this->comoments_[i].data() + i, this->Ex_.data() + i, -shift[i], T_width - i);
+        ColumnKernels::addScaled(this->comoments_[i].data() + i, shift.data() + i,
+                                 count * shift[i] - this->Ex_[i], T_width - i);
+    }
+    ColumnKernels::addScaled(this->Ex_.data(), shift.data(), -count, T_width);
+}
@@ -0,0 +1,105 @@
+/* Header for SlidingExtrema class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include <cstdint>
+#include "DataContainer.h"
+
+/**
+ * A StatisticsBuffer tracker keeping the minimum and maximum of each column over the
+ * rows currently in the buffer.
+ *
+ * Each column has two monotonic queues: one of values in increasing order (its front
+ * is the minimum) and one in decreasing order (its front is the maximum). A new value
+ * drops every queued value it makes irrelevant from the back before being appended; an
+ * evicted row leaves the front if it is still there. Each value is appended and dropped
+ * at most once, so ingest is amortized O(T_width), and the extremes are the fronts.
+ *
+ * Example: StatisticsBuffer<100, 4, SlidingExtrema> statBuffer; statBuffer.getMin();
+ */
+template <size_t T_length, size_t T_width>
+class SlidingExtrema {
+public:
+    /**
+     * Constructor, initializes empty queues.
+     */
+    SlidingExtrema();
+
+    /**
+     * Returns the current minimum of each column as a DataContainer.
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the minimum of each column.
+     */
+    const DataContainer<T_width> getMin() const;
+
+    /**
+     * Returns the current maximum of each column as a DataContainer.
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the maximum of each column.
+     */
+    const DataContainer<T_width> getMax() const;
+
+protected:
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row added, after any row it evicts
+     * has been passed to onRemoveRow().
+     */
+    void onAddRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row removed, oldest first.
+     */
+    void onRemoveRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer when all rows are dropped at once.
+     */
+    void onClear();
+
+private:
+    /**
+     * One column's monotonic queue, a circular buffer of (value, sequence number) pairs
+     * stored as two arrays. It never holds more than T_length entries, since every entry is
+     * a row still in the buffer.
+     */
+    struct MonotonicQueue {
+        std::array<double, T_length> values;
+        std::array<uint32_t, T_length> sequences;
+        uint32_t head;
+        uint32_t size;
+    };
+
+    /**
+     * Appends (value, sequence) to the queue, first dropping from the back every entry for
+     * which keep(entry, value) is false.
+     */
+    template <class T_keep>
+    static void push(MonotonicQueue & queue, double value, uint32_t sequence, T_keep keep);
+
+    /**
+     * Drops the front of the queue if it is the row with the given sequence number.
+     */
+    static void pop(MonotonicQueue & queue, uint32_t sequence);
+
+    /**
+     * Per-column queues whose fronts are the minimum and maximum.
+     */
+    std::array<MonotonicQueue, T_width> minQueues_;
+    std::array<MonotonicQueue, T_width> maxQueues_;
+    /**
+     * Sequence number of the next row to be added. Only compared for equality among at most
+     * T_length live rows, so wrapping around is harmless.
+     */
+    uint32_t nextAdded_ = 0;
+    /**
+     * Sequence number of the next row to be removed, always the oldest.
+     */
+    uint32_t nextRemoved_ = 0;
+};
+
+#include "SlidingExtrema_impl.h"
@@ -0,0 +1,76 @@
+#include "SlidingExtrema.h"
+
+template <size_t T_length, size_t T_width>
+SlidingExtrema<T_length, T_width>::SlidingExtrema() {
+    this->onClear();
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> SlidingExtrema<T_length, T_width>::getMin() const {
+    DataContainer<T_width> min;
+    for (unsigned int i = 0; i < T_width; i++) {
+        const MonotonicQueue &queue = this->minQueues_[i];
+        assert(queue.size != 0);
+        min[i] = queue.values[queue.head];
+    }
+    return min;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> SlidingExtrema<T_length, T_width>::getMax() const {
+    DataContainer<T_width> max;
+    for (unsigned int i = 0; i < T_width; i++) {
+        const MonotonicQueue &queue = this->maxQueues_[i];
+        assert(queue.size != 0);
+        max[i] = queue.values[queue.head];
+    }
+    return max;
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingExtrema<T_length, T_width>::onAddRow(const DataContainer<T_width> &row) {
+    const uint32_t sequence = this->nextAdded_++;
+    for (unsigned int i = 0; i < T_width; i++) {
+        // A queued value can never be the minimum again once a smaller-or-equal, newer one arrives
+        push(this->minQueues_[i], row[i], sequence, [](double queued, double value) { return queued < value; });
+        push(this->maxQueues_[i], row[i], sequence, [](double queued, double value) { return queued > value; });
+    }
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingExtrema<T_length, T_width>::onRemoveRow(const DataContainer<T_width> &) {
+    const uint32_t sequence = this->nextRemoved_++;
+    for (unsigned int i = 0; i < T_width; i++) {
+        pop(this->minQueues_[i], sequence);
+        pop(this->maxQueues_[i], sequence);
+    }
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingExtrema<T_length, T_width>::onClear() {
+    for (unsigned int i = 0; i < T_width; i++) {
+        this->minQueues_[i].head = this->minQueues_[i].size = 0;
+        this->maxQueues_[i].head = this->maxQueues_[i].size = 0;
+    }
+    this->nextAdded_ = this->nextRemoved_ = 0;
+}
+
+template <size_t T_length, size_t T_width>
+template <class T_keep>
+void SlidingExtrema<T_length, T_width>::push(MonotonicQueue &queue, double value, uint32_t sequence, T_keep keep) {
+    while (queue.size != 0 && !keep(queue.values[(queue.head + queue.size - 1) % T_length], value))
+        queue.size--;
+    assert(queue.size < T_length);
+    uint32_t back = (queue.head + queue.size) % T_length;
+    queue.values[back] = value;
+    queue.sequences[back] = sequence;
+    queue.size++;
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingExtrema<T_length, T_width>::pop(MonotonicQueue &queue, uint32_t sequence) {
+    if (queue.size != 0 && queue.sequences[queue.head] == sequence) {
+        queue.head = (queue.head + 1) % T_length;
+        queue.size--;
+    }
+}
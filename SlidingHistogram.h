@@ -0,0 +1,161 @@
+/* Header for BasicSlidingHistogram class and the SlidingHistogram tracker. Unfortunately,
+ * templated functions must be visible to the compiler, so implementations of the
+ * functions are included directly by this header.
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "DataContainer.h"
+
+/**
+ * One bin of a SlidingHistogram column: the values from lower up to upper, and how many
+ * of the rows in the buffer fall in it. The bin of NaN values has NaN bounds.
+ */
+struct HistogramBin {
+    double lower;
+    double upper;
+    size_t count;
+};
+
+/**
+ * A StatisticsBuffer tracker giving approximate quantiles and histograms of each column
+ * over the rows currently in the buffer, in memory that does not depend on T_length.
+ *
+ * Each column counts its values in log-spaced bins: every power of two from 2^minExponent
+ * to 2^maxExponent is split into 2^subBinBits equal bins, for either sign, with one more
+ * bin for the values nearer zero than 2^minExponent, an overflow bin for each sign, and
+ * a count of NaN values. A value's bin is read straight from the exponent and leading
+ * mantissa bits of the double, so adding or removing a row costs two counter updates per
+ * column and no comparisons against the other values. With the default range, memory is
+ * about 33 KB per column, whatever the length of the buffer.
+ *
+ * A quantile is found by counting up the bins (a coarse count per 64 bins keeps this to a
+ * few hundred additions per column), and each of the order statistics it interpolates
+ * between is taken as the middle of its bin. The result then differs from the exact
+ * quantile (as given by SlidingQuantiles) by at most 1/128 of the larger magnitude of those
+ * two order statistics, i.e. by under 0.8% for a column of one sign. Values nearer zero
+ * than 2^minExponent are taken as 0. Values of magnitude 2^maxExponent or more, infinities
+ * included, fall in the overflow bin of their sign, taken as -inf or +inf, so a quantile
+ * out of range comes back infinite rather than clamped. NaN values are left out of the
+ * quantiles, which are taken over the other values of each column; a column holding only
+ * NaN gets a NaN quantile.
+ *
+ * The range is set by T_minExponent and T_maxExponent. SlidingHistogram, the tracker
+ * usually listed, covers 2^-32 (about 2.3e-10) to 2^32 (about 4.3e9); for another range,
+ * declare an alias like it, e.g.
+ *   template <size_t L, size_t W> using WideHistogram = BasicSlidingHistogram<L, W, -16, 64>;
+ * Memory grows by 2^subBinBits bins per column for each power of two added.
+ *
+ * Shares its getQuantile() and getMedian() with SlidingQuantiles, so a buffer lists one
+ * or the other.
+ */
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+class BasicSlidingHistogram {
+public:
+    /**
+     * Every bin spans 1/2^subBinBits of the power of two it lies in.
+     */
+    static const unsigned int subBinBits = 6;
+    /**
+     * Values of magnitude from 2^minExponent up to 2^maxExponent get their own bins.
+     */
+    static const int minExponent = T_minExponent;
+    static const int maxExponent = T_maxExponent;
+
+    /**
+     * Returns the given quantile of each column as a DataContainer, to within the bound above.
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param q  the quantile, from 0 (minimum) to 1 (maximum)
+     * @return   a new DataContainer containing the approximate quantile of each column.
+     */
+    const DataContainer<T_width> getQuantile(double q) const;
+
+    /**
+     * Returns the approximate median of each column. Equivalent to getQuantile(0.5).
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the approximate median of each column.
+     */
+    const DataContainer<T_width> getMedian() const;
+
+    /**
+     * Returns the bins of one column holding any of the rows in the buffer, in increasing
+     * order of value, then the bin of NaN values if any. The bin nearest zero spans
+     * -2^minExponent to 2^minExponent, and the overflow bins reach -inf and +inf.
+     *
+     * @param column  the column, less than T_width
+     * @return        a new vector of the non-empty bins
+     */
+    std::vector<HistogramBin> getHistogram(unsigned int column) const;
+
+protected:
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row added.
+     */
+    void onAddRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row removed.
+     */
+    void onRemoveRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer when all rows are dropped at once.
+     */
+    void onClear();
+
+private:
+    static_assert(T_length <= UINT32_MAX, "SlidingHistogram counts rows in 32 bits");
+    static_assert(T_minExponent >= -1022 && T_minExponent < T_maxExponent && T_maxExponent <= 1023,
+                  "SlidingHistogram's exponent range must lie within that of a normal double");
+
+    /**
+     * Bins for each sign, the overflow bin past them, the zero bin between the signs, and
+     * the bins per coarse count. NaN is counted apart from the ordered bins.
+     */
+    static const size_t numSignedBins = size_t(maxExponent - minExponent) << subBinBits;
+    static const size_t numBins = 2 * (numSignedBins + 1) + 1;
+    static const size_t zeroBin = numSignedBins + 1;
+    static const size_t blockSize = 64;
+    static const size_t numBlocks = (numBins + blockSize - 1) / blockSize;
+
+    /**
+     * Returns the bin of a non-NaN value; bins are numbered in increasing order of value.
+     */
+    static size_t binOf(double value);
+
+    /**
+     * Returns the lowest and highest value of a bin.
+     */
+    static void binBounds(size_t bin, double & lower, double & upper);
+
+    /**
+     * Returns the middle of the bin holding the value of the given rank, among the non-NaN
+     * values of one column.
+     */
+    double valueAtRank(unsigned int column, size_t rank) const;
+
+    /**
+     * The number of rows in each bin of each column, and in each block of blockSize bins,
+     * and the number of NaN values in each column.
+     */
+    std::array<std::array<uint32_t, numBins>, T_width> counts_{};
+    std::array<std::array<uint32_t, numBlocks>, T_width> blockCounts_{};
+    std::array<uint32_t, T_width> nanCounts_{};
+    /**
+     * Number of rows counted, the same in every column.
+     */
+    size_t numRows_ = 0;
+};
+
+/**
+ * The SlidingHistogram tracker, with bins from 2^-32 to 2^32.
+ *
+ * Example: StatisticsBuffer<1000000, 4, SlidingHistogram> statBuffer; statBuffer.getQuantile(0.99);
+ */
+template <size_t T_length, size_t T_width>
+using SlidingHistogram = BasicSlidingHistogram<T_length, T_width, -32, 32>;
+
+#include "SlidingHistogram_impl.h"
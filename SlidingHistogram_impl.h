@@ -0,0 +1,189 @@
+#include "SlidingHistogram.h"
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const unsigned int BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::subBinBits;
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const int BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::minExponent;
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const int BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::maxExponent;
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const size_t BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::numBins;
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const DataContainer<T_width>
+BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::getQuantile(double q) const {
+    assert(q >= 0 && q <= 1);
+    assert(this->numRows_ != 0);
+
+    DataContainer<T_width> quantile;
+    for (unsigned int i = 0; i < T_width; i++) {
+        const size_t numValues = this->numRows_ - this->nanCounts_[i];
+        if (numValues == 0) {
+            quantile[i] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        // Ranks as in SlidingQuantiles, among the column's non-NaN values
+        const double rank = (numValues - 1) * q;
+        const size_t lower = static_cast<size_t>(std::floor(rank));
+        const size_t upper = std::min(lower + 1, numValues - 1);
+        const double fraction = rank - lower;
+        const double low = this->valueAtRank(i, lower);
+        if (fraction == 0 || std::isinf(low)) {
+            quantile[i] = low;
+            continue;
+        }
+        // An infinite end outweighs the other, where interpolating would give inf - inf
+        const double high = this->valueAtRank(i, upper);
+        quantile[i] = std::isinf(high) ? high : low + (high - low) * fraction;
+    }
+    return quantile;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+const DataContainer<T_width> BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::getMedian() const {
+    return this->getQuantile(0.5);
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+std::vector<HistogramBin>
+BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::getHistogram(unsigned int column) const {
+    assert(column < T_width);
+    std::vector<HistogramBin> bins;
+    for (size_t block = 0; block < numBlocks; block++) {
+        if (this->blockCounts_[column][block] == 0)
+            continue;
+        const size_t end = std::min(numBins, (block + 1) * blockSize);
+        for (size_t bin = block * blockSize; bin < end; bin++) {
+            if (this->counts_[column][bin] == 0)
+                continue;
+            HistogramBin result;
+            binBounds(bin, result.lower, result.upper);
+            result.count = this->counts_[column][bin];
+            bins.push_back(result);
+        }
+    }
+    if (this->nanCounts_[column] != 0) {
+        HistogramBin result;
+        result.lower = result.upper = std::numeric_limits<double>::quiet_NaN();
+        result.count = this->nanCounts_[column];
+        bins.push_back(result);
+    }
+    return bins;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+void BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::onAddRow(
+        const DataContainer<T_width> &row) {
+    for (unsigned int i = 0; i < T_width; i++) {
+        if (std::isnan(row[i])) {
+            this->nanCounts_[i]++;
+            continue;
+        }
+        const size_t bin = binOf(row[i]);
+        this->counts_[i][bin]++;
+        this->blockCounts_[i][bin / blockSize]++;
+    }
+    this->numRows_++;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+void BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::onRemoveRow(
+        const DataContainer<T_width> &row) {
+    for (unsigned int i = 0; i < T_width; i++) {
+        if (std::isnan(row[i])) {
+            assert(this->nanCounts_[i] > 0);
+            this->nanCounts_[i]--;
+            continue;
+        }
+        const size_t bin = binOf(row[i]);
+        assert(this->counts_[i][bin] > 0);
+        this->counts_[i][bin]--;
+        this->blockCounts_[i][bin / blockSize]--;
+    }
+    this->numRows_--;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+void BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::onClear() {
+    for (unsigned int i = 0; i < T_width; i++) {
+        this->counts_[i].fill(0);
+        this->blockCounts_[i].fill(0);
+    }
+    this->nanCounts_.fill(0);
+    this->numRows_ = 0;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+size_t BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::binOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const int exponent = static_cast<int>((bits >> 52) & 0x7ff) - 1023;
+    if (exponent < minExponent)
+        return zeroBin;
+    // From the last power of two on, infinity included, the overflow bin
+    size_t magnitude = numSignedBins;
+    if (exponent < maxExponent) {
+        const size_t subBin = (bits >> (52 - subBinBits)) & ((size_t(1) << subBinBits) - 1);
+        magnitude = (size_t(exponent - minExponent) << subBinBits) + subBin;
+    }
+    return (bits >> 63) ? zeroBin - 1 - magnitude : zeroBin + 1 + magnitude;
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+void BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::binBounds(size_t bin, double &lower,
+                                                                                       double &upper) {
+    const double smallest = std::ldexp(1.0, minExponent);
+    if (bin == zeroBin) {
+        lower = -smallest;
+        upper = smallest;
+        return;
+    }
+    const size_t magnitude = bin > zeroBin ? bin - zeroBin - 1 : zeroBin - 1 - bin;
+    double start, end;
+    if (magnitude == numSignedBins) {
+        start = std::ldexp(1.0, maxExponent);
+        end = std::numeric_limits<double>::infinity();
+    } else {
+        const int exponent = minExponent + static_cast<int>(magnitude >> subBinBits);
+        const double subBin = static_cast<double>(magnitude & ((size_t(1) << subBinBits) - 1));
+        const double step = std::ldexp(1.0, exponent - static_cast<int>(subBinBits));
+        start = std::ldexp(1.0, exponent) + subBin * step;
+        end = start + step;
+    }
+    if (bin > zeroBin) {
+        lower = start;
+        upper = end;
+    } else {
+        lower = -end;
+        upper = -start;
+    }
+}
+
+template <size_t T_length, size_t T_width, int T_minExponent, int T_maxExponent>
+double BasicSlidingHistogram<T_length, T_width, T_minExponent, T_maxExponent>::valueAtRank(unsigned int column,
+                                                                                           size_t rank) const {
+    // Skip whole blocks, then count through the bins of the one holding the rank
+    size_t block = 0;
+    while (rank >= this->blockCounts_[column][block]) {
+        rank -= this->blockCounts_[column][block];
+        block++;
+    }
+    size_t bin = block * blockSize;
+    while (rank >= this->counts_[column][bin]) {
+        rank -= this->counts_[column][bin];
+        bin++;
+    }
+    if (bin == zeroBin)
+        return 0;
+    // The overflow bins reach infinity, their middle with them
+    double lower, upper;
+    binBounds(bin, lower, upper);
+    return (lower + upper) / 2;
+}
@@ -0,0 +1,70 @@
+/* Header for SlidingQuantiles class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include "DataContainer.h"
+#include "OrderStatisticTree.h"
+
+/**
+ * A StatisticsBuffer tracker giving exact quantiles (median, p95, p99, ...) of each
+ * column over the rows currently in the buffer.
+ *
+ * Each column keeps its values in an OrderStatisticTree, updated in expected
+ * O(log T_length) per row by the add and remove hooks. A quantile query selects the
+ * one or two order statistics it needs from each column in O(log T_length), without
+ * touching the rows.
+ *
+ * Quantiles interpolate linearly between order statistics: with n rows, quantile q
+ * sits at rank h = (n - 1) * q, between the floor(h)-th and ceil(h)-th smallest values
+ * (the same definition as numpy's default and R's type 7). NaN values rank above +inf,
+ * so a window holding any gives NaN for the quantiles near 1, and they are evicted like
+ * any other value.
+ *
+ * Example: StatisticsBuffer<100, 4, SlidingQuantiles> statBuffer; statBuffer.getQuantile(0.95);
+ */
+template <size_t T_length, size_t T_width>
+class SlidingQuantiles {
+public:
+    /**
+     * Returns the given quantile of each column as a DataContainer.
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param q  the quantile, from 0 (minimum) to 1 (maximum)
+     * @return   a new DataContainer containing the quantile of each column.
+     */
+    const DataContainer<T_width> getQuantile(double q) const;
+
+    /**
+     * Returns the median of each column. Equivalent to getQuantile(0.5).
+     * Asserts that the buffer is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the median of each column.
+     */
+    const DataContainer<T_width> getMedian() const;
+
+protected:
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row added.
+     */
+    void onAddRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer for each row removed.
+     */
+    void onRemoveRow(const DataContainer<T_width> & row);
+
+    /**
+     * Tracker hook, called by StatisticsBuffer when all rows are dropped at once.
+     */
+    void onClear();
+
+private:
+    /**
+     * The values of each column, in order.
+     */
+    std::array<OrderStatisticTree<T_length>, T_width> columns_;
+};
+
+#include "SlidingQuantiles_impl.h"
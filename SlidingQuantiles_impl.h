@@ -0,0 +1,50 @@
+#include "SlidingQuantiles.h"
+#include <cmath>
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> SlidingQuantiles<T_length, T_width>::getQuantile(double q) const {
+    assert(q >= 0 && q <= 1);
+    const size_t numRows = this->columns_[0].size();
+    assert(numRows != 0);
+
+    const double rank = (numRows - 1) * q;
+    const size_t lower = static_cast<size_t>(std::floor(rank));
+    const size_t upper = std::min(lower + 1, numRows - 1);
+    const double fraction = rank - lower;
+
+    DataContainer<T_width> quantile;
+    for (unsigned int i = 0; i < T_width; i++) {
+        double low = this->columns_[i].select(lower);
+        if (fraction == 0) {
+            quantile[i] = low;
+            continue;
+        }
+        // Equal order statistics, infinite ones included, are returned as they are
+        double high = this->columns_[i].select(upper);
+        quantile[i] = low == high ? low : low + (high - low) * fraction;
+    }
+    return quantile;
+}
+
+template <size_t T_length, size_t T_width>
+const DataContainer<T_width> SlidingQuantiles<T_length, T_width>::getMedian() const {
+    return this->getQuantile(0.5);
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingQuantiles<T_length, T_width>::onAddRow(const DataContainer<T_width> &row) {
+    for (unsigned int i = 0; i < T_width; i++)
+        this->columns_[i].insert(row[i]);
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingQuantiles<T_length, T_width>::onRemoveRow(const DataContainer<T_width> &row) {
+    for (unsigned int i = 0; i < T_width; i++)
+        this->columns_[i].erase(row[i]);
+}
+
+template <size_t T_length, size_t T_width>
+void SlidingQuantiles<T_length, T_width>::onClear() {
+    for (unsigned int i = 0; i < T_width; i++)
+        this->columns_[i].clear();
+}
@@ -8,21 +8,83 @@
 #pragma once
 #include <array>
 #include <assert.h>
+#include "BufferInstrumentation.h"
 #include "DataContainer.h"
+#include "RingAppend.h"
+#include "RingView.h"
+#include "ShiftedMoments.h"
+#include "StatisticsSummary.h"
+#include "ZScoreThresholds.h"
 
 /**
  * A class providing a circular buffer of DataContainer rows, incrementally 
  * computing the mean and standard deviation for each column. Algorithm taken from
  * https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Computing_shifted_data
+ * The per-column updates run on ColumnKernels.
+ *
+ * The shifted-data sums are only accurate while the location parameter K stays near
+ * the mean, so each time the newest row lands in the last slot of the buffer (once
+ * per T_length rows added), K is moved to the current mean in O(T_width) by adjusting
+ * the sums algebraically. A drifting stream therefore never strays more than one
+ * buffer's worth of rows from its K.
+ *
+ * The ring is indexed with a mask when T_length is a power of two, and otherwise with
+ * a compare-and-reset on each step, so no index update divides.
+ *
+ * Further statistics are opted into by listing trackers after the width, e.g.
+ * StatisticsBuffer<100, 4, SlidingExtrema>. Each tracker is a class template
+ * taking <T_length, T_width> that the buffer inherits from, so its query methods
+ * (such as getMin()) are called on the buffer directly. The buffer calls three
+ * hooks on every tracker, which may be protected:
+ *   void onAddRow(const DataContainer<T_width> & row);     for each row added, in order
+ *   void onRemoveRow(const DataContainer<T_width> & row);  for each row removed, oldest first,
+ *                                                          before the row added in its place
+ *   void onClear();                                        when all rows are dropped at once
+ * With no trackers listed, none of this costs anything.
+ *
+ * Which shifted-data sums are kept is itself chosen in the tracker list, by moment
+ * policies (see ShiftedMoments.h): StatisticsBuffer<1024, 16, MeanOnly> keeps only K
+ * and Ex, so a series needing only the mean pays neither the storage nor the updates
+ * of Ex2, while StatisticsBuffer<1024, 16, HigherMoments> adds the third- and fourth-power
+ * sums for getSkewness() and getKurtosis(). Without a policy Ex and Ex2 are kept, as always. The policies never have
+ * their hooks called, so MeanOnly alone costs nothing beyond the mean.
+ *
+ * Listing Instrumented (see BufferInstrumentation.h) makes the buffer count its rows and
+ * calls and time a sample of them, e.g. StatisticsBuffer<1024, 16, Instrumented>; the
+ * counts are read from getInstrumentation(). Unlisted, the instrumentation compiles away.
+ *
+ * Rows are stored as DataContainer<T_width, T_value>, so a stream of floats or 16-bit
+ * integers can be kept in a half or a quarter of the memory of doubles, e.g.
+ * BasicStatisticsBuffer<100, 4, float>. K and the sums stay double whatever T_value,
+ * so the statistics are exactly those of a double buffer holding the same values.
+ * Trackers are always passed rows as DataContainer<T_width> (doubles), which for narrow
+ * rows costs a conversion per hook call. StatisticsBuffer is the usual double version.
  */
-template <size_t T_length, size_t T_width>
-class StatisticsBuffer {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+class BasicStatisticsBuffer : public T_trackers<T_length, T_width>... {
 public:
     /**
-     * Constructor, initializes internal K_, Ex_, and Ex2_ variables used for incrementally
-     * keeping track of mean and standard-deviation.
+     * The highest power of (x - K) summed: 1 with MeanOnly, 4 with HigherMoments, otherwise 2.
+     */
+    static const unsigned int momentOrder =
+        ShiftedMomentsDetail::BufferOrder<ShiftedMomentsDetail::MomentOrderOf<T_trackers<T_length, T_width> >::value...>::value;
+
+    /**
+     * Whether Instrumented is listed, so that the buffer counts and times its operations.
+     */
+    static const bool instrumented =
+        InstrumentationDetail::AnyOf<InstrumentationDetail::IsInstrumented<T_trackers<T_length, T_width> >::value...>::value;
+
+    /**
+     * Random-access iterator over the rows, oldest first.
+     */
+    typedef typename RingView<DataContainer<T_width, T_value> >::const_iterator const_iterator;
+
+    /**
+     * Constructor, initializes the internal sums used for incrementally keeping track
+     * of mean and standard-deviation.
      */
-    StatisticsBuffer();
+    BasicStatisticsBuffer();
 
     /**
      * Adds a copy of the input row to the circular buffer, cycling out the oldest entry if necessary.
@@ -30,7 +92,41 @@ public:
      *
      * @param data  the DataContainer instance to be added.
      */
-    void addRow(const DataContainer<T_width> & data);
+    void addRow(const DataContainer<T_width, T_value> & data);
+
+    /**
+     * Adds copies of a contiguous block of rows to the circular buffer, oldest first, cycling
+     * out the oldest entries as necessary. Equivalent to calling addRow() on each row in turn,
+     * but the stats are updated with the block kernels, a sweep of rows at a time with each
+     * lane group of the sums held in registers across the sweep, and each sweep of rows is
+     * copied into the buffer straight after its stats, while still in cache.
+     *
+     * @param rows     pointer to the first of the rows to be added
+     * @param numRows  the number of rows to be added
+     */
+    void addRows(const DataContainer<T_width, T_value> * rows, size_t numRows);
+
+    /**
+     * Adds a row as addRow() does, first scoring it against the rows already in the buffer:
+     * each column whose z-score (its distance from the mean, in standard deviations) is above
+     * its threshold is flagged. If any column is, onExceeded(mask, zScores) is called once the
+     * row has been added, with the ColumnMask<T_width> of the flagged columns and the signed
+     * z-score of every column as a DataContainer<T_width>. Otherwise the check costs a few
+     * operations per column in the pass that adds the row to the shifted-data sums, with no
+     * division, square root or allocation. Nothing is flagged while the buffer holds fewer than
+     * two rows. Not available with MeanOnly.
+     *
+     * Example: statBuffer.addRowScored(row, thresholds, [](const ColumnMask<4> & mask,
+     *                                                      const DataContainer<4> & zScores) { ... });
+     *
+     * @param data        the DataContainer instance to be added
+     * @param thresholds  the z-score above which each column is flagged
+     * @param onExceeded  called with the flagged columns, only if there are any
+     * @return            the mask of the flagged columns
+     */
+    template <class T_callback>
+    ColumnMask<T_width> addRowScored(const DataContainer<T_width, T_value> & data,
+                                     const ZScoreThresholds<T_width> & thresholds, T_callback onExceeded);
 
     /**
      * Removes the oldest row from the circular buffer. Simply calls removeRows(1);
@@ -42,7 +138,8 @@ public:
     /**
      * Removes the oldest numRowsToRemove from the circular buffer.
      * Decrementally removes old entries from the stats. If there are less rows than
-     * specified, it stops after removing what it can.
+     * specified, it stops after removing what it can. The removed rows are swept in at
+     * most two contiguous blocks (before and after the wrap point).
      *
      */
     void removeRows(unsigned int numRowsToRemove);
@@ -53,26 +150,53 @@ public:
      *
      * @param rhs  the DataContainer instance to be added
      * @return     a reference to the current StatisticsBuffer
-     * @see #addRow(const DataContainer<T_width> & data)
+     * @see #addRow(const DataContainer<T_width, T_value> & data)
      */
-    StatisticsBuffer & operator += (const DataContainer<T_width> & rhs);
+    BasicStatisticsBuffer & operator += (const DataContainer<T_width, T_value> & rhs);
 
     /**
      * Returns the row specified by the index, in chronological order from oldest to newest.
      * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     * The reference is into the buffer, and is invalidated when rows are added or removed.
      *
      * @param index  the instance to be returned
-     * @return       a copy of the DataContainer requested
+     * @return       a const reference to the DataContainer requested
      */
-    const DataContainer<T_width> getRow(unsigned int index);
+    const DataContainer<T_width, T_value> & getRow(unsigned int index) const;
 
     /**
      * Returns the row most recently added. Equivalent to getRow(currentLength() - 1).
      * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     * The reference is into the buffer, and is invalidated when rows are added or removed.
+     *
+     * @return       a const reference to the DataContainer requested
+     */
+    const DataContainer<T_width, T_value> & getLatestRow() const;
+
+    /**
+     * Returns the rows, oldest first, as at most two contiguous spans of the buffer (before
+     * and after the wrap point), without copying. Each span is an array of rows of T_width
+     * contiguous T_value. The view is invalidated when rows are added or removed.
+     *
+     * Example: statBuffer.view().first[0] is the oldest row, same as statBuffer.getRow(0).
+     *
+     * @return a RingView of the rows
+     */
+    RingView<DataContainer<T_width, T_value> > view() const;
+
+    /**
+     * Returns an iterator to the oldest row. Iterators are invalidated when rows are added or removed.
      *
-     * @return       a copy of the DataContainer requested
+     * @return the iterator
      */
-    const DataContainer<T_width> getLatestRow();
+    const_iterator begin() const;
+
+    /**
+     * Returns an iterator one past the newest row.
+     *
+     * @return the iterator
+     */
+    const_iterator end() const;
 
     /**
      * Returns the current mean of each column of the StatisticsBuffer as a DataContainer.
@@ -80,36 +204,73 @@ public:
      *
      * @return a new DataContainer containing the mean of each column.
      */
-    const DataContainer<T_width> getMean();
+    const DataContainer<T_width> getMean() const;
 
     /**
      * Returns the current standard deviation of each column of the StatisticsBuffer as a DataContainer.
      * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     * Not available with MeanOnly.
      *
      * @return a new DataContainer containing the standard deviation of each column.
      */
-    const DataContainer<T_width> getStdDev();
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Returns the current skewness of each column, sqrt(n) * m3 / m2^(3/2) with m2 and m3 the
+     * sums of the squared and cubed deviations from the mean (the population estimate, without
+     * a small-sample correction). A constant column gives NaN.
+     * Asserts that the current instance is not empty! Only available with HigherMoments.
+     *
+     * @return a new DataContainer containing the skewness of each column.
+     */
+    const DataContainer<T_width> getSkewness() const;
+
+    /**
+     * Returns the current excess kurtosis of each column, n * m4 / m2^2 - 3 (0 for a normal
+     * distribution), likewise without a small-sample correction. A constant column gives NaN.
+     * Asserts that the current instance is not empty! Only available with HigherMoments.
+     *
+     * @return a new DataContainer containing the excess kurtosis of each column.
+     */
+    const DataContainer<T_width> getKurtosis() const;
+
+    /**
+     * Returns a copy of the current statistics state (K, Ex, Ex2 and the number of rows),
+     * from which the mean and standard deviation can be computed without the buffer.
+     * Not available with MeanOnly.
+     *
+     * @return a new StatisticsSummary of the current rows
+     */
+    const StatisticsSummary<T_width> getSummary() const;
+
+    /**
+     * Moves the internal location parameter K of each column to its current mean, adjusting
+     * the sums so that the mean and standard deviation are unchanged. Called automatically
+     * once per T_length rows added; calling it yourself is only useful after a sudden shift
+     * in the data. Does nothing if the buffer is empty.
+     */
+    void recenter();
 
     /**
      * Returns the maximum length (number of rows) of the StatisticsBuffer. 
      *
      * @return a size_t value of the maximum number of rows.
      */
-    size_t maxLength();
+    size_t maxLength() const;
 
     /**
      * Returns the current length (number of rows) of the StatisticsBuffer. 
      *
      * @return a size_t value of the current number of rows.
      */
-    size_t currentLength();
+    size_t currentLength() const;
 
     /**
      * Returns true if the StatisticsBuffer no longer contains any entries, otherwise false.
      *
      * @return boolean result of test
      */
-    bool isEmpty();
+    bool isEmpty() const;
 
     /**
      * Returns true if the StatisticsBuffer is full, otherwise false.
@@ -117,21 +278,74 @@ public:
      *
      * @return boolean result of test
      */
-    bool isFull();
+    bool isFull() const;
 
 private:
+    /**
+     * The number of listed trackers whose hooks are called, which excludes the moment
+     * policies and Instrumented.
+     */
+    static const size_t numHooked =
+        ShiftedMomentsDetail::NumHooked<(ShiftedMomentsDetail::MomentOrderOf<T_trackers<T_length, T_width> >::value == 0
+                                         && !InstrumentationDetail::IsInstrumented<T_trackers<T_length, T_width> >::value)...>::value;
+
+    /**
+     * Counts and times one call of an operation when the buffer is instrumented.
+     */
+    typedef InstrumentationDetail::Probe<instrumented> Probe;
+
+    /**
+     * Returns index, less than 2 * T_length, wrapped into the ring.
+     */
+    static size_t wrap(size_t index);
+
+    /**
+     * Returns the index following index in the ring.
+     */
+    static size_t next(size_t index);
+
+    /**
+     * Adds a row as addRow() documents, with add(row) updating the sums while the buffer fills
+     * and replace(oldRow, row) once it is full.
+     */
+    template <class T_add, class T_replace>
+    void pushRow(const DataContainer<T_width, T_value> & data, T_add add, T_replace replace);
+
+    /**
+     * Passes a row being added to every tracker's onAddRow().
+     */
+    void notifyAddRow(const DataContainer<T_width, T_value> & row);
+
+    /**
+     * Passes a row being removed to every tracker's onRemoveRow().
+     */
+    void notifyRemoveRow(const DataContainer<T_width, T_value> & row);
+
+    /**
+     * Calls every tracker's onClear().
+     */
+    void notifyClear();
+
+    /**
+     * Returns a row as doubles, for the trackers: the row itself if it already is.
+     */
+    static const DataContainer<T_width> & asDouble(const DataContainer<T_width> & row);
+
+    template <class T_narrow>
+    static const DataContainer<T_width> asDouble(const DataContainer<T_width, T_narrow> & row);
+
     /**
      * The internal representation of the circular buffer.
      */
-    std::array<DataContainer<T_width>, T_length> circularBuffer_;
+    std::array<DataContainer<T_width, T_value>, T_length> circularBuffer_;
     /**
      * Index of the circularBuffer corresponding to the oldest entry.
      */
-    int headIndex_ = 0;
+    size_t headIndex_ = 0;
     /**
      * Index of the circularBuffer corresponding to the newest entry.
      */
-    int tailIndex_ = -1; // -1 so we can pre-increment in addRow
+    size_t tailIndex_ = T_length - 1; // the last slot, so we can pre-increment in addRow
     /**
      * Current length of the buffer. Easier to keep track of than trying to find
      * differences between headIndex and tailIndex
@@ -139,17 +353,17 @@ private:
     unsigned int numRows_ = 0; // current size
 
     /**
-     * Internal "location parameter", used to ensure subtractions are not too far from the mean.
+     * The location parameter K and the shifted-data sums of the order the policies ask for.
      */
-    DataContainer<T_width> K_;
-    /**
-     * Internal parameter containing the difference between the datapoint and the location parameter
-     */
-    DataContainer<T_width> Ex_;
-    /**
-     * Internal parameter containing the square of Ex_
-     */
-    DataContainer<T_width> Ex2_;
+    ShiftedMoments<T_width, momentOrder> moments_;
 };
 
+/**
+ * A BasicStatisticsBuffer storing its rows as doubles.
+ *
+ * Example: StatisticsBuffer<100, 4, SlidingExtrema> statBuffer;
+ */
+template <size_t T_length, size_t T_width, template <size_t, size_t> class... T_trackers>
+using StatisticsBuffer = BasicStatisticsBuffer<T_length, T_width, double, T_trackers...>;
+
 #include "StatisticsBuffer_impl.h"
@@ -1,124 +1,347 @@
 #include "StatisticsBuffer.h"
 
-template <size_t T_length, size_t T_width>
-StatisticsBuffer<T_length, T_width>::StatisticsBuffer() {
-    this->K_.fill(0);
-    this->Ex_.fill(0);
-    this->Ex2_.fill(0);
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::BasicStatisticsBuffer() {
 }
 
 
-template <size_t T_length, size_t T_width>
-void StatisticsBuffer<T_length, T_width>::addRow(const DataContainer<T_width> &data) {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::addRow(const DataContainer<T_width, T_value> &data) {
+    this->pushRow(data, [this](const T_value *row) { this->moments_.add(row); },
+                  [this](const T_value *oldRow, const T_value *row) { this->moments_.replace(oldRow, row); });
+}
 
-    double diff;
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+template <class T_add, class T_replace>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::pushRow(
+        const DataContainer<T_width, T_value> &data, T_add add, T_replace replace) {
+    Probe probe(this, BufferInstrumentation::AddRow);
 
     if (this->numRows_ == 0) {
         // K must be initialized to a value within the sample range.
         // Close to mean is preferable, but not required.
-        this->K_ = data;
+        this->moments_.K = data;
     }
 
-    this->tailIndex_ = (this->tailIndex_ + 1) % T_length;
+    this->tailIndex_ = next(this->tailIndex_);
 
     // if buffer isn't full yet, just mark that we're increasing in size
     if (this->numRows_ < T_length) {
-       this->numRows_++;
+        this->numRows_++;
+        add(data.data());
+        probe.countRows(1, 0, 0);
     } else {
-    // if buffer is full, we need to remove the current head from estimator, and move the head
-        for (unsigned int i = 0; i < T_width; i++) {
-            diff = this->circularBuffer_[this->headIndex_][i] - this->K_[i];
-            this->Ex_[i] -= diff;
-            this->Ex2_[i] -= diff*diff;
-        }
-        this->headIndex_ = (this->headIndex_ + 1) % T_length;
+        // if buffer is full, the current head (which tail now points at) is removed from
+        // the estimator and the new data added in the same pass, then the head moves
+        this->notifyRemoveRow(this->circularBuffer_[this->tailIndex_]);
+        replace(this->circularBuffer_[this->tailIndex_].data(), data.data());
+        this->headIndex_ = next(this->headIndex_);
+        probe.countRows(1, 1, 0);
     }
 
+    this->notifyAddRow(data);
     // Adds new data or replaces old
     this->circularBuffer_[this->tailIndex_] = data;
-    // Add data to mean/variance
-    for (unsigned int i = 0; i < T_width; i++) {
-        diff = this->circularBuffer_[this->tailIndex_][i] - this->K_[i];
-        this->Ex_[i] += diff;
-        this->Ex2_[i] += diff*diff;
+
+    if (this->tailIndex_ == T_length - 1)
+        this->recenter();
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::addRows(const DataContainer<T_width, T_value> *rows, size_t numRows) {
+    Probe probe(this, BufferInstrumentation::AddRows);
+    if (numRows == 0)
+        return;
+    // Rows skipped below count as evicted, as they would be by addRow
+    const size_t rowsBefore = this->numRows_;
+    const size_t rowsAdded = numRows;
+
+    if (this->numRows_ == 0) {
+        // Same K as addRow would pick for the first row
+        this->moments_.K = rows[0];
     }
+
+    if (numRows > T_length) {
+        // Everything currently buffered, and all but the last T_length new rows, would be cycled
+        // out again by the end of the block, so skip straight to that state (keeping K)
+        rows += numRows - T_length;
+        numRows = T_length;
+        this->numRows_ = 0;
+        this->headIndex_ = 0;
+        this->tailIndex_ = T_length - 1;
+        this->moments_.clear();
+        this->notifyClear();
+    }
+
+    // New rows go into the slots following the tail. The first numFree of them land in empty
+    // slots; each one after that overwrites (and so evicts) the current head.
+    const size_t start = next(this->tailIndex_);
+    const size_t numFree = T_length - this->numRows_;
+    const size_t numEvicted = numRows > numFree ? numRows - numFree : 0;
+
+    // Trackers see each eviction and addition in the same order addRow would give them, before
+    // the evicted rows are overwritten below
+    if (numHooked > 0) {
+        for (size_t k = 0; k < numRows; k++) {
+            if (k >= numFree)
+                this->notifyRemoveRow(this->circularBuffer_[wrap(this->headIndex_ + k - numFree)]);
+            this->notifyAddRow(rows[k]);
+        }
+    }
+
+    // One pass over the stats, a kernel sweep at a time, each sweep of rows copied into its slots
+    // while still in cache and only once the rows it evicts have been taken out of the stats
+    appendToRing(T_length, start, numFree, numRows, ColumnKernels::sweepRows(T_width),
+                 [&](size_t first, size_t, size_t count) {
+                     this->moments_.addRows(rows[first].data(), count);
+                 },
+                 [&](size_t first, size_t slot, size_t count) {
+                     this->moments_.replaceRows(this->circularBuffer_[slot].data(), rows[first].data(), count);
+                 },
+                 [&](size_t first, size_t slot, size_t count) {
+                     std::copy(rows + first, rows + first + count, this->circularBuffer_.begin() + slot);
+                 },
+                 [&](size_t numRowsNow) { this->moments_.recenter(numRowsNow); });
+
+    this->numRows_ += numRows - numEvicted;
+    this->headIndex_ = wrap(this->headIndex_ + numEvicted);
+    this->tailIndex_ = wrap(start + numRows - 1);
+    probe.countRows(rowsAdded, rowsBefore + rowsAdded - this->numRows_, 0);
 }
 
-template <size_t T_length, size_t T_width>
-void StatisticsBuffer<T_length, T_width>::removeRow() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+template <class T_callback>
+ColumnMask<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::addRowScored(
+        const DataContainer<T_width, T_value> &data, const ZScoreThresholds<T_width> &thresholds,
+        T_callback onExceeded) {
+    static_assert(momentOrder >= 2, "addRowScored() needs Ex2, which this buffer's moment policy does not keep");
+    ColumnMask<T_width> mask;
+    if (this->numRows_ < 2) {
+        this->addRow(data);
+        return mask;
+    }
+
+    // Scored against the sums before the row goes into them, in the pass that adds it
+    const double *squaredThresholds = thresholds.getSquaredThresholds().data();
+    const double count = this->numRows_;
+    DataContainer<T_width> deviation, sumSquares;
+    double largest;
+    this->pushRow(data,
+                  [&](const T_value *row) {
+                      largest = this->moments_.addScored(deviation.data(), sumSquares.data(), row, squaredThresholds,
+                                                         count);
+                  },
+                  [&](const T_value *oldRow, const T_value *row) {
+                      largest = this->moments_.replaceScored(deviation.data(), sumSquares.data(), oldRow, row,
+                                                             squaredThresholds, count);
+                  });
+    if (!(largest > 0))
+        return mask;
+
+    // Only now are the flagged columns picked out, with the kernel's excess, and the z-scores taken
+    for (unsigned int i = 0; i < T_width; i++)
+        mask[i] = (deviation[i] * deviation[i]) * (count - 1) - squaredThresholds[i] * sumSquares[i] > 0;
+    if (mask.none())
+        return mask;
+    DataContainer<T_width> zScores;
+    for (unsigned int i = 0; i < T_width; i++)
+        zScores[i] = deviation[i] / std::sqrt(sumSquares[i] / (count - 1));
+    onExceeded(mask, zScores);
+    return mask;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::removeRow() {
     this->removeRows(1);
 }
-template <size_t T_length, size_t T_width>
-void StatisticsBuffer<T_length, T_width>::removeRows(unsigned int numRowsToRemove) {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::removeRows(unsigned int numRowsToRemove) {
+    Probe probe(this, BufferInstrumentation::RemoveRows);
     assert(!this->isEmpty());
 
-    double diff;
-    for (unsigned int k = 0; k < numRowsToRemove && this->numRows_ != 0; k++)  {
-        this->numRows_--;
-        for (unsigned int i = 0; i < T_width; i++) {
-            diff = this->circularBuffer_[this->headIndex_][i] - this->K_[i];
-            this->Ex_[i] -= diff;
-            this->Ex2_[i] -= diff*diff;
-        }
-        this->headIndex_ = (this->headIndex_ + 1) % T_length;
+    const size_t numRemoved = std::min<size_t>(numRowsToRemove, this->numRows_);
+    // The removed rows run from the head, wrapping around the end of the buffer at most once
+    const size_t firstLength = std::min<size_t>(numRemoved, T_length - this->headIndex_);
+    this->moments_.removeRows(this->circularBuffer_[this->headIndex_].data(), firstLength);
+    this->moments_.removeRows(this->circularBuffer_[0].data(), numRemoved - firstLength);
+    if (numHooked > 0) {
+        for (size_t k = 0; k < numRemoved; k++)
+            this->notifyRemoveRow(this->circularBuffer_[wrap(this->headIndex_ + k)]);
     }
+
+    this->numRows_ -= numRemoved;
+    this->headIndex_ = wrap(this->headIndex_ + numRemoved);
+    probe.countRows(0, 0, numRemoved);
 }
 
-template <size_t T_length, size_t T_width>
-StatisticsBuffer<T_length, T_width> & StatisticsBuffer<T_length, T_width>::operator+=(const DataContainer<T_width> &data) {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...> & BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::operator+=(const DataContainer<T_width, T_value> &data) {
     this->addRow(data);
     return *this;
 }
 
-template <size_t T_length, size_t T_width>
-const DataContainer<T_width> StatisticsBuffer<T_length, T_width>::getRow(unsigned int index) { 
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width, T_value> & BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getRow(unsigned int index) const {
     assert(!this->isEmpty());
-    return this->circularBuffer_[(this->headIndex_ + index) % T_length];
+    return this->circularBuffer_[wrap(this->headIndex_ + index)];
 }
 
-template <size_t T_length, size_t T_width>
-const DataContainer<T_width> StatisticsBuffer<T_length, T_width>::getLatestRow() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width, T_value> & BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getLatestRow() const {
     assert(!this->isEmpty());
     return this->circularBuffer_[this->tailIndex_];
 }
 
-template <size_t T_length, size_t T_width>
-const DataContainer<T_width> StatisticsBuffer<T_length, T_width>::getMean() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+RingView<DataContainer<T_width, T_value> > BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::view() const {
+    const DataContainer<T_width, T_value> *data = this->circularBuffer_.data();
+    RingView<DataContainer<T_width, T_value> > view;
+    view.firstSize = std::min<size_t>(this->numRows_, T_length - this->headIndex_);
+    view.first = view.firstSize ? data + this->headIndex_ : nullptr;
+    view.secondSize = this->numRows_ - view.firstSize;
+    view.second = view.secondSize ? data : nullptr;
+    return view;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+typename BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::const_iterator
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::begin() const {
+    return this->view().begin();
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+typename BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::const_iterator
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::end() const {
+    return this->view().end();
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getMean() const {
+    Probe probe(this, BufferInstrumentation::GetMean);
     assert(!this->isEmpty());
     DataContainer<T_width> mean;
-    for (unsigned int i = 0; i < T_width; i++) {
-        mean[i] = this->K_[i] + this->Ex_[i] / this->numRows_;
-    }
+    this->moments_.getMean(mean.data(), this->numRows_);
     return mean;
 }
 
-template <size_t T_length, size_t T_width>
-const DataContainer<T_width> StatisticsBuffer<T_length, T_width>::getStdDev() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getStdDev() const {
+    static_assert(momentOrder >= 2, "getStdDev() needs Ex2, which this buffer's moment policy does not keep");
+    Probe probe(this, BufferInstrumentation::GetStdDev);
     assert(!this->isEmpty());
-    DataContainer<T_width> variance;
-    for (unsigned int i = 0; i < T_width; i++) {
-        // could use Pow here, but would require another variable
-        variance[i] = (this->Ex2_[i] - (this->Ex_[i]*this->Ex_[i]) / this->numRows_) / (this->numRows_-1);
-    }
-    return variance.Sqrt();
+    DataContainer<T_width> stdDev;
+    this->moments_.getStdDev(stdDev.data(), this->numRows_);
+    return stdDev;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getSkewness() const {
+    static_assert(momentOrder >= 4, "getSkewness() needs Ex3, which only the HigherMoments policy keeps");
+    Probe probe(this, BufferInstrumentation::GetSkewness);
+    assert(!this->isEmpty());
+    DataContainer<T_width> skewness;
+    this->moments_.getSkewness(skewness.data(), this->numRows_);
+    return skewness;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getKurtosis() const {
+    static_assert(momentOrder >= 4, "getKurtosis() needs Ex4, which only the HigherMoments policy keeps");
+    Probe probe(this, BufferInstrumentation::GetKurtosis);
+    assert(!this->isEmpty());
+    DataContainer<T_width> kurtosis;
+    this->moments_.getKurtosis(kurtosis.data(), this->numRows_);
+    return kurtosis;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const StatisticsSummary<T_width> BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::getSummary() const {
+    static_assert(momentOrder >= 2, "getSummary() needs Ex2, which this buffer's moment policy does not keep");
+    Probe probe(this, BufferInstrumentation::GetSummary);
+    StatisticsSummary<T_width> summary;
+    summary.K = this->moments_.K;
+    summary.Ex = this->moments_.Ex;
+    summary.Ex2 = this->moments_.Ex2;
+    summary.numRows = this->numRows_;
+    return summary;
 }
 
-template <size_t T_length, size_t T_width>
-size_t StatisticsBuffer<T_length, T_width>::maxLength() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::recenter() {
+    if (this->numRows_ == 0)
+        return;
+    this->moments_.recenter(this->numRows_);
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+size_t BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::maxLength() const {
     return T_length;
 }
 
-template <size_t T_length, size_t T_width>
-size_t StatisticsBuffer<T_length, T_width>::currentLength() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+size_t BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::currentLength() const {
     return this->numRows_;
 }
 
-template <size_t T_length, size_t T_width>
-bool StatisticsBuffer<T_length, T_width>::isEmpty() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+bool BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::isEmpty() const {
     return this->numRows_ == 0;
 }
 
-template <size_t T_length, size_t T_width>
-bool StatisticsBuffer<T_length, T_width>::isFull() {
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+bool BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::isFull() const {
     return this->numRows_ == T_length;
 }
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+size_t BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::wrap(size_t index) {
+    // Both branches are resolved at compile time
+    if ((T_length & (T_length - 1)) == 0)
+        return index & (T_length - 1);
+    return index < T_length ? index : index - T_length;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+size_t BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::next(size_t index) {
+    return wrap(index + 1);
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::notifyAddRow(const DataContainer<T_width, T_value> &row) {
+    if (numHooked == 0)
+        return;
+    // Calls each tracker's hook in turn; the leading 0 keeps the array non-empty with no trackers
+    const DataContainer<T_width> &wide = asDouble(row);
+    int expand[] = {0, (this->T_trackers<T_length, T_width>::onAddRow(wide), 0)...};
+    (void)expand;
+    (void)wide;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::notifyRemoveRow(const DataContainer<T_width, T_value> &row) {
+    if (numHooked == 0)
+        return;
+    const DataContainer<T_width> &wide = asDouble(row);
+    int expand[] = {0, (this->T_trackers<T_length, T_width>::onRemoveRow(wide), 0)...};
+    (void)expand;
+    (void)wide;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+void BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::notifyClear() {
+    int expand[] = {0, (this->T_trackers<T_length, T_width>::onClear(), 0)...};
+    (void)expand;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+const DataContainer<T_width> &
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::asDouble(const DataContainer<T_width> &row) {
+    return row;
+}
+
+template <size_t T_length, size_t T_width, class T_value, template <size_t, size_t> class... T_trackers>
+template <class T_narrow>
+const DataContainer<T_width>
+BasicStatisticsBuffer<T_length, T_width, T_value, T_trackers...>::asDouble(const DataContainer<T_width, T_narrow> &row) {
+    return DataContainer<T_width>(row);
+}
@@ -0,0 +1,194 @@
+/* Header for StatisticsPyramid class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <array>
+#include <assert.h>
+#include "DataContainer.h"
+#include "SlidingExtrema.h"
+#include "StatisticsBuffer.h"
+#include "StatisticsSummary.h"
+
+/**
+ * The mean, standard deviation, minimum and maximum of one stream over several window
+ * lengths at once (say a second, a minute and an hour), from a single ingest.
+ *
+ * Level 0 is a StatisticsBuffer of the last T_length raw rows. Every coarser level keeps
+ * only per-bucket aggregates (row count, shifted sums, min and max), never rows: a level 1
+ * bucket covers T_length rows, and each bucket at level k > 1 covers T_buckets buckets of
+ * level k - 1. Level k >= 1 reports on its last T_buckets complete buckets plus everything
+ * since (the open buckets of levels 1 to k), so it always includes the newest row. With T_length = 100 rows per second
+ * and T_buckets = 60, levels 0, 1 and 2 span about a second, a minute and an hour.
+ *
+ * Ingest costs O(T_width) per row for level 0 and the open level 1 bucket, plus O(T_width)
+ * per bucket closed, whatever the number of levels. A query at level k merges its T_buckets + k
+ * aggregates in O((T_buckets + k) * T_width). Each bucket keeps its own location
+ * parameter K (its first row), so no level loses precision as the stream drifts.
+ *
+ * Example: StatisticsPyramid<100, 4, 60, 3> pyramid; pyramid.addRow(row); pyramid.getMean(2);
+ */
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+class StatisticsPyramid {
+    static_assert(T_levels >= 1, "a StatisticsPyramid needs at least the raw level");
+    static_assert(T_buckets >= 1, "coarse levels need at least one bucket");
+
+public:
+    /**
+     * Constructor, initializes every level empty.
+     */
+    StatisticsPyramid();
+
+    /**
+     * Adds a row to every level.
+     *
+     * @param data  the DataContainer instance to be added.
+     */
+    void addRow(const DataContainer<T_width> & data);
+
+    /**
+     * Adds a contiguous block of rows to every level, oldest first. Equivalent to calling
+     * addRow() on each row in turn, with the raw level ingesting the block through addRows().
+     *
+     * @param rows     pointer to the first of the rows to be added
+     * @param numRows  the number of rows to be added
+     */
+    void addRows(const DataContainer<T_width> * rows, size_t numRows);
+
+    /**
+     * Returns the shifted-data statistics state (K, Ex, Ex2 and the number of rows) covering
+     * the given level's window.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a new StatisticsSummary of the level's window
+     */
+    const StatisticsSummary<T_width> getSummary(size_t level) const;
+
+    /**
+     * Returns the mean of each column over the given level's window.
+     * Asserts that the pyramid is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean(size_t level) const;
+
+    /**
+     * Returns the standard deviation of each column over the given level's window.
+     * Asserts that the pyramid is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev(size_t level) const;
+
+    /**
+     * Returns the minimum of each column over the given level's window.
+     * Asserts that the pyramid is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a new DataContainer containing the minimum of each column.
+     */
+    const DataContainer<T_width> getMin(size_t level) const;
+
+    /**
+     * Returns the maximum of each column over the given level's window.
+     * Asserts that the pyramid is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a new DataContainer containing the maximum of each column.
+     */
+    const DataContainer<T_width> getMax(size_t level) const;
+
+    /**
+     * Returns the raw-row buffer that is level 0.
+     *
+     * @return a const reference to the level 0 StatisticsBuffer
+     */
+    const StatisticsBuffer<T_length, T_width, SlidingExtrema> & rawLevel() const;
+
+    /**
+     * Returns the number of raw rows covered by the given level's window.
+     *
+     * @param level  the level, from 0 (raw rows) to T_levels - 1
+     * @return       a size_t value of the number of rows.
+     */
+    size_t currentLength(size_t level) const;
+
+    /**
+     * Returns the number of levels, T_levels.
+     *
+     * @return a size_t value of the number of levels.
+     */
+    size_t numLevels() const;
+
+    /**
+     * Returns true if no rows have been added, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+private:
+    /**
+     * Aggregate of a run of consecutive rows. Merging two buckets gives the bucket of both runs.
+     */
+    struct Bucket {
+        /**
+         * Shifted sums relative to moments.K, the first row of the run.
+         */
+        StatisticsSummary<T_width> moments;
+        DataContainer<T_width> min;
+        DataContainer<T_width> max;
+
+        /**
+         * Adds numRows contiguous rows to the bucket.
+         */
+        void addRows(const DataContainer<T_width> * rows, size_t numRows);
+
+        /**
+         * Adds the rows summarized by another bucket.
+         */
+        void merge(const Bucket & other);
+    };
+
+    /**
+     * One coarse level: a circular buffer of complete buckets, plus the bucket being filled.
+     */
+    struct Level {
+        std::array<Bucket, T_buckets> buckets;
+        /**
+         * Index of the oldest complete bucket.
+         */
+        size_t headIndex;
+        /**
+         * Number of complete buckets.
+         */
+        size_t numBuckets;
+        Bucket open;
+        /**
+         * Number of lower-level buckets (raw rows, for level 1) merged into the open bucket.
+         */
+        size_t numOpenParts;
+    };
+
+    /**
+     * Pushes the open bucket of coarse level index (level index + 1) into its circular
+     * buffer, merges it into the next level's open bucket, and starts a new one.
+     */
+    void closeBucket(size_t index);
+
+    /**
+     * Merges every bucket covered by coarse level index (level index + 1): its complete
+     * buckets, its open bucket and the open buckets of the levels below it.
+     */
+    const Bucket mergeLevel(size_t index) const;
+
+    StatisticsBuffer<T_length, T_width, SlidingExtrema> raw_;
+    /**
+     * Levels 1 to T_levels - 1 (one dummy level when T_levels is 1, so the array is never empty).
+     */
+    std::array<Level, (T_levels > 1 ? T_levels - 1 : 1)> levels_;
+};
+
+#include "StatisticsPyramid_impl.h"
@@ -0,0 +1,176 @@
+#include "StatisticsPyramid.h"
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+void StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::Bucket::addRows(const DataContainer<T_width> *rows,
+                                                                                size_t numRows) {
+    if (numRows == 0)
+        return;
+    if (this->moments.isEmpty()) {
+        this->moments.K = rows[0];
+        this->min = rows[0];
+        this->max = rows[0];
+    }
+    ColumnKernels::addShiftedRows(this->moments.Ex.data(), this->moments.Ex2.data(), rows[0].data(), numRows,
+                                  this->moments.K.data(), T_width);
+    for (size_t r = 0; r < numRows; r++) {
+        for (unsigned int i = 0; i < T_width; i++) {
+            this->min[i] = std::min(this->min[i], rows[r][i]);
+            this->max[i] = std::max(this->max[i], rows[r][i]);
+        }
+    }
+    this->moments.numRows += numRows;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+void StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::Bucket::merge(const Bucket &other) {
+    if (other.moments.isEmpty())
+        return;
+    if (this->moments.isEmpty()) {
+        *this = other;
+        return;
+    }
+    this->moments.merge(other.moments);
+    for (unsigned int i = 0; i < T_width; i++) {
+        this->min[i] = std::min(this->min[i], other.min[i]);
+        this->max[i] = std::max(this->max[i], other.max[i]);
+    }
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::StatisticsPyramid() {
+    for (auto &level: this->levels_) {
+        level.headIndex = 0;
+        level.numBuckets = 0;
+        level.numOpenParts = 0;
+    }
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+void StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::addRow(const DataContainer<T_width> &data) {
+    this->addRows(&data, 1);
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+void StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::addRows(const DataContainer<T_width> *rows,
+                                                                        size_t numRows) {
+    this->raw_.addRows(rows, numRows);
+    if (T_levels == 1)
+        return;
+
+    // Fill the open level 1 bucket up to each bucket boundary in turn
+    Level &level = this->levels_[0];
+    while (numRows > 0) {
+        const size_t numTaken = std::min(numRows, T_length - level.numOpenParts);
+        level.open.addRows(rows, numTaken);
+        level.numOpenParts += numTaken;
+        if (level.numOpenParts == T_length)
+            this->closeBucket(0);
+        rows += numTaken;
+        numRows -= numTaken;
+    }
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+void StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::closeBucket(size_t index) {
+    Level &level = this->levels_[index];
+    if (level.numBuckets < T_buckets) {
+        level.buckets[(level.headIndex + level.numBuckets) % T_buckets] = level.open;
+        level.numBuckets++;
+    } else {
+        // the oldest bucket is overwritten by the newest
+        level.buckets[level.headIndex] = level.open;
+        level.headIndex = (level.headIndex + 1) % T_buckets;
+    }
+
+    if (index + 2 < T_levels) {
+        Level &next = this->levels_[index + 1];
+        next.open.merge(level.open);
+        if (++next.numOpenParts == T_buckets)
+            this->closeBucket(index + 1);
+    }
+
+    level.open = Bucket();
+    level.numOpenParts = 0;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const typename StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::Bucket
+StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::mergeLevel(size_t index) const {
+    // Rows not yet in this level's open bucket are in the open buckets below it. Anchored on the
+    // newest rows, in the level 1 open bucket.
+    Bucket merged = this->levels_[0].open;
+    for (size_t below = 1; below <= index; below++)
+        merged.merge(this->levels_[below].open);
+    const Level &level = this->levels_[index];
+    for (size_t b = level.numBuckets; b > 0; b--)
+        merged.merge(level.buckets[(level.headIndex + b - 1) % T_buckets]);
+    return merged;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const StatisticsSummary<T_width> StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::getSummary(size_t level) const {
+    assert(level < T_levels);
+    if (level == 0)
+        return this->raw_.getSummary();
+    return this->mergeLevel(level - 1).moments;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const DataContainer<T_width> StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::getMean(size_t level) const {
+    assert(!this->isEmpty());
+    return this->getSummary(level).getMean();
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const DataContainer<T_width> StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::getStdDev(size_t level) const {
+    assert(!this->isEmpty());
+    return this->getSummary(level).getStdDev();
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const DataContainer<T_width> StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::getMin(size_t level) const {
+    assert(level < T_levels);
+    assert(!this->isEmpty());
+    if (level == 0)
+        return this->raw_.getMin();
+    return this->mergeLevel(level - 1).min;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const DataContainer<T_width> StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::getMax(size_t level) const {
+    assert(level < T_levels);
+    assert(!this->isEmpty());
+    if (level == 0)
+        return this->raw_.getMax();
+    return this->mergeLevel(level - 1).max;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+const StatisticsBuffer<T_length, T_width, SlidingExtrema> &
+StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::rawLevel() const {
+    return this->raw_;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+size_t StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::currentLength(size_t level) const {
+    assert(level < T_levels);
+    if (level == 0)
+        return this->raw_.currentLength();
+    size_t numRows = 0;
+    for (size_t below = 0; below < level; below++)
+        numRows += this->levels_[below].open.moments.numRows;
+    const Level &coarse = this->levels_[level - 1];
+    for (size_t b = 0; b < coarse.numBuckets; b++)
+        numRows += coarse.buckets[b].moments.numRows;
+    return numRows;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+size_t StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::numLevels() const {
+    return T_levels;
+}
+
+template <size_t T_length, size_t T_width, size_t T_buckets, size_t T_levels>
+bool StatisticsPyramid<T_length, T_width, T_buckets, T_levels>::isEmpty() const {
+    return this->raw_.isEmpty();
+}
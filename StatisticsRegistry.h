@@ -0,0 +1,239 @@
+/* Header for StatisticsRegistry class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "DynamicStatisticsBuffer.h"
+
+/**
+ * A keyed collection of windows of the same shape, one per metric key, for keeping tens
+ * of thousands of them without one object, allocation and lock per key.
+ *
+ * Keys are spread over shards by hash. Each shard has its own lock, key index and pool:
+ * its windows are DynamicStatisticsBuffers laid out back to back, cache-line aligned, in
+ * slabs of about a megabyte, so creating a key allocates nothing in the common case and
+ * neighbouring windows share pages. Keys are never removed.
+ *
+ * addRows() ingests a batch of rows for many keys in parallel: the calling thread hashes
+ * the keys and lists the batch's rows shard by shard, then one worker per shard, the
+ * calling thread being the first, adds the rows of its list in batch order, so a key's
+ * window is exactly the one adding its rows one by one would give.
+ * getMeans() and getStdDevs() write the statistics of every key into one contiguous
+ * numKeys() x width() matrix, a shard per worker, in the order given by keys().
+ *
+ * All the methods may be called from any thread; a key's window found with find() must
+ * not be used while another thread adds rows.
+ *
+ * Example: StatisticsRegistry<std::string> registry(1000, 4); registry.addRows(keys, rows, numRows);
+ */
+template <class T_key, class T_hash = std::hash<T_key> >
+class StatisticsRegistry {
+public:
+    /**
+     * Constructor, starts the workers. No windows are allocated until their keys appear.
+     *
+     * @param length     the maximum number of rows in each key's window
+     * @param width      the number of columns in each row
+     * @param numShards  the number of shards (and workers), or 0 for the number of cores
+     */
+    StatisticsRegistry(size_t length, size_t width, unsigned int numShards = 0);
+
+    /**
+     * Destructor, stops the workers and releases every window.
+     */
+    ~StatisticsRegistry();
+
+    StatisticsRegistry(const StatisticsRegistry &) = delete;
+    StatisticsRegistry & operator = (const StatisticsRegistry &) = delete;
+
+    /**
+     * Adds a copy of the row to the key's window, creating the window if the key is new.
+     *
+     * @param key  the key of the window
+     * @param row  pointer to width() doubles to be added
+     */
+    void addRow(const T_key & key, const double * row);
+
+    /**
+     * Adds each of a batch of rows to the window of its key, in parallel across shards.
+     * The rows of each key are added in the order they appear in the batch.
+     *
+     * @param keys     pointer to numRows keys, one per row
+     * @param rows     pointer to numRows * width() doubles
+     * @param numRows  the number of rows to be added
+     */
+    void addRows(const T_key * keys, const double * rows, size_t numRows);
+
+    /**
+     * Returns the window of the key, for access to its rows or removeRows().
+     *
+     * @param key  the key of the window
+     * @return     pointer to the window, or nullptr if the key has no rows added yet
+     */
+    DynamicStatisticsBuffer * find(const T_key & key);
+    const DynamicStatisticsBuffer * find(const T_key & key) const;
+
+    /**
+     * Returns the number of keys (windows) in the registry.
+     *
+     * @return a size_t value of the number of keys
+     */
+    size_t numKeys() const;
+
+    /**
+     * Returns every key, in the order of the rows of the getMeans() and getStdDevs() matrices.
+     * The order only changes when keys are added.
+     *
+     * @return a new vector of the keys
+     */
+    std::vector<T_key> keys() const;
+
+    /**
+     * Writes the mean of each column of every key's window, one row of width() doubles per
+     * key in keys() order. A window emptied with removeRows() gives a row of NaNs.
+     *
+     * @param means  pointer to numKeys() * width() doubles to be overwritten
+     */
+    void getMeans(double * means) const;
+
+    /**
+     * Writes the standard deviation of each column of every key's window, one row of width()
+     * doubles per key in keys() order. A window emptied with removeRows() gives a row of NaNs.
+     *
+     * @param stdDevs  pointer to numKeys() * width() doubles to be overwritten
+     */
+    void getStdDevs(double * stdDevs) const;
+
+    /**
+     * Returns the maximum length (number of rows) of each window.
+     *
+     * @return a size_t value of the maximum number of rows.
+     */
+    size_t maxLength() const;
+
+    /**
+     * Returns the number of columns in each row.
+     *
+     * @return a size_t value of the width.
+     */
+    size_t width() const;
+
+    /**
+     * Returns the number of shards, which is also the number of workers ingesting in parallel.
+     *
+     * @return an unsigned int value of the number of shards
+     */
+    unsigned int numShards() const;
+
+private:
+    struct FreeDeleter {
+        void operator () (char * slab) const { free(slab); }
+    };
+
+    /**
+     * The keys hashing to one shard, their windows and the slabs holding them.
+     */
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<T_key, DynamicStatisticsBuffer *, T_hash> index;
+        /**
+         * The keys in the order their windows were created.
+         */
+        std::vector<T_key> keys;
+        std::vector<std::unique_ptr<char, FreeDeleter> > slabs;
+        /**
+         * The windows, in the same order, placed in the slabs. A deque, so creating one
+         * never moves the others.
+         */
+        std::deque<DynamicStatisticsBuffer> windows;
+        /**
+         * Number of windows placed in the last slab.
+         */
+        size_t slabUsed = 0;
+    };
+
+    /**
+     * Returns the shard a key belongs to.
+     */
+    unsigned int shardOf(const T_key & key) const;
+
+    /**
+     * Returns the key's window in the shard, creating it in the shard's pool if the key is new.
+     * The shard must be locked.
+     */
+    DynamicStatisticsBuffer & windowFor(Shard & shard, const T_key & key);
+
+    /**
+     * Runs job(worker) once for each worker, in parallel, and waits for them all. The calling
+     * thread is worker 0. Rethrows the first exception a worker threw.
+     */
+    void runOnWorkers(const std::function<void(unsigned int)> & job) const;
+
+    /**
+     * The loop of each worker thread other than worker 0.
+     */
+    void workerLoop(unsigned int worker) const;
+
+    /**
+     * Writes a statistic of every window, one shard per worker, all shards locked.
+     */
+    void getAll(double * out, void (DynamicStatisticsBuffer::*statistic)(double *) const) const;
+
+    size_t length_;
+    size_t width_;
+    /**
+     * Bytes between consecutive windows in a slab.
+     */
+    size_t windowBytes_;
+    /**
+     * Windows in each slab.
+     */
+    size_t windowsPerSlab_;
+    std::vector<std::unique_ptr<Shard> > shards_;
+    T_hash hash_;
+
+    /**
+     * Shard of each row of the batch addRows() is ingesting.
+     */
+    std::vector<uint32_t> rowShards_;
+    /**
+     * Indices of the batch's rows, grouped by shard: shard s has those from shardStarts_[s]
+     * up to shardStarts_[s + 1].
+     */
+    std::vector<size_t> shardRows_;
+    std::vector<size_t> shardStarts_;
+
+    /**
+     * Held for the whole of each parallel operation, so only one runs at a time.
+     */
+    mutable std::mutex runMutex_;
+    mutable std::mutex workMutex_;
+    mutable std::condition_variable workReady_;
+    mutable std::condition_variable workDone_;
+    /**
+     * The job being run, valid while workers are pending.
+     */
+    mutable const std::function<void(unsigned int)> * job_ = nullptr;
+    /**
+     * Incremented for each job, so a worker can tell a new job from the one it just ran.
+     */
+    mutable uint64_t generation_ = 0;
+    mutable unsigned int numPending_ = 0;
+    mutable std::exception_ptr error_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#include "StatisticsRegistry_impl.h"
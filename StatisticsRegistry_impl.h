@@ -0,0 +1,248 @@
+#include "StatisticsRegistry.h"
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+#include <new>
+
+#define STATISTICS_REGISTRY_SLAB_BYTES (1024 * 1024)
+#define STATISTICS_REGISTRY_ALIGNMENT 64
+
+template <class T_key, class T_hash>
+StatisticsRegistry<T_key, T_hash>::StatisticsRegistry(size_t length, size_t width, unsigned int numShards)
+        : length_(length), width_(width) {
+    assert(length > 0 && width > 0);
+    if (numShards == 0)
+        numShards = std::max(1u, std::thread::hardware_concurrency());
+    this->windowBytes_ = DynamicStatisticsBuffer::alignedBytes(length, width);
+    this->windowsPerSlab_ = std::max<size_t>(1, STATISTICS_REGISTRY_SLAB_BYTES / this->windowBytes_);
+    for (unsigned int s = 0; s < numShards; s++)
+        this->shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+    for (unsigned int w = 1; w < numShards; w++)
+        this->workers_.push_back(std::thread(&StatisticsRegistry::workerLoop, this, w));
+}
+
+template <class T_key, class T_hash>
+StatisticsRegistry<T_key, T_hash>::~StatisticsRegistry() {
+    {
+        std::lock_guard<std::mutex> lock(this->workMutex_);
+        this->stop_ = true;
+        this->workReady_.notify_all();
+    }
+    for (auto &worker: this->workers_)
+        worker.join();
+}
+
+template <class T_key, class T_hash>
+unsigned int StatisticsRegistry<T_key, T_hash>::shardOf(const T_key &key) const {
+    // Mixed first, since the shard index and the index's bucket would otherwise both come
+    // from the low bits, leaving most buckets of each shard empty
+    uint64_t h = this->hash_(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h % this->shards_.size();
+}
+
+template <class T_key, class T_hash>
+DynamicStatisticsBuffer & StatisticsRegistry<T_key, T_hash>::windowFor(Shard &shard, const T_key &key) {
+    auto found = shard.index.find(key);
+    if (found != shard.index.end())
+        return *found->second;
+
+    if (shard.slabs.empty() || shard.slabUsed == this->windowsPerSlab_) {
+        void *slab = nullptr;
+        if (posix_memalign(&slab, STATISTICS_REGISTRY_ALIGNMENT, this->windowsPerSlab_ * this->windowBytes_) != 0)
+            throw std::bad_alloc();
+        shard.slabs.push_back(std::unique_ptr<char, FreeDeleter>(static_cast<char *>(slab)));
+        shard.slabUsed = 0;
+    }
+    char *arena = shard.slabs.back().get() + shard.slabUsed * this->windowBytes_;
+    shard.windows.emplace_back(this->length_, this->width_, arena, this->windowBytes_);
+    shard.slabUsed++;
+    shard.keys.push_back(key);
+    DynamicStatisticsBuffer &window = shard.windows.back();
+    shard.index.insert(std::make_pair(key, &window));
+    return window;
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::addRow(const T_key &key, const double *row) {
+    Shard &shard = *this->shards_[this->shardOf(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    this->windowFor(shard, key).addRow(row);
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::addRows(const T_key *keys, const double *rows, size_t numRows) {
+    std::lock_guard<std::mutex> runLock(this->runMutex_);
+    const unsigned int numShards = this->shards_.size();
+    this->rowShards_.resize(numRows);
+    this->shardRows_.resize(numRows);
+    this->shardStarts_.assign(numShards + 1, 0);
+
+    // Hashing counts the rows of each shard, the counts give where each shard's rows start, and
+    // the rows are then listed shard by shard, each shard's in batch order
+    for (size_t r = 0; r < numRows; r++) {
+        this->rowShards_[r] = this->shardOf(keys[r]);
+        this->shardStarts_[this->rowShards_[r] + 1]++;
+    }
+    for (unsigned int s = 0; s < numShards; s++)
+        this->shardStarts_[s + 1] += this->shardStarts_[s];
+    std::vector<size_t> next(this->shardStarts_.begin(), this->shardStarts_.end() - 1);
+    for (size_t r = 0; r < numRows; r++)
+        this->shardRows_[next[this->rowShards_[r]]++] = r;
+
+    // Then each worker adds the rows of its own shard, holding the shard's lock for the whole batch
+    this->runOnWorkers([&](unsigned int worker) {
+        Shard &shard = *this->shards_[worker];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const T_key *lastKey = nullptr;
+        DynamicStatisticsBuffer *window = nullptr;
+        for (size_t i = this->shardStarts_[worker]; i < this->shardStarts_[worker + 1]; i++) {
+            const size_t r = this->shardRows_[i];
+            // Runs of rows for the same key need only one lookup
+            if (lastKey == nullptr || !(keys[r] == *lastKey))
+                window = &this->windowFor(shard, keys[r]);
+            lastKey = &keys[r];
+            window->addRow(rows + r * this->width_);
+        }
+    });
+}
+
+template <class T_key, class T_hash>
+DynamicStatisticsBuffer * StatisticsRegistry<T_key, T_hash>::find(const T_key &key) {
+    Shard &shard = *this->shards_[this->shardOf(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    return found == shard.index.end() ? nullptr : found->second;
+}
+
+template <class T_key, class T_hash>
+const DynamicStatisticsBuffer * StatisticsRegistry<T_key, T_hash>::find(const T_key &key) const {
+    return const_cast<StatisticsRegistry *>(this)->find(key);
+}
+
+template <class T_key, class T_hash>
+size_t StatisticsRegistry<T_key, T_hash>::numKeys() const {
+    size_t numKeys = 0;
+    for (auto &shard: this->shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        numKeys += shard->keys.size();
+    }
+    return numKeys;
+}
+
+template <class T_key, class T_hash>
+std::vector<T_key> StatisticsRegistry<T_key, T_hash>::keys() const {
+    std::vector<T_key> keys;
+    for (auto &shard: this->shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        keys.insert(keys.end(), shard->keys.begin(), shard->keys.end());
+    }
+    return keys;
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::getMeans(double *means) const {
+    this->getAll(means, &DynamicStatisticsBuffer::getMean);
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::getStdDevs(double *stdDevs) const {
+    this->getAll(stdDevs, &DynamicStatisticsBuffer::getStdDev);
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::getAll(double *out,
+                                              void (DynamicStatisticsBuffer::*statistic)(double *) const) const {
+    std::lock_guard<std::mutex> runLock(this->runMutex_);
+    // Every shard is locked first, so the offsets stay valid and keys() order is kept
+    std::vector<std::unique_lock<std::mutex> > locks;
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (auto &shard: this->shards_) {
+        locks.push_back(std::unique_lock<std::mutex>(shard->mutex));
+        offsets.push_back(offset);
+        offset += shard->windows.size() * this->width_;
+    }
+
+    this->runOnWorkers([&](unsigned int worker) {
+        double *row = out + offsets[worker];
+        for (const DynamicStatisticsBuffer &window: this->shards_[worker]->windows) {
+            if (window.isEmpty())
+                std::fill(row, row + this->width_, std::numeric_limits<double>::quiet_NaN());
+            else
+                (window.*statistic)(row);
+            row += this->width_;
+        }
+    });
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::runOnWorkers(const std::function<void(unsigned int)> &job) const {
+    {
+        std::lock_guard<std::mutex> lock(this->workMutex_);
+        this->job_ = &job;
+        this->numPending_ = this->workers_.size();
+        this->error_ = nullptr;
+        this->generation_++;
+        this->workReady_.notify_all();
+    }
+
+    std::exception_ptr error;
+    try {
+        job(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(this->workMutex_);
+    this->workDone_.wait(lock, [this]() { return this->numPending_ == 0; });
+    this->job_ = nullptr;
+    if (error == nullptr)
+        error = this->error_;
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
+template <class T_key, class T_hash>
+void StatisticsRegistry<T_key, T_hash>::workerLoop(unsigned int worker) const {
+    uint64_t lastGeneration = 0;
+    std::unique_lock<std::mutex> lock(this->workMutex_);
+    while (true) {
+        this->workReady_.wait(lock, [&]() { return this->stop_ || this->generation_ != lastGeneration; });
+        if (this->stop_)
+            return;
+        lastGeneration = this->generation_;
+        const std::function<void(unsigned int)> &job = *this->job_;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            job(worker);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error != nullptr && this->error_ == nullptr)
+            this->error_ = error;
+        if (--this->numPending_ == 0)
+            this->workDone_.notify_all();
+    }
+}
+
+template <class T_key, class T_hash>
+size_t StatisticsRegistry<T_key, T_hash>::maxLength() const {
+    return this->length_;
+}
+
+template <class T_key, class T_hash>
+size_t StatisticsRegistry<T_key, T_hash>::width() const {
+    return this->width_;
+}
+
+template <class T_key, class T_hash>
+unsigned int StatisticsRegistry<T_key, T_hash>::numShards() const {
+    return this->shards_.size();
+}
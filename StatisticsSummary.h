@@ -0,0 +1,126 @@
+/* Header for StatisticsSummary class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+#include "DataContainer.h"
+
+/**
+ * A copy of the incremental statistics state of a StatisticsBuffer (the location
+ * parameter K, the shifted-data sums Ex and Ex2, and the number of rows), without
+ * the rows themselves. Computes the same mean and standard deviation as the buffer
+ * it was taken from.
+ *
+ * Summaries of disjoint sets of rows can be merged, giving the summary of all of them,
+ * so one stream split across threads or hosts can be combined without the rows. A
+ * summary serializes to a fixed-size, byte-order independent record of
+ * serializedBytes bytes for sending to an aggregator.
+ *
+ * Example: StatisticsSummary<4> summary = statBuffer.getSummary(); summary.merge(other.getSummary());
+ */
+template <size_t T_width>
+class StatisticsSummary {
+public:
+    /**
+     * Constructor, initializes an empty summary.
+     */
+    StatisticsSummary();
+
+    /**
+     * Returns the mean of each column as a DataContainer.
+     * Asserts that the summary is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the standard deviation of each column as a DataContainer.
+     * Asserts that the summary is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Adds the rows summarized by other to this summary, using the parallel combination of
+     * the shifted sums: other's sums are moved from its K to this K, so the two may have
+     * different anchors. This K is kept (other's, if this summary is empty).
+     *
+     * The merged statistics equal those of one buffer holding all the rows up to rounding,
+     * not bit for bit, since the sums are added in a different order.
+     *
+     * @param other  the summary of rows disjoint from this summary's
+     */
+    void merge(const StatisticsSummary & other);
+
+    /**
+     * Returns the summary as serializedBytes bytes: a magic number, format version and
+     * width, then the number of rows and K, Ex and Ex2, all little-endian.
+     *
+     * @return a new vector of the serialized summary
+     */
+    std::vector<unsigned char> serialize() const;
+
+    /**
+     * Reads a summary written by serialize(). Throws std::runtime_error if the data is not
+     * a serialized summary of this version and width.
+     *
+     * @param data      pointer to the serialized summary
+     * @param numBytes  the number of bytes at data
+     * @return          a new StatisticsSummary equal to the one serialized
+     */
+    static StatisticsSummary deserialize(const unsigned char * data, size_t numBytes);
+
+    /**
+     * Size of a serialized summary in bytes.
+     */
+    static const size_t serializedBytes = 16 + 8 * (1 + 3 * T_width);
+
+    /**
+     * Returns the number of rows summarized.
+     *
+     * @return a size_t value of the number of rows.
+     */
+    size_t currentLength() const;
+
+    /**
+     * Returns true if the summary covers no rows, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+    /**
+     * Location parameter the shifted-data sums are taken relative to.
+     */
+    DataContainer<T_width> K;
+    /**
+     * Sum of the differences between each row and K.
+     */
+    DataContainer<T_width> Ex;
+    /**
+     * Sum of the squared differences between each row and K.
+     */
+    DataContainer<T_width> Ex2;
+    /**
+     * Number of rows summarized, 64-bit like its serialized field, so merged counts and
+     * counts read from other hosts are not truncated.
+     */
+    uint64_t numRows;
+
+private:
+    /**
+     * The first bytes of every serialized summary.
+     */
+    static constexpr char magic[5] = "STSM";
+    /**
+     * The serialized format's version, bumped when its layout changes.
+     */
+    static constexpr uint32_t formatVersion = 1;
+};
+
+#include "StatisticsSummary_impl.h"
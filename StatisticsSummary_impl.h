@@ -0,0 +1,126 @@
+#include "StatisticsSummary.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Fixed-width little-endian fields, so a summary reads back the same on any host
+namespace StatisticsSummaryDetail {
+
+inline void putUint(unsigned char *&out, uint64_t value, unsigned int numBytes) {
+    for (unsigned int b = 0; b < numBytes; b++)
+        *out++ = static_cast<unsigned char>(value >> (8 * b));
+}
+
+inline uint64_t getUint(const unsigned char *&in, unsigned int numBytes) {
+    uint64_t value = 0;
+    for (unsigned int b = 0; b < numBytes; b++)
+        value |= static_cast<uint64_t>(*in++) << (8 * b);
+    return value;
+}
+
+template <size_t T_width>
+void putDoubles(unsigned char *&out, const DataContainer<T_width> &values) {
+    for (double value: values) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putUint(out, bits, 8);
+    }
+}
+
+template <size_t T_width>
+void getDoubles(const unsigned char *&in, DataContainer<T_width> &values) {
+    for (double &value: values) {
+        uint64_t bits = getUint(in, 8);
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+}
+
+} // namespace StatisticsSummaryDetail
+
+template <size_t T_width>
+const size_t StatisticsSummary<T_width>::serializedBytes;
+
+template <size_t T_width>
+constexpr char StatisticsSummary<T_width>::magic[5];
+
+template <size_t T_width>
+constexpr uint32_t StatisticsSummary<T_width>::formatVersion;
+
+template <size_t T_width>
+StatisticsSummary<T_width>::StatisticsSummary() : numRows(0) {
+    this->K.fill(0);
+    this->Ex.fill(0);
+    this->Ex2.fill(0);
+}
+
+template <size_t T_width>
+const DataContainer<T_width> StatisticsSummary<T_width>::getMean() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> mean;
+    ColumnKernels::mean(mean.data(), this->K.data(), this->Ex.data(), this->numRows, T_width);
+    return mean;
+}
+
+template <size_t T_width>
+const DataContainer<T_width> StatisticsSummary<T_width>::getStdDev() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> stdDev;
+    ColumnKernels::stdDev(stdDev.data(), this->Ex.data(), this->Ex2.data(), this->numRows, T_width);
+    return stdDev;
+}
+
+template <size_t T_width>
+void StatisticsSummary<T_width>::merge(const StatisticsSummary &other) {
+    if (other.isEmpty())
+        return;
+    if (this->isEmpty()) {
+        *this = other;
+        return;
+    }
+    ColumnKernels::mergeShifted(this->K.data(), this->Ex.data(), this->Ex2.data(), other.K.data(), other.Ex.data(),
+                                other.Ex2.data(), other.numRows, T_width);
+    assert(this->numRows + other.numRows > this->numRows);
+    this->numRows += other.numRows;
+}
+
+template <size_t T_width>
+std::vector<unsigned char> StatisticsSummary<T_width>::serialize() const {
+    using namespace StatisticsSummaryDetail;
+    std::vector<unsigned char> data(serializedBytes);
+    unsigned char *out = data.data();
+    std::memcpy(out, magic, 4);
+    out += 4;
+    putUint(out, formatVersion, 4);
+    putUint(out, T_width, 8);
+    putUint(out, this->numRows, 8);
+    putDoubles(out, this->K);
+    putDoubles(out, this->Ex);
+    putDoubles(out, this->Ex2);
+    return data;
+}
+
+template <size_t T_width>
+StatisticsSummary<T_width> StatisticsSummary<T_width>::deserialize(const unsigned char *data, size_t numBytes) {
+    using namespace StatisticsSummaryDetail;
+    if (numBytes != serializedBytes || std::memcmp(data, magic, 4) != 0)
+        throw std::runtime_error("not a serialized summary of width " + std::to_string(T_width));
+    const unsigned char *in = data + 4;
+    if (getUint(in, 4) != formatVersion || getUint(in, 8) != T_width)
+        throw std::runtime_error("serialized summary has a different version or width");
+    StatisticsSummary summary;
+    summary.numRows = getUint(in, 8);
+    getDoubles(in, summary.K);
+    getDoubles(in, summary.Ex);
+    getDoubles(in, summary.Ex2);
+    return summary;
+}
+
+template <size_t T_width>
+size_t StatisticsSummary<T_width>::currentLength() const {
+    return this->numRows;
+}
+
+template <size_t T_width>
+bool StatisticsSummary<T_width>::isEmpty() const {
+    return this->numRows == 0;
+}
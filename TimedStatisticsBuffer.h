@@ -0,0 +1,228 @@
+/* Header for TimedStatisticsBuffer class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+#include "DataContainer.h"
+#include "RingView.h"
+#include "StatisticsSummary.h"
+
+/**
+ * A StatisticsBuffer whose window is a span of time rather than a number of rows: each
+ * row is added with a timestamp, and rows more than the horizon older than the newest
+ * are evicted, so a bursty feed gets the statistics of, say, the last 30 seconds
+ * however many rows arrived in them.
+ *
+ * Timestamps are integers in whatever unit the caller chooses (nanoseconds, ticks) and
+ * must not decrease from one row to the next. Since they are sorted, the rows to evict
+ * are found by binary search, not by scanning the window, and removed from the stats in
+ * one fused pass, so adding a row costs O(T_width) amortized however many it evicts.
+ *
+ * The rows live in a ring whose capacity is a power of two. When a burst fills it, it
+ * doubles (copying the rows once, so still O(T_width) per row amortized), up to maxRows
+ * if one is given; beyond that the oldest row is evicted for each new one, as in
+ * StatisticsBuffer, and the window covers less than the horizon until the burst passes.
+ *
+ * K is re-centered once per pass around the ring, as in StatisticsBuffer, and the sums
+ * are reset whenever the window empties, so gaps in the feed start it afresh.
+ *
+ * Example: TimedStatisticsBuffer<4> statBuffer(30000000000); statBuffer.addRow(nowNanoseconds, row);
+ */
+template <size_t T_width>
+class TimedStatisticsBuffer {
+public:
+    /**
+     * Type of the row timestamps.
+     */
+    typedef int64_t Timestamp;
+
+    /**
+     * Random-access iterator over the rows, oldest first.
+     */
+    typedef typename RingView<DataContainer<T_width> >::const_iterator const_iterator;
+
+    /**
+     * Constructor, initializes internal K_, Ex_, and Ex2_ variables.
+     *
+     * @param horizon          rows older than the newest by more than this are evicted
+     * @param maxRows          the most rows kept whatever their age, or 0 for no limit
+     * @param initialCapacity  rows the ring holds before it first grows, rounded up to a power of two
+     */
+    explicit TimedStatisticsBuffer(Timestamp horizon, size_t maxRows = 0, size_t initialCapacity = 64);
+
+    /**
+     * Adds a copy of the input row, evicting every row with a timestamp before
+     * timestamp - horizon(), and the oldest row if maxRows are already kept.
+     * The timestamp must not be before that of the latest row.
+     *
+     * @param timestamp  the time of the row
+     * @param data       the DataContainer instance to be added
+     */
+    void addRow(Timestamp timestamp, const DataContainer<T_width> & data);
+
+    /**
+     * Removes every row with a timestamp before cutoff, in one pass over the stats.
+     * Useful to age the window while no rows arrive.
+     *
+     * @param cutoff  the earliest timestamp kept
+     */
+    void removeOlderThan(Timestamp cutoff);
+
+    /**
+     * Removes the oldest numRowsToRemove rows. If there are less rows than specified,
+     * it stops after removing what it can.
+     */
+    void removeRows(unsigned int numRowsToRemove);
+
+    /**
+     * Returns the row specified by the index, in chronological order from oldest to newest.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @param index  the instance to be returned
+     * @return       a const reference to the row, valid until it is evicted or the ring grows
+     */
+    const DataContainer<T_width> & getRow(unsigned int index) const;
+
+    /**
+     * Returns the timestamp of the row specified by the index, as for getRow().
+     *
+     * @param index  the row whose timestamp is to be returned
+     * @return       the timestamp the row was added with
+     */
+    Timestamp getTimestamp(unsigned int index) const;
+
+    /**
+     * Returns the row most recently added. Equivalent to getRow(currentLength() - 1).
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return       a const reference to the row, valid until it is evicted or the ring grows
+     */
+    const DataContainer<T_width> & getLatestRow() const;
+
+    /**
+     * Returns the rows, oldest first, as at most two contiguous spans of the ring, without
+     * copying. The view is invalidated when rows are added or removed.
+     *
+     * @return a RingView of the rows
+     */
+    RingView<DataContainer<T_width> > view() const;
+
+    /**
+     * Iterators over the rows, oldest first, as in view().
+     */
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * Returns the current mean of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the mean of each column.
+     */
+    const DataContainer<T_width> getMean() const;
+
+    /**
+     * Returns the current standard deviation of each column.
+     * Asserts that the current instance is not empty! Avoid this by checking isEmpty() yourself.
+     *
+     * @return a new DataContainer containing the standard deviation of each column.
+     */
+    const DataContainer<T_width> getStdDev() const;
+
+    /**
+     * Returns a copy of the current statistics state (K, Ex, Ex2 and the number of rows).
+     *
+     * @return a new StatisticsSummary of the current rows
+     */
+    const StatisticsSummary<T_width> getSummary() const;
+
+    /**
+     * Moves the internal location parameter of each column to its current mean, as
+     * StatisticsBuffer::recenter() does. Called automatically once per pass around the ring.
+     */
+    void recenter();
+
+    /**
+     * Returns the horizon the window covers.
+     *
+     * @return the horizon, in the units of the timestamps
+     */
+    Timestamp horizon() const;
+
+    /**
+     * Returns the most rows kept, or 0 if there is no limit.
+     *
+     * @return a size_t value of the maximum number of rows.
+     */
+    size_t maxLength() const;
+
+    /**
+     * Returns the number of rows the ring can hold before it next grows.
+     *
+     * @return a size_t value of the capacity.
+     */
+    size_t capacity() const;
+
+    /**
+     * Returns the current length (number of rows) of the buffer.
+     *
+     * @return a size_t value of the current number of rows.
+     */
+    size_t currentLength() const;
+
+    /**
+     * Returns true if the buffer no longer contains any entries, otherwise false.
+     *
+     * @return boolean result of test
+     */
+    bool isEmpty() const;
+
+private:
+    /**
+     * Removes the oldest numRemoved rows from the stats, in at most two contiguous passes.
+     */
+    void evictOldest(size_t numRemoved);
+
+    /**
+     * Doubles the capacity of the ring, moving the rows to the start of the new one.
+     */
+    void grow();
+
+    Timestamp horizon_;
+    size_t maxRows_;
+    /**
+     * The ring of rows and their timestamps, a power of two long.
+     */
+    std::vector<DataContainer<T_width> > rows_;
+    std::vector<Timestamp> timestamps_;
+    /**
+     * Capacity - 1, for wrapping indices.
+     */
+    size_t mask_;
+    /**
+     * Index of the ring corresponding to the oldest entry.
+     */
+    size_t headIndex_ = 0;
+    /**
+     * Current length of the buffer.
+     */
+    size_t numRows_ = 0;
+
+    /**
+     * Internal "location parameter", used to ensure subtractions are not too far from the mean.
+     */
+    DataContainer<T_width> K_;
+    /**
+     * Internal parameter containing the difference between the datapoint and the location parameter
+     */
+    DataContainer<T_width> Ex_;
+    /**
+     * Internal parameter containing the square of Ex_
+     */
+    DataContainer<T_width> Ex2_;
+};
+
+#include "TimedStatisticsBuffer_impl.h"
@@ -0,0 +1,201 @@
+#include "TimedStatisticsBuffer.h"
+#include <algorithm>
+#include "ColumnKernels.h"
+
+template <size_t T_width>
+TimedStatisticsBuffer<T_width>::TimedStatisticsBuffer(Timestamp horizon, size_t maxRows, size_t initialCapacity)
+        : horizon_(horizon), maxRows_(maxRows) {
+    assert(horizon >= 0);
+    size_t capacity = 1;
+    while (capacity < initialCapacity && (maxRows == 0 || capacity < maxRows))
+        capacity *= 2;
+    this->rows_.resize(capacity);
+    this->timestamps_.resize(capacity);
+    this->mask_ = capacity - 1;
+    this->K_.fill(0);
+    this->Ex_.fill(0);
+    this->Ex2_.fill(0);
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::addRow(Timestamp timestamp, const DataContainer<T_width> &data) {
+    assert(this->isEmpty() || timestamp >= this->timestamps_[(this->headIndex_ + this->numRows_ - 1) & this->mask_]);
+    this->removeOlderThan(timestamp - this->horizon_);
+
+    if (this->maxRows_ != 0 && this->numRows_ == this->maxRows_)
+        this->evictOldest(1);
+    else if (this->numRows_ == this->rows_.size())
+        this->grow();
+
+    if (this->numRows_ == 0) {
+        // K must be initialized to a value within the sample range.
+        // Close to mean is preferable, but not required.
+        this->K_ = data;
+    }
+
+    const size_t tail = (this->headIndex_ + this->numRows_) & this->mask_;
+    ColumnKernels::addShifted(this->Ex_.data(), this->Ex2_.data(), data.data(), this->K_.data(), T_width);
+    this->rows_[tail] = data;
+    this->timestamps_[tail] = timestamp;
+    this->numRows_++;
+
+    if (tail == this->mask_)
+        this->recenter();
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::removeOlderThan(Timestamp cutoff) {
+    // Nothing to evict is by far the usual case, and needs only the head checked
+    if (this->numRows_ == 0 || this->timestamps_[this->headIndex_] >= cutoff)
+        return;
+
+    // The timestamps are sorted oldest first, so binary search for the first one kept
+    size_t low = 1, high = this->numRows_;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (this->timestamps_[(this->headIndex_ + middle) & this->mask_] < cutoff)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    this->evictOldest(low);
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::removeRows(unsigned int numRowsToRemove) {
+    assert(!this->isEmpty());
+    this->evictOldest(std::min<size_t>(numRowsToRemove, this->numRows_));
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::evictOldest(size_t numRemoved) {
+    // The removed rows run from the head, wrapping around the end of the ring at most once
+    const size_t firstLength = std::min(numRemoved, this->rows_.size() - this->headIndex_);
+    ColumnKernels::removeShiftedRows(this->Ex_.data(), this->Ex2_.data(), this->rows_[this->headIndex_].data(),
+                                     firstLength, this->K_.data(), T_width);
+    ColumnKernels::removeShiftedRows(this->Ex_.data(), this->Ex2_.data(), this->rows_[0].data(),
+                                     numRemoved - firstLength, this->K_.data(), T_width);
+    this->numRows_ -= numRemoved;
+    this->headIndex_ = (this->headIndex_ + numRemoved) & this->mask_;
+
+    if (this->numRows_ == 0) {
+        // Drop the rounding left over from the removed rows; the next row picks a new K
+        this->Ex_.fill(0);
+        this->Ex2_.fill(0);
+    }
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::grow() {
+    const size_t capacity = this->rows_.size();
+    std::vector<DataContainer<T_width> > rows(2 * capacity);
+    std::vector<Timestamp> timestamps(2 * capacity);
+    const size_t firstLength = std::min(this->numRows_, capacity - this->headIndex_);
+    std::copy(this->rows_.begin() + this->headIndex_, this->rows_.begin() + this->headIndex_ + firstLength, rows.begin());
+    std::copy(this->rows_.begin(), this->rows_.begin() + (this->numRows_ - firstLength), rows.begin() + firstLength);
+    std::copy(this->timestamps_.begin() + this->headIndex_,
+              this->timestamps_.begin() + this->headIndex_ + firstLength, timestamps.begin());
+    std::copy(this->timestamps_.begin(), this->timestamps_.begin() + (this->numRows_ - firstLength),
+              timestamps.begin() + firstLength);
+    this->rows_.swap(rows);
+    this->timestamps_.swap(timestamps);
+    this->mask_ = 2 * capacity - 1;
+    this->headIndex_ = 0;
+}
+
+template <size_t T_width>
+const DataContainer<T_width> & TimedStatisticsBuffer<T_width>::getRow(unsigned int index) const {
+    assert(!this->isEmpty());
+    return this->rows_[(this->headIndex_ + index) & this->mask_];
+}
+
+template <size_t T_width>
+typename TimedStatisticsBuffer<T_width>::Timestamp TimedStatisticsBuffer<T_width>::getTimestamp(unsigned int index) const {
+    assert(!this->isEmpty());
+    return this->timestamps_[(this->headIndex_ + index) & this->mask_];
+}
+
+template <size_t T_width>
+const DataContainer<T_width> & TimedStatisticsBuffer<T_width>::getLatestRow() const {
+    assert(!this->isEmpty());
+    return this->rows_[(this->headIndex_ + this->numRows_ - 1) & this->mask_];
+}
+
+template <size_t T_width>
+RingView<DataContainer<T_width> > TimedStatisticsBuffer<T_width>::view() const {
+    const DataContainer<T_width> *data = this->rows_.data();
+    RingView<DataContainer<T_width> > view;
+    view.firstSize = std::min(this->numRows_, this->rows_.size() - this->headIndex_);
+    view.first = view.firstSize ? data + this->headIndex_ : nullptr;
+    view.secondSize = this->numRows_ - view.firstSize;
+    view.second = view.secondSize ? data : nullptr;
+    return view;
+}
+
+template <size_t T_width>
+typename TimedStatisticsBuffer<T_width>::const_iterator TimedStatisticsBuffer<T_width>::begin() const {
+    return this->view().begin();
+}
+
+template <size_t T_width>
+typename TimedStatisticsBuffer<T_width>::const_iterator TimedStatisticsBuffer<T_width>::end() const {
+    return this->view().end();
+}
+
+template <size_t T_width>
+const DataContainer<T_width> TimedStatisticsBuffer<T_width>::getMean() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> mean;
+    ColumnKernels::mean(mean.data(), this->K_.data(), this->Ex_.data(), this->numRows_, T_width);
+    return mean;
+}
+
+template <size_t T_width>
+const DataContainer<T_width> TimedStatisticsBuffer<T_width>::getStdDev() const {
+    assert(!this->isEmpty());
+    DataContainer<T_width> stdDev;
+    ColumnKernels::stdDev(stdDev.data(), this->Ex_.data(), this->Ex2_.data(), this->numRows_, T_width);
+    return stdDev;
+}
+
+template <size_t T_width>
+const StatisticsSummary<T_width> TimedStatisticsBuffer<T_width>::getSummary() const {
+    StatisticsSummary<T_width> summary;
+    summary.K = this->K_;
+    summary.Ex = this->Ex_;
+    summary.Ex2 = this->Ex2_;
+    summary.numRows = this->numRows_;
+    return summary;
+}
+
+template <size_t T_width>
+void TimedStatisticsBuffer<T_width>::recenter() {
+    if (this->numRows_ == 0)
+        return;
+    ColumnKernels::recenter(this->K_.data(), this->Ex_.data(), this->Ex2_.data(), this->numRows_, T_width);
+}
+
+template <size_t T_width>
+typename TimedStatisticsBuffer<T_width>::Timestamp TimedStatisticsBuffer<T_width>::horizon() const {
+    return this->horizon_;
+}
+
+template <size_t T_width>
+size_t TimedStatisticsBuffer<T_width>::maxLength() const {
+    return this->maxRows_;
+}
+
+template <size_t T_width>
+size_t TimedStatisticsBuffer<T_width>::capacity() const {
+    return this->rows_.size();
+}
+
+template <size_t T_width>
+size_t TimedStatisticsBuffer<T_width>::currentLength() const {
+    return this->numRows_;
+}
+
+template <size_t T_width>
+bool TimedStatisticsBuffer<T_width>::isEmpty() const {
+    return this->numRows_ == 0;
+}
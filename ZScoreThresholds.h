@@ -0,0 +1,71 @@
+/* Header for ZScoreThresholds class. Unfortunately, templated functions must be
+ * visible to the compiler, so implementations of the functions are included
+ * directly by this header.
+ */
+#pragma once
+#include <assert.h>
+#include <bitset>
+#include "DataContainer.h"
+
+/**
+ * Flags for the columns of a row, bit i for column i.
+ */
+template <size_t T_width>
+using ColumnMask = std::bitset<T_width>;
+
+/**
+ * Per-column z-score thresholds, against which StatisticsBuffer::addRowScored() checks each
+ * row: a column is flagged when the row's value lies more than its threshold of standard
+ * deviations from the mean. The thresholds are kept squared, so that a row can be checked
+ * without a square root or a division per column (see ColumnKernels::addShiftedScored).
+ *
+ * Example: ZScoreThresholds<16> thresholds(4.0); thresholds.setThreshold(0, 6.0);
+ */
+template <size_t T_width>
+class ZScoreThresholds {
+public:
+    /**
+     * Constructor, giving every column the same threshold.
+     *
+     * @param threshold  the z-score above which a column is flagged, not negative
+     */
+    explicit ZScoreThresholds(double threshold);
+
+    /**
+     * Constructor, giving each column its own threshold.
+     *
+     * @param thresholds  the z-score above which each column is flagged, none negative
+     */
+    explicit ZScoreThresholds(const DataContainer<T_width> & thresholds);
+
+    /**
+     * Sets the threshold of one column.
+     *
+     * @param column     the column, less than T_width
+     * @param threshold  the z-score above which the column is flagged, not negative
+     */
+    void setThreshold(unsigned int column, double threshold);
+
+    /**
+     * Returns the threshold of one column.
+     *
+     * @param column  the column, less than T_width
+     * @return        the z-score above which the column is flagged
+     */
+    double getThreshold(unsigned int column) const;
+
+    /**
+     * Returns the square of each column's threshold.
+     *
+     * @return a reference to the squared thresholds
+     */
+    const DataContainer<T_width> & getSquaredThresholds() const;
+
+private:
+    /**
+     * The square of each column's threshold.
+     */
+    DataContainer<T_width> squared_;
+};
+
+#include "ZScoreThresholds_impl.h"
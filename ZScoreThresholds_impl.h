@@ -0,0 +1,32 @@
+#include "ZScoreThresholds.h"
+#include <cmath>
+
+template <size_t T_width>
+ZScoreThresholds<T_width>::ZScoreThresholds(double threshold) {
+    assert(threshold >= 0);
+    this->squared_.fill(threshold * threshold);
+}
+
+template <size_t T_width>
+ZScoreThresholds<T_width>::ZScoreThresholds(const DataContainer<T_width> &thresholds) {
+    for (unsigned int i = 0; i < T_width; i++)
+        this->setThreshold(i, thresholds[i]);
+}
+
+template <size_t T_width>
+void ZScoreThresholds<T_width>::setThreshold(unsigned int column, double threshold) {
+    assert(column < T_width);
+    assert(threshold >= 0);
+    this->squared_[column] = threshold * threshold;
+}
+
+template <size_t T_width>
+double ZScoreThresholds<T_width>::getThreshold(unsigned int column) const {
+    assert(column < T_width);
+    return std::sqrt(this->squared_[column]);
+}
+
+template <size_t T_width>
+const DataContainer<T_width> & ZScoreThresholds<T_width>::getSquaredThresholds() const {
+    return this->squared_;
+}
@@ -0,0 +1,1111 @@
+/* Informal benchmark program for DataContainer and StatisticsBuffer classes.
+ * Build with "make bench"; results are printed to stdout.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+// Custom classes
+#include "BufferInstrumentation.h"
+#include "ColumnKernels.h"
+#include "ColumnarStatisticsBuffer.h"
+#include "ConcurrentStatisticsBuffer.h"
+#include "DataContainer.h"
+#include "DynamicStatisticsBuffer.h"
+#include "ExponentialStatistics.h"
+#include "PersistentStatisticsBuffer.h"
+#include "RowLoader.h"
+#include "SlidingCovariance.h"
+#include "SlidingExtrema.h"
+#include "SlidingHistogram.h"
+#include "SlidingQuantiles.h"
+#include "StatisticsBuffer.h"
+#include "StatisticsPyramid.h"
+#include "StatisticsRegistry.h"
+#include "TimedStatisticsBuffer.h"
+
+#define BENCH_BUFFER_LENGTH 1024
+#define BENCH_NUM_ROWS 200000
+
+typedef std::chrono::steady_clock BenchClock;
+
+double secondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Prevents the compiler from optimizing away results that are never used
+volatile double benchSink;
+
+template <class T_expression, size_t T_width>
+void consume(const DataExpression<T_expression, T_width> &data) {
+    benchSink = data.self()[0];
+}
+
+template <size_t T_width>
+std::vector<DataContainer<T_width> > makeRows(size_t numRows) {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.4, 0.5);
+    std::vector<DataContainer<T_width> > rows(numRows);
+    for (auto &row: rows)
+        for (auto &r: row)
+            r = distribution(generator);
+    return rows;
+}
+
+// Rows per second through StatisticsBuffer::addRow, with the buffer full for all but the first rows
+template <size_t T_width>
+void addRowBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double elapsed = secondsSince(start);
+    consume(statBuffer->getStdDev());
+
+    std::cout << "  addRow width " << std::setw(3) << T_width << ": "
+              << std::setw(12) << std::fixed << std::setprecision(0) << BENCH_NUM_ROWS / elapsed
+              << " rows/sec" << std::endl;
+}
+
+// Rows per second through StatisticsBuffer::addRows, in blocks of T_block rows
+template <size_t T_width, size_t T_block>
+void addRowsBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i += T_block)
+        statBuffer->addRows(&rows[i % rows.size()], T_block);
+    double elapsed = secondsSince(start);
+    consume(statBuffer->getStdDev());
+
+    std::cout << "  addRows/" << T_block << " width " << std::setw(3) << T_width << ": "
+              << std::setw(8) << std::fixed << std::setprecision(0) << BENCH_NUM_ROWS / elapsed
+              << " rows/sec" << std::endl;
+}
+
+// Rows per second through a chain of DataContainer operators, as in a naive variance update
+template <size_t T_width>
+void operatorBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    DataContainer<T_width> mean, accumulator;
+    mean.fill(0.4);
+    accumulator.fill(0);
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        accumulator += (rows[i % rows.size()] - mean).Pow(2) / 2;
+    }
+    double elapsed = secondsSince(start);
+    consume(accumulator.Sqrt());
+
+    std::cout << "  operators width " << std::setw(3) << T_width << ": "
+              << std::setw(9) << std::fixed << std::setprecision(0) << BENCH_NUM_ROWS / elapsed
+              << " rows/sec" << std::endl;
+}
+
+void ColumnKernelsBench() {
+    std::cout << "##### ColumnKernels Bench: rows/sec per instruction set #####" << std::endl;
+    ColumnKernels::InstructionSet supported = ColumnKernels::supportedInstructionSet();
+    for (int set = ColumnKernels::Scalar; set <= supported; set++) {
+        ColumnKernels::setInstructionSet(static_cast<ColumnKernels::InstructionSet>(set));
+        std::cout << ColumnKernels::instructionSetName(ColumnKernels::activeInstructionSet()) << std::endl;
+        addRowBench<64>();
+        addRowBench<256>();
+        addRowBench<512>();
+        addRowsBench<64, 256>();
+        addRowsBench<256, 256>();
+        addRowsBench<512, 256>();
+        operatorBench<64>();
+        operatorBench<256>();
+        operatorBench<512>();
+    }
+    ColumnKernels::setInstructionSet(supported);
+    std::cout << std::endl;
+}
+
+// StatisticsBuffer behind a mutex, the usual way of sharing one between threads
+template <size_t T_length, size_t T_width>
+class MutexStatisticsBuffer {
+public:
+    void addRow(const DataContainer<T_width> &data) {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->buffer_.addRow(data);
+    }
+    const DataContainer<T_width> getStdDev() {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        return this->buffer_.getStdDev();
+    }
+private:
+    std::mutex mutex_;
+    StatisticsBuffer<T_length, T_width> buffer_;
+};
+
+// Writer rows/sec and reader polls/sec with numReaders threads polling getStdDev() continuously
+template <class T_buffer, size_t T_width>
+void sharedBufferBench(const char *name, unsigned int numReaders) {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<T_buffer> statBuffer(new T_buffer());
+    statBuffer->addRow(rows[0]);
+    statBuffer->addRow(rows[1]);
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long> numPolls(0);
+    std::vector<std::thread> readers;
+    for (unsigned int r = 0; r < numReaders; r++) {
+        readers.push_back(std::thread([&]() {
+            unsigned long polls = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                consume(statBuffer->getStdDev());
+                polls++;
+            }
+            numPolls += polls;
+        }));
+    }
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double elapsed = secondsSince(start);
+    done = true;
+    for (auto &reader: readers)
+        reader.join();
+
+    std::cout << "  " << name << ", " << numReaders << " readers, width " << T_width << ": "
+              << std::setw(9) << std::fixed << std::setprecision(0) << BENCH_NUM_ROWS / elapsed
+              << " rows/sec, " << std::setw(9) << numPolls.load() / elapsed << " polls/sec" << std::endl;
+}
+
+void ConcurrentStatisticsBufferBench() {
+    std::cout << "##### ConcurrentStatisticsBuffer Bench: seqlock vs mutex #####" << std::endl;
+    const unsigned int readerCounts[] = {0, 1, 3};
+    for (auto numReaders: readerCounts) {
+        sharedBufferBench<MutexStatisticsBuffer<BENCH_BUFFER_LENGTH, 64>, 64>("mutex  ", numReaders);
+        sharedBufferBench<ConcurrentStatisticsBuffer<BENCH_BUFFER_LENGTH, 64>, 64>("seqlock", numReaders);
+    }
+    std::cout << std::endl;
+}
+
+// Rows/sec into a 100k x 256 window (~200 MB), by slab backing. The window is filled first,
+// so every measured row evicts one from a different page.
+void dynamicBufferBench(const char *name, DynamicStatisticsBuffer::Backing backing) {
+    const size_t length = 100000, width = 256;
+    std::vector<DataContainer<width> > rows = makeRows<width>(4096);
+    DynamicStatisticsBuffer statBuffer(length, width, backing);
+    for (size_t i = 0; i < length; i++)
+        statBuffer.addRow(rows[i % rows.size()].data());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer.addRow(rows[i % rows.size()].data());
+    double elapsed = secondsSince(start);
+    benchSink = statBuffer.getStdDev()[0];
+
+    std::cout << "  " << name << ", " << length << " x " << width << ": " << std::setw(9) << std::fixed
+              << std::setprecision(0) << BENCH_NUM_ROWS / elapsed << " rows/sec" << std::endl;
+}
+
+void DynamicStatisticsBufferBench() {
+    std::cout << "##### DynamicStatisticsBuffer Bench: large windows #####" << std::endl;
+    dynamicBufferBench("heap      ", DynamicStatisticsBuffer::Heap);
+    dynamicBufferBench("huge pages", DynamicStatisticsBuffer::HugePages);
+    std::cout << std::endl;
+}
+
+// Rows/sec into 10000 keyed windows of 64 x 4, in batches of 10000 rows with random keys:
+// one map of separately allocated buffers behind a single lock, against the registry.
+// Then bulk mean polls over every key.
+void registryBench() {
+    const size_t numKeys = 10000, length = 64, width = 4, batchRows = 10000, numRows = 1000000;
+    std::vector<DataContainer<width> > rows = makeRows<width>(batchRows);
+    std::vector<std::string> keys(batchRows);
+    for (size_t r = 0; r < batchRows; r++)
+        keys[r] = "host" + std::to_string(r % numKeys) + ".latency";
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<DynamicStatisticsBuffer> > buffers;
+    BenchClock::time_point start = BenchClock::now();
+    for (size_t done = 0; done < numRows; done += batchRows) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t r = 0; r < batchRows; r++) {
+            std::unique_ptr<DynamicStatisticsBuffer> &buffer = buffers[keys[r]];
+            if (!buffer)
+                buffer.reset(new DynamicStatisticsBuffer(length, width));
+            buffer->addRow(rows[r].data());
+        }
+    }
+    double mapIngest = numRows / secondsSince(start);
+    std::cout << "  map + mutex   : " << std::setw(9) << std::fixed << std::setprecision(0) << mapIngest
+              << " rows/sec" << std::endl;
+
+    // From one shard up to well past the core count, and one per core: each worker walks only
+    // its own shard's rows, so the cost of a batch should not grow with the number of shards
+    std::vector<unsigned int> shardCounts = {1, 2, 4, 8, 16, 32};
+    const unsigned int numCores = std::thread::hardware_concurrency();
+    if (std::find(shardCounts.begin(), shardCounts.end(), numCores) == shardCounts.end())
+        shardCounts.push_back(numCores);
+    for (auto numShards: shardCounts) {
+        StatisticsRegistry<std::string> registry(length, width, numShards);
+        start = BenchClock::now();
+        for (size_t done = 0; done < numRows; done += batchRows)
+            registry.addRows(keys.data(), rows[0].data(), batchRows);
+        double ingest = numRows / secondsSince(start);
+
+        std::vector<double> means(registry.numKeys() * width);
+        const unsigned int numPolls = 100;
+        start = BenchClock::now();
+        for (unsigned int p = 0; p < numPolls; p++)
+            registry.getMeans(means.data());
+        double polls = numPolls / secondsSince(start);
+        benchSink = means[0];
+
+        std::cout << "  registry, " << std::setw(2) << numShards << " shards: " << std::setw(9) << ingest
+                  << " rows/sec, " << std::setw(9) << polls << " getMeans/sec over " << registry.numKeys()
+                  << " keys" << std::endl;
+    }
+}
+
+void StatisticsRegistryBench() {
+    std::cout << "##### StatisticsRegistry Bench: keyed windows #####" << std::endl;
+    registryBench();
+    std::cout << std::endl;
+}
+
+// Rows/sec into a time window of 1000 ticks, with the feed alternating bursts of 5000 rows at
+// 10 per tick and quiet stretches of 1 row per 5 ticks, so the window swings between ~10000
+// rows and ~200. Against a count window of about the same average size.
+template <size_t T_width>
+void timedBufferBench(size_t maxRows) {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    TimedStatisticsBuffer<T_width> statBuffer(1000, maxRows);
+    int64_t now = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        const bool burst = (i / 5000) % 2 == 0;
+        now += burst ? (i % 10 == 0) : 5;
+        statBuffer.addRow(now, rows[i % rows.size()]);
+    }
+    double timed = BENCH_NUM_ROWS / secondsSince(start);
+    consume(statBuffer.getStdDev());
+
+    std::unique_ptr<StatisticsBuffer<4096, T_width> > countBuffer(new StatisticsBuffer<4096, T_width>());
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        countBuffer->addRow(rows[i % rows.size()]);
+    double counted = BENCH_NUM_ROWS / secondsSince(start);
+    consume(countBuffer->getStdDev());
+
+    std::cout << "  width " << std::setw(2) << T_width << ", " << (maxRows ? "capped at 2048 rows" : "uncapped           ")
+              << ": " << std::setw(9) << std::fixed << std::setprecision(0) << timed << " rows/sec timed, "
+              << std::setw(9) << counted << " rows/sec 4096-row StatisticsBuffer" << std::endl;
+}
+
+void TimedStatisticsBufferBench() {
+    std::cout << "##### TimedStatisticsBuffer Bench: bursty feed, 1000-tick window #####" << std::endl;
+    timedBufferBench<4>(0);
+    timedBufferBench<4>(2048);
+    timedBufferBench<16>(0);
+    std::cout << std::endl;
+}
+
+// Rows/sec and bytes per series for exponentially weighted estimates, against a StatisticsBuffer
+// window of the equivalent length
+template <size_t T_width>
+void exponentialBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    ExponentialStatistics<T_width> stats = ExponentialStatistics<T_width>::fromWindowLength(BENCH_BUFFER_LENGTH);
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        stats.addRow(rows[i % rows.size()]);
+    double decayed = BENCH_NUM_ROWS / secondsSince(start);
+    consume(stats.getStdDev());
+
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double windowed = BENCH_NUM_ROWS / secondsSince(start);
+    consume(statBuffer->getStdDev());
+
+    std::cout << "  width " << std::setw(2) << T_width << ": exponential " << std::setw(9) << std::fixed
+              << std::setprecision(0) << decayed << " rows/sec, " << std::setw(7) << sizeof(stats)
+              << " bytes; window " << std::setw(9) << windowed << " rows/sec, " << std::setw(7)
+              << sizeof(*statBuffer) << " bytes" << std::endl;
+}
+
+void ExponentialStatisticsBench() {
+    std::cout << "##### ExponentialStatistics Bench: vs a " << BENCH_BUFFER_LENGTH << "-row window #####" << std::endl;
+    exponentialBench<4>();
+    exponentialBench<16>();
+    exponentialBench<64>();
+    std::cout << std::endl;
+}
+
+// Rows/sec through addRow for one buffer type, followed by a getRow() pass over the full window
+template <class T_buffer, size_t T_width>
+double policyRowsPerSecond(const std::vector<DataContainer<T_width> > &rows) {
+    std::unique_ptr<T_buffer> statBuffer(new T_buffer());
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double sum = 0;
+    for (unsigned int i = 0; i < statBuffer->currentLength(); i++)
+        sum += statBuffer->getRow(i)[0];
+    double rowsPerSecond = BENCH_NUM_ROWS / secondsSince(start);
+    benchSink = statBuffer->getMean()[0] + sum;
+    return rowsPerSecond;
+}
+
+// The cost of each tracked statistic: the mean alone, the default mean and standard deviation,
+// with skewness and kurtosis, and with min/max on top; and masked (1024 rows) against compare-and-reset (1000 rows) indexing
+template <size_t T_width>
+void policyBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    double meanOnly = policyRowsPerSecond<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, MeanOnly>, T_width>(rows);
+    double full = policyRowsPerSecond<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>, T_width>(rows);
+    double higher = policyRowsPerSecond<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, HigherMoments>, T_width>(rows);
+    double extrema = policyRowsPerSecond<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, SlidingExtrema>, T_width>(rows);
+    double unmasked = policyRowsPerSecond<StatisticsBuffer<1000, T_width>, T_width>(rows);
+    std::cout << "  width " << std::setw(2) << T_width << std::fixed << std::setprecision(0)
+              << ": MeanOnly " << std::setw(9) << meanOnly << ", mean+stdDev " << std::setw(9) << full
+              << ", HigherMoments " << std::setw(9) << higher << ", +SlidingExtrema " << std::setw(9) << extrema << ", length 1000 " << std::setw(9) << unmasked
+              << " rows/sec" << std::endl;
+}
+
+void MomentPolicyBench() {
+    std::cout << "##### MomentPolicy Bench: addRow cost per tracked statistic #####" << std::endl;
+    policyBench<1>();
+    policyBench<4>();
+    policyBench<16>();
+    policyBench<64>();
+    std::cout << std::endl;
+}
+
+// Rows per second with z-score detection off (addRow), on (addRowScored at 4 standard deviations,
+// which flags about 1 in 16000 columns of these rows), and done by hand as before, checking each
+// row against getMean() and getStdDev() ahead of addRow
+template <size_t T_width>
+void zScoreBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    const ZScoreThresholds<T_width> thresholds(4.0);
+    unsigned int numFlagged = 0;
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double off = BENCH_NUM_ROWS / secondsSince(start);
+
+    statBuffer.reset(new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        statBuffer->addRowScored(rows[i % rows.size()], thresholds,
+                [&numFlagged](const ColumnMask<T_width> &mask, const DataContainer<T_width> &) {
+                    numFlagged += mask.count();
+                });
+    }
+    double on = BENCH_NUM_ROWS / secondsSince(start);
+
+    statBuffer.reset(new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        const DataContainer<T_width> &row = rows[i % rows.size()];
+        if (statBuffer->currentLength() >= 2) {
+            DataContainer<T_width> mean = statBuffer->getMean(), stdDev = statBuffer->getStdDev();
+            for (unsigned int j = 0; j < T_width; j++)
+                numFlagged += std::abs(row[j] - mean[j]) > 4.0 * stdDev[j];
+        }
+        statBuffer->addRow(row);
+    }
+    double byHand = BENCH_NUM_ROWS / secondsSince(start);
+    benchSink = numFlagged;
+
+    std::cout << "  width " << std::setw(2) << T_width << std::fixed << std::setprecision(0)
+              << ": off " << std::setw(9) << off << ", addRowScored " << std::setw(9) << on
+              << ", getMean/getStdDev " << std::setw(9) << byHand << " rows/sec" << std::endl;
+}
+
+void ZScoreBench() {
+    std::cout << "##### ZScore Bench: addRow with and without z-score detection #####" << std::endl;
+    zScoreBench<1>();
+    zScoreBench<4>();
+    zScoreBench<16>();
+    zScoreBench<64>();
+    std::cout << std::endl;
+}
+
+// Rows per second through addRow, with a getStdDev() every 16 rows, on a buffer of T_buffer
+// first filled once untimed, so no run pays for touching its pages
+template <class T_buffer, size_t T_width>
+double instrumentedRate(T_buffer &statBuffer, const std::vector<DataContainer<T_width> > &rows) {
+    for (unsigned int i = 0; i < BENCH_BUFFER_LENGTH; i++)
+        statBuffer.addRow(rows[i % rows.size()]);
+    double sink = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        statBuffer.addRow(rows[i % rows.size()]);
+        if (i % 16 == 15)
+            sink += statBuffer.getStdDev()[0];
+    }
+    double rate = BENCH_NUM_ROWS / secondsSince(start);
+    benchSink = sink;
+    return rate;
+}
+
+// The same stream without instrumentation, with Instrumented timing one call in 64 (the
+// default), and timing every call
+template <size_t T_width>
+void instrumentationBench() {
+    typedef StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> PlainBuffer;
+    typedef StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, Instrumented> InstrumentedBuffer;
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+
+    std::unique_ptr<PlainBuffer> plainBuffer(new PlainBuffer());
+    double off = instrumentedRate(*plainBuffer, rows);
+
+    std::unique_ptr<InstrumentedBuffer> statBuffer(new InstrumentedBuffer());
+    double sampled = instrumentedRate(*statBuffer, rows);
+
+    statBuffer.reset(new InstrumentedBuffer());
+    statBuffer->getInstrumentation().setSampleInterval(1);
+    double everyCall = instrumentedRate(*statBuffer, rows);
+
+    std::cout << "  width " << std::setw(2) << T_width << std::fixed << std::setprecision(0)
+              << ": off " << std::setw(9) << off << ", sampled 1/64 " << std::setw(9) << sampled
+              << ", every call " << std::setw(9) << everyCall << " rows/sec" << std::endl;
+    if (T_width == 16)
+        statBuffer->getInstrumentation().dumpText(std::cout);
+}
+
+void InstrumentationBench() {
+    std::cout << "##### Instrumentation Bench: addRow and getStdDev with and without Instrumented #####" << std::endl;
+    instrumentationBench<1>();
+    instrumentationBench<16>();
+    std::cout << std::endl;
+}
+
+// Row ingest and full-window column scans for the row-major and column-major layouts.
+// The scan sums every column over the window: by getRow for StatisticsBuffer (the only way
+// to reach the rows), by getColumn for ColumnarStatisticsBuffer.
+template <size_t T_width>
+void layoutBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > rowBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    std::unique_ptr<ColumnarStatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > columnBuffer(
+            new ColumnarStatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        rowBuffer->addRow(rows[i % rows.size()]);
+    double rowIngest = BENCH_NUM_ROWS / secondsSince(start);
+
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        columnBuffer->addRow(rows[i % rows.size()]);
+    double columnIngest = BENCH_NUM_ROWS / secondsSince(start);
+
+    const unsigned int numScans = 20;
+    double sum = 0;
+    start = BenchClock::now();
+    for (unsigned int s = 0; s < numScans; s++)
+        for (unsigned int j = 0; j < T_width; j++)
+            for (unsigned int i = 0; i < rowBuffer->currentLength(); i++)
+                sum += rowBuffer->getRow(i)[j];
+    double rowScan = numScans * T_width / secondsSince(start);
+
+    start = BenchClock::now();
+    for (unsigned int s = 0; s < numScans; s++) {
+        for (unsigned int j = 0; j < T_width; j++) {
+            RingView<double> column = columnBuffer->getColumn(j);
+            for (size_t i = 0; i < column.firstSize; i++)
+                sum += column.first[i];
+            for (size_t i = 0; i < column.secondSize; i++)
+                sum += column.second[i];
+        }
+    }
+    double columnScan = numScans * T_width / secondsSince(start);
+    benchSink = sum;
+
+    std::cout << "  width " << std::setw(3) << T_width << std::fixed << std::setprecision(0)
+              << ": row-major " << std::setw(9) << rowIngest << " rows/sec, "
+              << std::setw(9) << rowScan << " column scans/sec; column-major "
+              << std::setw(9) << columnIngest << " rows/sec, "
+              << std::setw(9) << columnScan << " column scans/sec" << std::endl;
+}
+
+void ColumnarStatisticsBufferBench() {
+    std::cout << "##### ColumnarStatisticsBuffer Bench: row-major vs column-major, "
+              << BENCH_BUFFER_LENGTH << "-row window #####" << std::endl;
+    layoutBench<16>();
+    layoutBench<64>();
+    layoutBench<256>();
+    std::cout << std::endl;
+}
+
+// Cost of ingest plus a p50/p95/p99 poll every T_pollInterval rows, with the SlidingQuantiles
+// tracker vs copying the window out with getRow and running nth_element on each column
+template <size_t T_length, size_t T_width, size_t T_pollInterval>
+void quantileBench() {
+    const unsigned int numRowsToAdd = 20000;
+    const double quantiles[] = {0.5, 0.95, 0.99};
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<T_length, T_width> > plainBuffer(new StatisticsBuffer<T_length, T_width>());
+    std::unique_ptr<StatisticsBuffer<T_length, T_width, SlidingQuantiles> > quantileBuffer(
+            new StatisticsBuffer<T_length, T_width, SlidingQuantiles>());
+
+    BenchClock::time_point start = BenchClock::now();
+    std::vector<double> column(T_length);
+    DataContainer<T_width> result;
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        plainBuffer->addRow(rows[i % rows.size()]);
+        if (i % T_pollInterval != 0)
+            continue;
+        for (auto q: quantiles) {
+            for (unsigned int j = 0; j < T_width; j++) {
+                column.resize(plainBuffer->currentLength());
+                for (unsigned int k = 0; k < column.size(); k++)
+                    column[k] = plainBuffer->getRow(k)[j];
+                std::nth_element(column.begin(), column.begin() + (column.size() - 1) * q, column.end());
+                result[j] = column[(column.size() - 1) * q];
+            }
+            consume(result);
+        }
+    }
+    double baseline = numRowsToAdd / secondsSince(start);
+
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        quantileBuffer->addRow(rows[i % rows.size()]);
+        if (i % T_pollInterval != 0)
+            continue;
+        for (auto q: quantiles)
+            consume(quantileBuffer->getQuantile(q));
+    }
+    double tracked = numRowsToAdd / secondsSince(start);
+
+    std::cout << "  length " << std::setw(5) << T_length << ", width " << std::setw(3) << T_width
+              << ", poll every " << std::setw(3) << T_pollInterval << " rows: copy-and-select "
+              << std::setw(9) << std::fixed << std::setprecision(0) << baseline << " rows/sec, SlidingQuantiles "
+              << std::setw(9) << tracked << " rows/sec" << std::endl;
+}
+
+void SlidingQuantilesBench() {
+    std::cout << "##### SlidingQuantiles Bench: tracker vs copy-and-select #####" << std::endl;
+    quantileBench<1024, 16, 1>();
+    quantileBench<1024, 16, 100>();
+    quantileBench<8192, 16, 1>();
+    quantileBench<8192, 16, 100>();
+    std::cout << std::endl;
+}
+
+// Cost of ingest plus p50/p99 polls every T_length / 8 rows, with the SlidingHistogram sketch vs
+// selecting exactly from getRow copies, and the largest relative error of the sketch's answers
+template <size_t T_length, size_t T_width>
+void histogramBench() {
+    const size_t numRowsToAdd = 2 * T_length, pollInterval = T_length / 8;
+    const double quantiles[] = {0.5, 0.99};
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(1 << 16);
+    std::unique_ptr<StatisticsBuffer<T_length, T_width> > plainBuffer(new StatisticsBuffer<T_length, T_width>());
+    std::unique_ptr<StatisticsBuffer<T_length, T_width, SlidingHistogram> > sketchBuffer(
+            new StatisticsBuffer<T_length, T_width, SlidingHistogram>());
+    std::vector<DataContainer<T_width> > exact;
+
+    BenchClock::time_point start = BenchClock::now();
+    std::vector<double> column(T_length);
+    DataContainer<T_width> result;
+    for (size_t i = 0; i < numRowsToAdd; i++) {
+        plainBuffer->addRow(rows[i % rows.size()]);
+        if (i % pollInterval != pollInterval - 1)
+            continue;
+        for (auto q: quantiles) {
+            for (unsigned int j = 0; j < T_width; j++) {
+                column.resize(plainBuffer->currentLength());
+                for (unsigned int k = 0; k < column.size(); k++)
+                    column[k] = plainBuffer->getRow(k)[j];
+                std::nth_element(column.begin(), column.begin() + (column.size() - 1) * q, column.end());
+                result[j] = column[(column.size() - 1) * q];
+            }
+            exact.push_back(result);
+        }
+    }
+    double baseline = numRowsToAdd / secondsSince(start);
+
+    double maxError = 0;
+    size_t poll = 0;
+    start = BenchClock::now();
+    for (size_t i = 0; i < numRowsToAdd; i++) {
+        sketchBuffer->addRow(rows[i % rows.size()]);
+        if (i % pollInterval != pollInterval - 1)
+            continue;
+        for (auto q: quantiles) {
+            result = sketchBuffer->getQuantile(q);
+            for (unsigned int j = 0; j < T_width; j++)
+                maxError = std::max(maxError, std::abs(result[j] - exact[poll][j]) / std::abs(exact[poll][j]));
+            poll++;
+        }
+    }
+    double sketched = numRowsToAdd / secondsSince(start);
+
+    std::cout << "  length " << std::setw(7) << T_length << ", width " << std::setw(2) << T_width
+              << ": copy-and-select " << std::setw(9) << std::fixed << std::setprecision(0) << baseline
+              << " rows/sec, SlidingHistogram " << std::setw(9) << sketched << " rows/sec, max relative error "
+              << std::setprecision(4) << maxError << ", sketch " << sizeof(SlidingHistogram<T_length, T_width>) / 1024
+              << " KB vs rows " << T_length * sizeof(DataContainer<T_width>) / 1024 << " KB" << std::endl;
+}
+
+void SlidingHistogramBench() {
+    std::cout << "##### SlidingHistogram Bench: approximate quantiles vs copy-and-select #####" << std::endl;
+    histogramBench<1 << 16, 4>();
+    histogramBench<1 << 20, 4>();
+    histogramBench<1 << 16, 16>();
+    std::cout << std::endl;
+}
+
+// Cost of ingest plus a covariance-matrix poll every T_pollInterval rows, with the
+// SlidingCovariance tracker vs recomputing the matrix from getRow copies
+template <size_t T_length, size_t T_width, size_t T_pollInterval>
+void covarianceBench() {
+    typedef typename SlidingCovariance<T_length, T_width>::Matrix Matrix;
+    const unsigned int numRowsToAdd = 20000;
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<T_length, T_width> > plainBuffer(new StatisticsBuffer<T_length, T_width>());
+    std::unique_ptr<StatisticsBuffer<T_length, T_width, SlidingCovariance> > covarianceBuffer(
+            new StatisticsBuffer<T_length, T_width, SlidingCovariance>());
+    std::unique_ptr<Matrix> result(new Matrix());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        plainBuffer->addRow(rows[i % rows.size()]);
+        if (i % T_pollInterval != 0)
+            continue;
+        const size_t length = plainBuffer->currentLength();
+        if (length < 2)
+            continue;
+        DataContainer<T_width> mean = plainBuffer->getMean();
+        for (auto &resultRow: *result)
+            resultRow.fill(0);
+        for (unsigned int k = 0; k < length; k++) {
+            DataContainer<T_width> diff = plainBuffer->getRow(k);
+            diff -= mean;
+            for (unsigned int a = 0; a < T_width; a++) {
+                for (unsigned int b = a; b < T_width; b++)
+                    (*result)[a][b] += diff[a] * diff[b];
+            }
+        }
+        for (unsigned int a = 0; a < T_width; a++) {
+            for (unsigned int b = a; b < T_width; b++)
+                (*result)[b][a] = (*result)[a][b] = (*result)[a][b] / (length - 1);
+        }
+        consume((*result)[T_width - 1]);
+    }
+    double baseline = numRowsToAdd / secondsSince(start);
+
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        covarianceBuffer->addRow(rows[i % rows.size()]);
+        if (i % T_pollInterval != 0 || covarianceBuffer->currentLength() < 2)
+            continue;
+        *result = covarianceBuffer->getCovariance();
+        consume((*result)[T_width - 1]);
+    }
+    double tracked = numRowsToAdd / secondsSince(start);
+
+    std::cout << "  length " << std::setw(5) << T_length << ", width " << std::setw(3) << T_width
+              << ", poll every " << std::setw(3) << T_pollInterval << " rows: recompute "
+              << std::setw(9) << std::fixed << std::setprecision(0) << baseline << " rows/sec, SlidingCovariance "
+              << std::setw(9) << tracked << " rows/sec" << std::endl;
+}
+
+void SlidingCovarianceBench() {
+    std::cout << "##### SlidingCovariance Bench: tracker vs recomputing from rows #####" << std::endl;
+    covarianceBench<1024, 16, 1>();
+    covarianceBench<1024, 16, 100>();
+    covarianceBench<1024, 64, 1>();
+    covarianceBench<1024, 64, 100>();
+    std::cout << std::endl;
+}
+
+// One stream at three window lengths (100 rows, 6000 rows and 360000 rows, as a second, a minute and
+// an hour at 100 rows per second), with mean, std-dev, min and max at each: three separate buffers
+// with SlidingExtrema vs one StatisticsPyramid
+void StatisticsPyramidBench() {
+    std::cout << "##### StatisticsPyramid Bench: three buffers vs one pyramid #####" << std::endl;
+    const size_t width = 16;
+    const unsigned int numRowsToAdd = 1000000;
+    std::vector<DataContainer<width> > rows = makeRows<width>(4096);
+    std::unique_ptr<StatisticsBuffer<100, width, SlidingExtrema> > second(new StatisticsBuffer<100, width, SlidingExtrema>());
+    std::unique_ptr<StatisticsBuffer<6000, width, SlidingExtrema> > minute(new StatisticsBuffer<6000, width, SlidingExtrema>());
+    std::unique_ptr<StatisticsBuffer<360000, width, SlidingExtrema> > hour(
+            new StatisticsBuffer<360000, width, SlidingExtrema>());
+    std::unique_ptr<StatisticsPyramid<100, width, 60, 3> > pyramid(new StatisticsPyramid<100, width, 60, 3>());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        const DataContainer<width> &row = rows[i % rows.size()];
+        second->addRow(row);
+        minute->addRow(row);
+        hour->addRow(row);
+    }
+    double separate = numRowsToAdd / secondsSince(start);
+    consume(hour->getStdDev());
+
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < numRowsToAdd; i++)
+        pyramid->addRow(rows[i % rows.size()]);
+    double pyramidRate = numRowsToAdd / secondsSince(start);
+    consume(pyramid->getStdDev(2));
+
+    start = BenchClock::now();
+    const unsigned int numQueries = 100000;
+    for (unsigned int i = 0; i < numQueries; i++)
+        consume(pyramid->getStdDev(2));
+    double queryRate = numQueries / secondsSince(start);
+
+    std::cout << "  width " << width << ": separate buffers " << std::setw(9) << std::fixed << std::setprecision(0)
+              << separate << " rows/sec, " << std::setw(9)
+              << (sizeof(*second) + sizeof(*minute) + sizeof(*hour)) / 1024 << " KiB" << std::endl;
+    std::cout << "  width " << width << ": pyramid          " << std::setw(9) << pyramidRate << " rows/sec, "
+              << std::setw(9) << sizeof(*pyramid) / 1024 << " KiB, " << queryRate << " hour-level queries/sec"
+              << std::endl;
+    std::cout << std::endl;
+}
+
+// The same chain of operators, accumulator += sqrt((row - mean)^2 / 2), evaluated one whole-row step
+// at a time into temporaries (as the operators used to) vs as a single fused expression
+template <size_t T_width>
+void expressionBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    DataContainer<T_width> mean, accumulator;
+    mean.fill(0.4);
+
+    accumulator.fill(0);
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++) {
+        DataContainer<T_width> difference = rows[i % rows.size()];
+        ColumnKernels::subtract(difference.data(), mean.data(), T_width);
+        DataContainer<T_width> square = difference;
+        ColumnKernels::square(square.data(), T_width);
+        DataContainer<T_width> quotient = square;
+        ColumnKernels::divide(quotient.data(), 2, T_width);
+        DataContainer<T_width> root = quotient;
+        ColumnKernels::sqrt(root.data(), T_width);
+        accumulator += root;
+    }
+    double temporaries = BENCH_NUM_ROWS / secondsSince(start);
+    consume(accumulator);
+
+    accumulator.fill(0);
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        accumulator += ((rows[i % rows.size()] - mean).Pow(2) / 2).Sqrt();
+    double fused = BENCH_NUM_ROWS / secondsSince(start);
+    consume(accumulator);
+
+    std::cout << "  width " << std::setw(3) << T_width << ": temporaries " << std::setw(9) << std::fixed
+              << std::setprecision(0) << temporaries << " rows/sec, expression " << std::setw(9) << fused
+              << " rows/sec" << std::endl;
+}
+
+void DataExpressionBench() {
+    std::cout << "##### DataExpression Bench: step-by-step temporaries vs fused expression #####" << std::endl;
+    expressionBench<4>();
+    expressionBench<64>();
+    expressionBench<512>();
+    std::cout << std::endl;
+}
+
+// Rows per second read out of a full buffer, one whole-window scrape at a time: a copy of each row
+// (as getRow() used to return), a reference per row through the iterators, or the two contiguous spans
+template <size_t T_width>
+void scrapeBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(BENCH_BUFFER_LENGTH + 17);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+    // Leave the oldest row mid-ring, so the window wraps
+    statBuffer->addRows(rows.data(), rows.size());
+    const unsigned int numScrapes = BENCH_NUM_ROWS / 100;
+    DataContainer<T_width> total;
+
+    total.fill(0);
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int s = 0; s < numScrapes; s++) {
+        for (unsigned int k = 0; k < BENCH_BUFFER_LENGTH; k++) {
+            DataContainer<T_width> row = statBuffer->getRow(k);
+            total += row;
+        }
+    }
+    double copied = double(numScrapes) * BENCH_BUFFER_LENGTH / secondsSince(start);
+    consume(total);
+
+    total.fill(0);
+    start = BenchClock::now();
+    for (unsigned int s = 0; s < numScrapes; s++) {
+        for (const DataContainer<T_width> &row: *statBuffer)
+            total += row;
+    }
+    double iterated = double(numScrapes) * BENCH_BUFFER_LENGTH / secondsSince(start);
+    consume(total);
+
+    total.fill(0);
+    start = BenchClock::now();
+    for (unsigned int s = 0; s < numScrapes; s++) {
+        const RingView<DataContainer<T_width> > view = statBuffer->view();
+        for (size_t k = 0; k < view.firstSize; k++)
+            total += view.first[k];
+        for (size_t k = 0; k < view.secondSize; k++)
+            total += view.second[k];
+    }
+    double spanned = double(numScrapes) * BENCH_BUFFER_LENGTH / secondsSince(start);
+    consume(total);
+
+    std::cout << "  width " << std::setw(3) << T_width << ": copies " << std::setw(10) << std::fixed
+              << std::setprecision(0) << copied << " rows/sec, iterators " << std::setw(10) << iterated
+              << " rows/sec, spans " << std::setw(10) << spanned << " rows/sec" << std::endl;
+}
+
+void StatisticsBufferViewBench() {
+    std::cout << "##### StatisticsBuffer View Bench: scraping the window by copies, iterators and spans #####" << std::endl;
+    scrapeBench<4>();
+    scrapeBench<64>();
+    scrapeBench<512>();
+    std::cout << std::endl;
+}
+
+// Footprint and ingest rate of a full buffer storing its rows as T_value, for rows already in that type
+template <class T_value, size_t T_width>
+void storageBench(const char *name) {
+    std::vector<DataContainer<T_width> > wideRows = makeRows<T_width>(4096);
+    std::vector<DataContainer<T_width, T_value> > rows(wideRows.size());
+    for (size_t r = 0; r < rows.size(); r++)
+        for (unsigned int j = 0; j < T_width; j++)
+            rows[r][j] = static_cast<T_value>(wideRows[r][j] * 1000);
+    std::unique_ptr<BasicStatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, T_value> > statBuffer(
+            new BasicStatisticsBuffer<BENCH_BUFFER_LENGTH, T_width, T_value>());
+
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i++)
+        statBuffer->addRow(rows[i % rows.size()]);
+    double perRow = BENCH_NUM_ROWS / secondsSince(start);
+    consume(statBuffer->getStdDev());
+
+    const size_t blockSize = 64;
+    start = BenchClock::now();
+    for (unsigned int i = 0; i < BENCH_NUM_ROWS; i += blockSize)
+        statBuffer->addRows(&rows[i % (rows.size() - blockSize)], blockSize);
+    double perBlock = BENCH_NUM_ROWS / secondsSince(start);
+    consume(statBuffer->getStdDev());
+
+    std::cout << "  " << std::setw(7) << name << " width " << std::setw(3) << T_width << ": "
+              << std::setw(8) << sizeof(*statBuffer) / 1024 << " KiB, addRow " << std::setw(10) << std::fixed
+              << std::setprecision(0) << perRow << " rows/sec, addRows " << std::setw(10) << perBlock
+              << " rows/sec" << std::endl;
+}
+
+void BasicStatisticsBufferBench() {
+    std::cout << "##### BasicStatisticsBuffer Bench: footprint and ingest by row storage type ("
+              << BENCH_BUFFER_LENGTH << " rows) #####" << std::endl;
+    storageBench<double, 16>("double");
+    storageBench<float, 16>("float");
+    storageBench<int16_t, 16>("int16_t");
+    storageBench<double, 256>("double");
+    storageBench<float, 256>("float");
+    storageBench<int16_t, 256>("int16_t");
+    std::cout << std::endl;
+}
+
+// Ingest rate with every update journaled to a mapped file, and the time to get a full window
+// back after a restart: reattaching to the file vs replaying the rows into an empty buffer
+template <size_t T_length, size_t T_width>
+void persistentBench() {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    char path[] = "/tmp/informal_bench_persistent_XXXXXX";
+    close(mkstemp(path));
+    unlink(path);
+
+    double persistentRate;
+    {
+        PersistentStatisticsBuffer<T_length, T_width> statBuffer(path);
+        BenchClock::time_point start = BenchClock::now();
+        for (unsigned int i = 0; i < std::max<unsigned int>(BENCH_NUM_ROWS, T_length); i++)
+            statBuffer.addRow(rows[i % rows.size()]);
+        persistentRate = std::max<unsigned int>(BENCH_NUM_ROWS, T_length) / secondsSince(start);
+        consume(statBuffer.getStdDev());
+    }
+
+    std::unique_ptr<StatisticsBuffer<T_length, T_width> > memoryBuffer(new StatisticsBuffer<T_length, T_width>());
+    BenchClock::time_point start = BenchClock::now();
+    for (unsigned int i = 0; i < T_length; i++)
+        memoryBuffer->addRow(rows[i % rows.size()]);
+    double replaySeconds = secondsSince(start);
+    double memoryRate = T_length / replaySeconds;
+    consume(memoryBuffer->getStdDev());
+
+    start = BenchClock::now();
+    {
+        PersistentStatisticsBuffer<T_length, T_width> statBuffer(path);
+        consume(statBuffer.getStdDev());
+    }
+    double reattachSeconds = secondsSince(start);
+    unlink(path);
+
+    std::cout << "  length " << std::setw(7) << T_length << " width " << std::setw(3) << T_width << ": addRow "
+              << std::setw(10) << std::fixed << std::setprecision(0) << persistentRate << " rows/sec (in memory "
+              << std::setw(10) << memoryRate << "), reattach " << std::setprecision(1) << reattachSeconds * 1e6
+              << " us vs replay " << replaySeconds * 1e6 << " us" << std::endl;
+}
+
+void PersistentStatisticsBufferBench() {
+    std::cout << "##### PersistentStatisticsBuffer Bench: journaled ingest, and reattach vs replay #####" << std::endl;
+    persistentBench<1024, 4>();
+    persistentBench<1024, 64>();
+    persistentBench<1000000, 4>();
+    std::cout << std::endl;
+}
+
+// test_data.txt scaled up to a multi-column capture: row i holds values i, i+1, ... of the file
+// (wrapping around), written as CSV and as packed binary rows
+template <size_t T_width>
+void writeScaledTestData(const char *csvPath, const char *binaryPath, size_t numRows) {
+    std::vector<std::string> values;
+    std::ifstream infile("test_data.txt");
+    std::string line;
+    while (std::getline(infile, line))
+        values.push_back(line);
+    std::ofstream csv(csvPath);
+    std::ofstream binary(binaryPath, std::ios::binary);
+    DataContainer<T_width> row;
+    for (size_t i = 0; i < numRows; i++) {
+        for (size_t j = 0; j < T_width; j++) {
+            const std::string &value = values[(i + j) % values.size()];
+            csv << (j ? "," : "") << value;
+            row[j] = std::strtod(value.c_str(), nullptr);
+        }
+        csv << '\n';
+        binary.write(reinterpret_cast<const char *>(row.data()), sizeof(row));
+    }
+}
+
+// GB/s of file replayed through a StatisticsBuffer: the old getline/stod loop, RowLoader's CSV parser on
+// one thread and on all cores (parsing alone, and overlapped with ingest), and binary rows
+template <size_t T_width>
+void loaderBench(size_t numRows) {
+    char csvPath[] = "/tmp/informal_bench_rows_XXXXXX", binaryPath[] = "/tmp/informal_bench_rows_XXXXXX";
+    close(mkstemp(csvPath));
+    close(mkstemp(binaryPath));
+    writeScaledTestData<T_width>(csvPath, binaryPath, numRows);
+    std::unique_ptr<StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width> > statBuffer(
+            new StatisticsBuffer<BENCH_BUFFER_LENGTH, T_width>());
+
+    auto report = [](const char *name, size_t bytes, double seconds) {
+        std::cout << "    " << std::left << std::setw(34) << name << std::right << std::setw(8) << std::fixed
+                  << std::setprecision(3) << bytes / seconds / 1e9 << " GB/s" << std::endl;
+    };
+
+    RowLoader<T_width> csvLoader(csvPath, RowLoader<T_width>::Csv);
+    RowLoader<T_width> serialLoader(csvPath, RowLoader<T_width>::Csv, 0, 1);
+    RowLoader<T_width> binaryLoader(binaryPath, RowLoader<T_width>::Binary);
+    std::cout << "  width " << T_width << ", " << numRows << " rows, CSV " << csvLoader.fileBytes() / 1000000
+              << " MB, binary " << binaryLoader.fileBytes() / 1000000 << " MB" << std::endl;
+
+    // A backtest samples the stats as it goes, so rows go in 256 at a time with a poll after each slice
+    // (a whole chunk in one addRows() would skip the rows it cycles straight out again)
+    const size_t sliceRows = 256;
+    auto ingest = [&statBuffer, sliceRows](const DataContainer<T_width> *rows, size_t numRows) {
+        for (size_t row = 0; row < numRows; row += sliceRows) {
+            statBuffer->addRows(rows + row, std::min(sliceRows, numRows - row));
+            consume(statBuffer->getMean());
+        }
+    };
+
+    BenchClock::time_point start = BenchClock::now();
+    {
+        std::ifstream infile(csvPath);
+        std::string line;
+        std::vector<DataContainer<T_width> > slice;
+        while (std::getline(infile, line)) {
+            std::istringstream fields(line);
+            std::string field;
+            DataContainer<T_width> row;
+            for (size_t j = 0; j < T_width && std::getline(fields, field, ','); j++)
+                row[j] = std::stod(field);
+            slice.push_back(row);
+            if (slice.size() == sliceRows) {
+                ingest(slice.data(), slice.size());
+                slice.clear();
+            }
+        }
+        ingest(slice.data(), slice.size());
+    }
+    report("getline/stod + ingest", csvLoader.fileBytes(), secondsSince(start));
+
+    start = BenchClock::now();
+    serialLoader.forEachBlock(ingest);
+    report("CSV, 1 parser thread + ingest", csvLoader.fileBytes(), secondsSince(start));
+
+    start = BenchClock::now();
+    size_t numParsed = csvLoader.forEachBlock([](const DataContainer<T_width> *, size_t) {});
+    report("CSV, all parser threads, no ingest", csvLoader.fileBytes(), secondsSince(start));
+    benchSink = numParsed;
+
+    start = BenchClock::now();
+    csvLoader.forEachBlock(ingest);
+    report("CSV, all parser threads + ingest", csvLoader.fileBytes(), secondsSince(start));
+
+    start = BenchClock::now();
+    binaryLoader.forEachBlock(ingest);
+    report("binary + ingest", binaryLoader.fileBytes(), secondsSince(start));
+
+    unlink(csvPath);
+    unlink(binaryPath);
+}
+
+void RowLoaderBench() {
+    std::cout << "##### RowLoader Bench: replaying a scaled-up test_data.txt into a StatisticsBuffer #####" << std::endl;
+    loaderBench<4>(4000000);
+    loaderBench<16>(1000000);
+    std::cout << std::endl;
+}
+
+int main() {
+    ColumnKernelsBench();
+    DataExpressionBench();
+    StatisticsBufferViewBench();
+    BasicStatisticsBufferBench();
+    MomentPolicyBench();
+    ZScoreBench();
+    InstrumentationBench();
+    ConcurrentStatisticsBufferBench();
+    DynamicStatisticsBufferBench();
+    StatisticsRegistryBench();
+    TimedStatisticsBufferBench();
+    ExponentialStatisticsBench();
+    PersistentStatisticsBufferBench();
+    RowLoaderBench();
+    ColumnarStatisticsBufferBench();
+    SlidingQuantilesBench();
+    SlidingHistogramBench();
+    SlidingCovarianceBench();
+    StatisticsPyramidBench();
+    return 0;
+}
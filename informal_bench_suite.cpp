@@ -0,0 +1,253 @@
+/* Benchmark suite for the StatisticsBuffer hot paths, for tracking regressions.
+ * Build and run with "make bench-suite", which writes bench_suite.json and bench_suite.csv
+ * from a single run (./informal_bench_suite --out-prefix bench_suite); or run
+ * ./informal_bench_suite [--json|--csv] to print one of them to stdout.
+ *
+ * Every operation is measured over a grid of buffer lengths and widths. Each sample times a
+ * batch of SUITE_BATCH consecutive calls (single calls are too short for the clock), and
+ * the per-call latency percentiles are taken over the samples. The incremental stats are
+ * compared against a naive baseline that recomputes the mean and standard deviation from
+ * every row in the window after each row added.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+// Custom classes
+#include "ColumnKernels.h"
+#include "DataContainer.h"
+#include "StatisticsBuffer.h"
+
+// Calls timed together in one sample
+#define SUITE_BATCH 8
+// Time spent sampling each operation in each cell of the grid
+#define SUITE_SECONDS_PER_OP 0.05
+#define SUITE_MAX_SAMPLES 20000
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Prevents the compiler from optimizing away results that are never used
+volatile double benchSink;
+
+template <class T_expression, size_t T_width>
+void consume(const DataExpression<T_expression, T_width> &data) {
+    benchSink = data.self()[0];
+}
+
+/**
+ * One line of the results: an operation on one buffer shape.
+ */
+struct SuiteResult {
+    std::string op;
+    size_t length;
+    size_t width;
+    double opsPerSecond;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+};
+
+template <size_t T_width>
+std::vector<DataContainer<T_width> > makeRows(size_t numRows) {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.4, 0.5);
+    std::vector<DataContainer<T_width> > rows(numRows);
+    for (auto &row: rows)
+        for (auto &r: row)
+            r = distribution(generator);
+    return rows;
+}
+
+// Times batches of SUITE_BATCH calls to op(i), with i counting the calls, until the time budget
+// is spent. setup() runs untimed before each batch.
+template <class T_op, class T_setup>
+SuiteResult measure(const char *name, size_t length, size_t width, T_op op, T_setup setup) {
+    std::vector<double> samples;
+    double totalSeconds = 0;
+    size_t call = 0;
+    BenchClock::time_point deadline = BenchClock::now()
+            + std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(SUITE_SECONDS_PER_OP));
+    while (samples.size() < 16 || (samples.size() < SUITE_MAX_SAMPLES && BenchClock::now() < deadline)) {
+        setup();
+        BenchClock::time_point start = BenchClock::now();
+        for (unsigned int b = 0; b < SUITE_BATCH; b++)
+            op(call++);
+        double seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+        samples.push_back(seconds / SUITE_BATCH * 1e9);
+        totalSeconds += seconds;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    SuiteResult result = {name, length, width, call / totalSeconds,
+                          percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999)};
+    return result;
+}
+
+template <class T_op>
+SuiteResult measure(const char *name, size_t length, size_t width, T_op op) {
+    return measure(name, length, width, op, []() {});
+}
+
+// Mean and standard deviation recomputed from every row in the window, two-pass
+template <size_t T_length, size_t T_width>
+void naiveStats(const StatisticsBuffer<T_length, T_width> &statBuffer, DataContainer<T_width> &mean,
+                DataContainer<T_width> &stdDev) {
+    const size_t numRows = statBuffer.currentLength();
+    mean.fill(0);
+    for (const DataContainer<T_width> &row: statBuffer)
+        mean += row;
+    mean = mean / numRows;
+    stdDev.fill(0);
+    for (const DataContainer<T_width> &row: statBuffer)
+        stdDev += (row - mean).Pow(2);
+    stdDev = (stdDev / (numRows - 1)).Sqrt();
+}
+
+template <size_t T_length, size_t T_width>
+void measureCell(std::vector<SuiteResult> &results) {
+    std::vector<DataContainer<T_width> > rows = makeRows<T_width>(4096);
+    std::unique_ptr<StatisticsBuffer<T_length, T_width> > statBuffer(new StatisticsBuffer<T_length, T_width>());
+    auto fill = [&]() {
+        while (!statBuffer->isFull())
+            statBuffer->addRow(rows[statBuffer->currentLength() % rows.size()]);
+    };
+    fill();
+
+    // A full buffer, so each call also evicts the oldest row
+    results.push_back(measure("addRow", T_length, T_width, [&](size_t i) {
+        statBuffer->addRow(rows[i % rows.size()]);
+    }));
+    consume(statBuffer->getMean());
+
+    // Refilled whenever the next batch would empty it
+    results.push_back(measure("removeRows", T_length, T_width, [&](size_t) {
+        statBuffer->removeRows(1);
+    }, [&]() {
+        if (statBuffer->currentLength() <= SUITE_BATCH)
+            fill();
+    }));
+    fill();
+
+    results.push_back(measure("getMean", T_length, T_width, [&](size_t) {
+        consume(statBuffer->getMean());
+    }));
+    results.push_back(measure("getStdDev", T_length, T_width, [&](size_t) {
+        consume(statBuffer->getStdDev());
+    }));
+
+    // What monitoring a stream costs per row: add it, then read both statistics
+    results.push_back(measure("addRow+stats", T_length, T_width, [&](size_t i) {
+        statBuffer->addRow(rows[i % rows.size()]);
+        consume(statBuffer->getMean());
+        consume(statBuffer->getStdDev());
+    }));
+    DataContainer<T_width> mean, stdDev;
+    results.push_back(measure("addRow+stats naive", T_length, T_width, [&](size_t i) {
+        statBuffer->addRow(rows[i % rows.size()]);
+        naiveStats(*statBuffer, mean, stdDev);
+        consume(mean);
+        consume(stdDev);
+    }));
+
+    // DataContainer operators do not depend on the length, so only the first length measures them
+    if (T_length == 64) {
+        DataContainer<T_width> accumulator = rows[0];
+        results.push_back(measure("DataContainer +=", 0, T_width, [&](size_t i) {
+            accumulator += rows[i % rows.size()];
+        }));
+        results.push_back(measure("DataContainer expression", 0, T_width, [&](size_t i) {
+            accumulator = (rows[i % rows.size()] - rows[(i + 1) % rows.size()]).Pow(2) / 2;
+        }));
+        consume(accumulator);
+    }
+}
+
+template <size_t T_length>
+void measureLength(std::vector<SuiteResult> &results) {
+    measureCell<T_length, 1>(results);
+    measureCell<T_length, 4>(results);
+    measureCell<T_length, 16>(results);
+    measureCell<T_length, 64>(results);
+}
+
+// The compiler that built the suite, since results from different compilers are not comparable
+const char *compilerName() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+void printCsv(std::ostream &os, const std::vector<SuiteResult> &results) {
+    os << "op,length,width,ops_per_sec,p50_ns,p90_ns,p99_ns,p999_ns" << std::endl;
+    os << std::fixed << std::setprecision(1);
+    for (const SuiteResult &r: results) {
+        os << r.op << ',' << r.length << ',' << r.width << ',' << r.opsPerSecond << ',' << r.p50 << ','
+                  << r.p90 << ',' << r.p99 << ',' << r.p999 << std::endl;
+    }
+}
+
+void printJson(std::ostream &os, const std::vector<SuiteResult> &results) {
+    os << "{" << std::endl;
+    os << "  \"compiler\": \"" << compilerName() << "\"," << std::endl;
+    os << "  \"instruction_set\": \""
+              << ColumnKernels::instructionSetName(ColumnKernels::activeInstructionSet()) << "\"," << std::endl;
+    os << "  \"batch\": " << SUITE_BATCH << "," << std::endl;
+    os << "  \"results\": [" << std::endl;
+    os << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < results.size(); i++) {
+        const SuiteResult &r = results[i];
+        os << "    {\"op\": \"" << r.op << "\", \"length\": " << r.length << ", \"width\": " << r.width
+                  << ", \"ops_per_sec\": " << r.opsPerSecond << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90
+                  << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << "}"
+                  << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    bool json = argc == 2 && std::strcmp(argv[1], "--json") == 0;
+    bool csv = argc == 2 && std::strcmp(argv[1], "--csv") == 0;
+    bool toFiles = argc == 3 && std::strcmp(argv[1], "--out-prefix") == 0;
+    if (argc > 1 && !json && !csv && !toFiles) {
+        std::cerr << "usage: " << argv[0] << " [--json|--csv|--out-prefix PREFIX]" << std::endl;
+        return 2;
+    }
+
+    std::vector<SuiteResult> results;
+    measureLength<64>(results);
+    measureLength<1024>(results);
+    measureLength<16384>(results);
+
+    if (toFiles) {
+        // Both formats from the same measurements
+        const std::string prefix = argv[2];
+        std::ofstream jsonFile(prefix + ".json"), csvFile(prefix + ".csv");
+        printJson(jsonFile, results);
+        printCsv(csvFile, results);
+        if (!jsonFile || !csvFile) {
+            std::cerr << "cannot write " << prefix << ".json and " << prefix << ".csv" << std::endl;
+            return 1;
+        }
+    } else if (json) {
+        printJson(std::cout, results);
+    } else {
+        printCsv(std::cout, results);
+    }
+    return 0;
+}
@@ -7,13 +7,42 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <memory>
+#include <numeric>
 // Used by code to read in test data from CSV
 #include <sstream>
 #include <string>
 #include <fstream>
+// Used by the multi-threaded tests
+#include <atomic>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
 // Custom classes
+#include "BufferInstrumentation.h"
+#include "ColumnKernels.h"
+#include "ColumnarStatisticsBuffer.h"
+#include "ConcurrentStatisticsBuffer.h"
 #include "DataContainer.h"
+#include "DynamicStatisticsBuffer.h"
+#include "ExponentialStatistics.h"
+#include "PersistentStatisticsBuffer.h"
+#include "RowLoader.h"
+#include "SlidingCovariance.h"
+#include "SlidingExtrema.h"
+#include "SlidingHistogram.h"
+#include "SlidingQuantiles.h"
 #include "StatisticsBuffer.h"
+#include "StatisticsPyramid.h"
+#include "StatisticsRegistry.h"
+#include "TimedStatisticsBuffer.h"
 
 #define DATAROW_WIDTH 4
 #define BUFFER_LENGTH 50
@@ -28,7 +57,7 @@ void printTest(std::string testname, DataRow d1, DataRow d2, DataRow d3) {
 }
 
 template <size_t T_length, size_t T_width>
-void printStatBufferInfo(StatisticsBuffer<T_length, T_width> statBuffer) {
+void printStatBufferInfo(const StatisticsBuffer<T_length, T_width> & statBuffer) {
     std::cout << "length " << statBuffer.currentLength() << ", ";
     std::cout << "Mean: " << statBuffer.getMean() << ", ";
     std::cout << "StdDev: " << statBuffer.getStdDev() << ", ";
@@ -62,6 +91,96 @@ void DataContainerTest1() {
     std::cout << std::endl << std::endl;
 }
 
+// Fused expressions against the same operations done one step at a time by hand, including
+// the cases the operators must get right: results aliasing an operand, const operands,
+// expressions kept past the statement over temporaries, and narrow element types
+void DataExpressionTest1() {
+    std::cout << "##### DataExpression Test1: Fused expressions match step-by-step evaluation #####" << std::endl;
+
+    // An odd width, so the kernel-routed operations also run their scalar tails
+    const size_t width = 13;
+    DataContainer<width> a, b;
+    for (size_t i = 0; i < width; i++) {
+        a[i] = std::cos(i * 0.7) * 10 + 11;
+        b[i] = std::sin(i * 0.3) * 3;
+    }
+    const DataContainer<width> constA = a, constB = b;
+    unsigned int numMismatches = 0;
+    auto check = [&numMismatches](double actual, double expected) {
+        if (actual != expected)
+            numMismatches++;
+    };
+
+    // Each fused result against the per-element steps it stands for
+    DataContainer<width> sum = a + b, difference = constA - constB, quotient = a / 4, square = a.Pow(2),
+                         cube = a.Pow(3), root = a.Sqrt(), chain = ((constA - b).Pow(2) / 2 + a).Sqrt();
+    for (size_t i = 0; i < width; i++) {
+        check(sum[i], a[i] + b[i]);
+        check(difference[i], a[i] - b[i]);
+        check(quotient[i], a[i] / 4);
+        check(square[i], a[i] * a[i]);
+        check(cube[i], std::pow(a[i], 3));
+        check(root[i], std::sqrt(a[i]));
+        double step = a[i] - b[i];
+        step = step * step;
+        step = step / 2;
+        step = step + a[i];
+        check(chain[i], std::sqrt(step));
+    }
+    std::cout << "Fused and kernel-routed results differing from step by step (should be 0): " << numMismatches
+              << std::endl;
+
+    // The result may be one of the operands
+    numMismatches = 0;
+    DataContainer<width> aliased = a;
+    aliased = aliased - b;
+    aliased = (aliased + aliased).Pow(2) / 3;
+    aliased = aliased.Sqrt();
+    DataContainer<width> accumulated = a;
+    accumulated += (accumulated - b).Pow(2);
+    accumulated -= accumulated / 2;
+    for (size_t i = 0; i < width; i++) {
+        check(aliased[i], std::sqrt((2 * (a[i] - b[i])) * (2 * (a[i] - b[i])) / 3));
+        double partial = a[i] + (a[i] - b[i]) * (a[i] - b[i]);
+        check(accumulated[i], partial - partial / 2);
+    }
+    std::cout << "Results written over their own operands differing (should be 0): " << numMismatches << std::endl;
+
+    // Expressions over temporaries keep copies of them, so stay valid once the statement ends
+    numMismatches = 0;
+    StatisticsBuffer<BUFFER_LENGTH, width> statBuffer;
+    statBuffer.addRow(a);
+    statBuffer.addRow(b);
+    auto half = statBuffer.getMean() / 2;
+    auto spread = (statBuffer.getMean() - statBuffer.getStdDev()).Pow(2).Sqrt();
+    statBuffer.addRow(a);
+    DataContainer<width> halfValue = half, spreadValue = spread;
+    for (size_t i = 0; i < width; i++) {
+        const double mean = (a[i] + b[i]) / 2, stdDev = std::abs(a[i] - b[i]) / std::sqrt(2.0);
+        check(halfValue[i], mean / 2);
+        if (std::abs(spreadValue[i] - std::abs(mean - stdDev)) > 1e-12 * std::abs(mean))
+            numMismatches++;
+    }
+    std::cout << "Expressions kept over temporaries differing once evaluated (should be 0): " << numMismatches
+              << std::endl;
+
+    // Narrow elements are computed in double and converted on assignment
+    numMismatches = 0;
+    DataContainer<width, float> narrowA(a), narrowB(b);
+    DataContainer<width, float> narrow = ((narrowA - narrowB).Pow(2) / 2).Sqrt();
+    DataContainer<width, int16_t> counts;
+    counts.fill(7);
+    DataContainer<width, int16_t> halves = counts / 2;
+    for (size_t i = 0; i < width; i++) {
+        const double d = static_cast<double>(narrowA[i]) - static_cast<double>(narrowB[i]);
+        check(narrow[i], static_cast<float>(std::sqrt(d * d / 2)));
+        check(halves[i], 3);
+    }
+    std::cout << "float and int16_t results differing from double then converted (should be 0): "
+              << numMismatches << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
 void StatisticsBufferTest1() {
     std::cout << "##### StatisticsBuffer Test1: Class functionality #####" << std::endl;
 
@@ -112,16 +231,13 @@ void StatisticsBufferTest2() {
     std::cout << "##### StatisticsBuffer Test2: Incremental computation accuracy #####" << std::endl;
 
     const size_t numDataPoints = 1000;
-    std::array<double, numDataPoints> testdata;
-    unsigned int arrayIndex = 0;
-    std::ifstream infile("test_data.txt");
-    std::string line = "";
-    std::string::size_type sz;
-    while (std::getline(infile, line)) {
-        // convert to double and save
-        testdata[arrayIndex] = std::stod(line, &sz);
-        arrayIndex++;
-    }
+    std::vector<double> testdata;
+    RowLoader<1> loader("test_data.txt", RowLoader<1>::Csv);
+    loader.forEachBlock([&testdata](const DataContainer<1> *rows, size_t numRows) {
+        for (size_t r = 0; r < numRows; r++)
+            testdata.push_back(rows[r][0]);
+    });
+    assert(testdata.size() == numDataPoints);
 
     // Compute accurate mean and std-dev
     double mean = 0;
@@ -164,10 +280,1799 @@ void StatisticsBufferTest2() {
     std::cout << std::endl << std::endl;
 }
 
+// Check that ingesting blocks with addRows gives the same buffer as adding the rows one at a time
+void StatisticsBufferTest3() {
+    std::cout << "##### StatisticsBuffer Test3: Batched addRows #####" << std::endl;
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> rowBuffer, blockBuffer;
+    std::array<DataRow, BUFFER_LENGTH*2> block;
+    // Block sizes chosen to start empty, wrap around, fill exactly, and overrun the whole buffer
+    const unsigned int blockSizes[] = {7, 0, 30, 50, 1, 64, 13, 100};
+    unsigned int value = 0;
+    for (auto blockSize: blockSizes) {
+        for (unsigned int i = 0; i < blockSize; i++) {
+            block[i].fill(value++);
+            block[i][1] *= 2;
+            block[i][3] = (value % 7) * 1.5;
+            rowBuffer.addRow(block[i]);
+        }
+        blockBuffer.addRows(block.data(), blockSize);
+        if (blockSize > BUFFER_LENGTH)
+            continue; // skipped rows are not subtracted back out, so only compare to within rounding
+        bool identical = rowBuffer.currentLength() == blockBuffer.currentLength();
+        for (unsigned int i = 0; identical && i < rowBuffer.currentLength(); i++) {
+            DataRow expected = rowBuffer.getRow(i), actual = blockBuffer.getRow(i);
+            identical = std::equal(expected.begin(), expected.end(), actual.begin());
+        }
+        DataRow meanDifference = rowBuffer.getMean(), stdDevDifference = rowBuffer.getStdDev();
+        meanDifference -= blockBuffer.getMean();
+        stdDevDifference -= blockBuffer.getStdDev();
+        std::cout << "block of " << blockSize << ", length " << blockBuffer.currentLength()
+                  << ", rows identical: " << identical
+                  << ", mean difference: " << meanDifference
+                  << ", stdDev difference: " << stdDevDifference << std::endl;
+    }
+    std::cout << "Final addRow buffer:  ";
+    printStatBufferInfo(rowBuffer);
+    std::cout << "Final addRows buffer: ";
+    printStatBufferInfo(blockBuffer);
+
+    std::cout << "Removing 45 rows, across the wrap point" << std::endl;
+    rowBuffer.removeRows(45);
+    blockBuffer.removeRows(45);
+    printStatBufferInfo(rowBuffer);
+    printStatBufferInfo(blockBuffer);
+    std::cout << std::endl << std::endl;
+}
+
+// Long run over the Gaussian test data with a large offset, one column also drifting steadily
+// away from where it started, checking the incremental stats against a two-pass scan of the window
+void StatisticsBufferTest4() {
+    std::cout << "##### StatisticsBuffer Test4: Long-run accuracy with a large, drifting offset #####" << std::endl;
+
+    std::vector<double> testdata;
+    std::ifstream infile("test_data.txt");
+    std::string line = "";
+    while (std::getline(infile, line))
+        testdata.push_back(std::stod(line));
+
+    const unsigned int numRowsToAdd = 2000000;
+    const size_t windowLength = 200;
+    std::unique_ptr<StatisticsBuffer<windowLength, 2> > statBuffer(new StatisticsBuffer<windowLength, 2>());
+    double maxMeanError = 0, maxStdDevError = 0;
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        DataContainer<2> row;
+        row[0] = 1e6 + testdata[i % testdata.size()];
+        row[1] = 1e6 + 0.05 * i + testdata[(i * 7) % testdata.size()];
+        statBuffer->addRow(row);
+        if (i % 9973 != 0 || !statBuffer->isFull())
+            continue;
+
+        DataContainer<2> mean = statBuffer->getMean(), stdDev = statBuffer->getStdDev();
+        for (unsigned int j = 0; j < 2; j++) {
+            long double exactMean = 0, exactSum = 0;
+            for (unsigned int k = 0; k < windowLength; k++)
+                exactMean += statBuffer->getRow(k)[j];
+            exactMean /= windowLength;
+            for (unsigned int k = 0; k < windowLength; k++)
+                exactSum += (statBuffer->getRow(k)[j] - exactMean) * (statBuffer->getRow(k)[j] - exactMean);
+            double exactStdDev = std::sqrt(exactSum / (windowLength - 1));
+            maxMeanError = std::max(maxMeanError, std::abs(mean[j] - static_cast<double>(exactMean)));
+            maxStdDevError = std::max(maxStdDevError, std::abs(stdDev[j] - exactStdDev) / exactStdDev);
+        }
+    }
+    std::cout << "After " << numRowsToAdd << " rows, the drifting column has moved "
+              << 0.05 * numRowsToAdd << " from its first K" << std::endl;
+    std::cout << "Max absolute error of the mean: " << maxMeanError
+              << ", max relative error of the std-dev (should be below 1e-9): " << maxStdDevError << std::endl;
+    std::cout << "Final mean: " << statBuffer->getMean() << ", std-dev: " << statBuffer->getStdDev() << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+void StatisticsBufferTest5() {
+    std::cout << "##### StatisticsBuffer Test5: Zero-copy views and iterators over the rows #####" << std::endl;
+
+    const size_t windowLength = 50;
+    StatisticsBuffer<windowLength, 3> statBuffer;
+    unsigned int mismatches = 0;
+    // Partially filled, then full with the oldest row at every possible position of the ring
+    for (unsigned int i = 0; i < 3 * windowLength; i++) {
+        DataContainer<3> row;
+        for (unsigned int j = 0; j < 3; j++)
+            row[j] = i + 0.25 * j;
+        statBuffer.addRow(row);
+
+        const RingView<DataContainer<3> > view = statBuffer.view();
+        const size_t numRows = statBuffer.currentLength();
+        if (view.size() != numRows || static_cast<size_t>(statBuffer.end() - statBuffer.begin()) != numRows)
+            mismatches++;
+        // Each row referenced by the view and the iterators is the buffer's own, not a copy
+        for (size_t k = 0; k < numRows; k++) {
+            const DataContainer<3> *expected = &statBuffer.getRow(k);
+            const DataContainer<3> *spanned = k < view.firstSize ? view.first + k : view.second + (k - view.firstSize);
+            if (spanned != expected || &statBuffer.begin()[k] != expected || &view[k] != expected)
+                mismatches++;
+        }
+        if (&*(statBuffer.end() - 1) != &statBuffer.getLatestRow())
+            mismatches++;
+
+        // Reverse iteration sees the rows newest first
+        double expectedFirst = i;
+        for (auto it = statBuffer.end(); it != statBuffer.begin(); expectedFirst--) {
+            --it;
+            if ((*it)[0] != expectedFirst)
+                mismatches++;
+        }
+
+        // Summing through the iterators gives the same mean as the buffer
+        double sum = std::accumulate(statBuffer.begin(), statBuffer.end(), 0.0,
+                                     [](double total, const DataContainer<3> &r) { return total + r[1]; });
+        if (std::abs(sum / numRows - statBuffer.getMean()[1]) > 1e-9)
+            mismatches++;
+    }
+    std::cout << "Views and iterators checked against getRow() for " << 3 * windowLength
+              << " rows, mismatches (should be 0): " << mismatches << std::endl;
+
+    // The spans go straight to writev(), without gathering the rows first
+    const RingView<DataContainer<3> > view = statBuffer.view();
+    struct iovec spans[2] = {{const_cast<DataContainer<3> *>(view.first), view.firstSize * sizeof(DataContainer<3>)},
+                             {const_cast<DataContainer<3> *>(view.second), view.secondSize * sizeof(DataContainer<3>)}};
+    int devNull = open("/dev/null", O_WRONLY);
+    ssize_t written = writev(devNull, spans, view.second ? 2 : 1);
+    close(devNull);
+    std::cout << "Wrote " << written << " bytes of " << statBuffer.currentLength()
+              << " rows to /dev/null in one writev() call (should be "
+              << statBuffer.currentLength() * sizeof(DataContainer<3>) << ")" << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check that narrow storage gives exactly the statistics of a double buffer fed the same values
+template <class T_value, size_t T_width>
+unsigned int narrowStorageMismatches(double scale) {
+    const size_t windowLength = 64;
+    BasicStatisticsBuffer<windowLength, T_width, T_value, SlidingExtrema> narrowBuffer;
+    StatisticsBuffer<windowLength, T_width, SlidingExtrema> wideBuffer;
+    std::array<DataContainer<T_width, T_value>, 13> block;
+    unsigned int mismatches = 0;
+    for (unsigned int i = 0; i < windowLength * 10; i++) {
+        DataContainer<T_width, T_value> &row = block[i % block.size()];
+        for (unsigned int j = 0; j < T_width; j++)
+            row[j] = static_cast<T_value>(std::sin(i * 0.37 + j) * scale + 3 * scale);
+        // every other block goes in with addRows, the rest row by row
+        if (i % block.size() == block.size() - 1 && (i / block.size()) % 2) {
+            narrowBuffer.addRows(block.data(), block.size());
+            for (auto &r: block)
+                wideBuffer.addRow(DataContainer<T_width>(r));
+        } else if (i % block.size() == block.size() - 1) {
+            for (auto &r: block) {
+                narrowBuffer.addRow(r);
+                wideBuffer.addRow(DataContainer<T_width>(r));
+            }
+        }
+        if (narrowBuffer.isEmpty())
+            continue;
+        DataContainer<T_width> narrowMean = narrowBuffer.getMean(), wideMean = wideBuffer.getMean();
+        DataContainer<T_width> narrowStdDev = narrowBuffer.getStdDev(), wideStdDev = wideBuffer.getStdDev();
+        DataContainer<T_width> narrowMin = narrowBuffer.getMin(), wideMin = wideBuffer.getMin();
+        for (unsigned int j = 0; j < T_width; j++) {
+            if (narrowMean[j] != wideMean[j] || narrowStdDev[j] != wideStdDev[j] || narrowMin[j] != wideMin[j])
+                mismatches++;
+            if (narrowBuffer.getLatestRow()[j] != wideBuffer.getLatestRow()[j])
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void BasicStatisticsBufferTest1() {
+    std::cout << "##### BasicStatisticsBuffer Test1: float and int16_t rows with double statistics #####" << std::endl;
+
+    std::cout << "Row size: double " << sizeof(DataContainer<DATAROW_WIDTH>) << " bytes, float "
+              << sizeof(DataContainer<DATAROW_WIDTH, float>) << " bytes, int16_t "
+              << sizeof(DataContainer<DATAROW_WIDTH, int16_t>) << " bytes" << std::endl;
+    // Under every instruction set, and also at a width that takes each kernel through all of its loops
+    unsigned int floatMismatches = 0, int16Mismatches = 0;
+    ColumnKernels::InstructionSet supported = ColumnKernels::supportedInstructionSet();
+    for (int set = ColumnKernels::Scalar; set <= supported; set++) {
+        ColumnKernels::setInstructionSet(static_cast<ColumnKernels::InstructionSet>(set));
+        floatMismatches += narrowStorageMismatches<float, DATAROW_WIDTH>(0.1) + narrowStorageMismatches<float, 27>(0.1);
+        int16Mismatches += narrowStorageMismatches<int16_t, DATAROW_WIDTH>(1000)
+                           + narrowStorageMismatches<int16_t, 27>(1000);
+    }
+    ColumnKernels::setInstructionSet(supported);
+    std::cout << "float rows against double rows of the same values, mismatches (should be 0): "
+              << floatMismatches << std::endl;
+    std::cout << "int16_t rows against double rows of the same values, mismatches (should be 0): "
+              << int16Mismatches << std::endl;
+
+    // Expressions on narrow rows are computed in double and converted back on assignment
+    DataContainer<DATAROW_WIDTH, int16_t> d1, d2;
+    d1.fill(300);
+    d2.fill(7);
+    DataContainer<DATAROW_WIDTH, int16_t> d3 = (d1 - d2) / 2;
+    DataContainer<DATAROW_WIDTH> d4 = (d1 - d2) / 2;
+    d1 += d2;
+    std::cout << "int16_t (300 - 7) / 2 should be 146 and is " << d3[0] << ", as double should be 146.5 and is "
+              << d4[0] << ", 300 += 7 should be 307 and is " << d1[0] << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Feed a MeanOnly buffer and a full one the same drifting rows through every ingest path, and
+// compare their means (which should agree bit for bit), rows and minima
+template <size_t T_length>
+unsigned int meanOnlyMismatches() {
+    StatisticsBuffer<T_length, DATAROW_WIDTH, MeanOnly, SlidingExtrema> meanBuffer;
+    StatisticsBuffer<T_length, DATAROW_WIDTH, SlidingExtrema> fullBuffer;
+    std::vector<DataRow> block;
+    unsigned int mismatches = 0;
+    for (unsigned int i = 0; i < T_length * 12; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = 1e4 * j + i * 0.25 + std::sin(i * 0.37 + j) * 5;
+        block.push_back(row);
+        // Blocks of varying size, some longer than the buffer, go in with addRows; the rest row by row
+        if (block.size() < 1 + (i / 7) % (T_length + 3))
+            continue;
+        if (i % 3 == 0) {
+            meanBuffer.addRows(block.data(), block.size());
+            fullBuffer.addRows(block.data(), block.size());
+        } else {
+            for (auto &r: block) {
+                meanBuffer.addRow(r);
+                fullBuffer.addRow(r);
+            }
+        }
+        block.clear();
+        if (i % 5 == 0) {
+            meanBuffer.removeRows(i % 11);
+            fullBuffer.removeRows(i % 11);
+        }
+        if (meanBuffer.currentLength() != fullBuffer.currentLength())
+            mismatches++;
+        if (meanBuffer.isEmpty())
+            continue;
+        DataContainer<DATAROW_WIDTH> meanMean = meanBuffer.getMean(), fullMean = fullBuffer.getMean();
+        DataContainer<DATAROW_WIDTH> meanMin = meanBuffer.getMin(), fullMin = fullBuffer.getMin();
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            if (meanMean[j] != fullMean[j] || meanMin[j] != fullMin[j])
+                mismatches++;
+        }
+        for (unsigned int k = 0; k < meanBuffer.currentLength(); k++) {
+            if (!std::equal(meanBuffer.getRow(k).begin(), meanBuffer.getRow(k).end(), fullBuffer.getRow(k).begin()))
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void MomentPolicyTest1() {
+    std::cout << "##### MomentPolicy Test1: MeanOnly matches the full buffer's mean #####" << std::endl;
+
+    std::cout << "Moment order: default " << StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH>::momentOrder
+              << " (should be 2), MeanOnly " << StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, MeanOnly>::momentOrder
+              << " (should be 1)" << std::endl;
+    std::cout << "Buffer size beyond the rows: default "
+              << sizeof(StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH>) - BUFFER_LENGTH * sizeof(DataRow)
+              << " bytes, MeanOnly "
+              << sizeof(StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, MeanOnly>) - BUFFER_LENGTH * sizeof(DataRow)
+              << " bytes" << std::endl;
+    std::cout << "Length 50, mismatches against the full buffer (should be 0): " << meanOnlyMismatches<50>() << std::endl;
+    std::cout << "Length 64, mismatches against the full buffer (should be 0): " << meanOnlyMismatches<64>() << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Skewness and kurtosis of the test data over a sliding window, through every ingest path,
+// against a two-pass recompute of the window. One column is skewed, and one sits on a large offset
+// and drifts, which is where rounding left in the sums by the incremental updates would build up.
+void HigherMomentsTest1() {
+    std::cout << "##### HigherMoments Test1: Skewness and kurtosis against a full recompute #####" << std::endl;
+
+    std::vector<double> testdata;
+    std::ifstream infile("test_data.txt");
+    std::string line = "";
+    while (std::getline(infile, line))
+        testdata.push_back(std::stod(line));
+
+    const size_t windowLength = 200, width = 3;
+    const unsigned int numRowsToAdd = 40000;
+    std::unique_ptr<StatisticsBuffer<windowLength, width, HigherMoments> > statBuffer(
+            new StatisticsBuffer<windowLength, width, HigherMoments>());
+    std::unique_ptr<StatisticsBuffer<windowLength, width> > plainBuffer(new StatisticsBuffer<windowLength, width>());
+    std::vector<DataContainer<width> > block;
+    double maxSkewnessError = 0, maxKurtosisError = 0, maxPlainDifference = 0;
+    unsigned int numChecks = 0;
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        const double x = testdata[i % testdata.size()], y = testdata[(i * 7) % testdata.size()];
+        DataContainer<width> row;
+        row[0] = x;
+        row[1] = std::exp(y);
+        row[2] = 1e4 + 0.01 * i + x;
+        block.push_back(row);
+        if (block.size() < 1 + (i / 13) % 40)
+            continue;
+        if (i % 2) {
+            statBuffer->addRows(block.data(), block.size());
+            plainBuffer->addRows(block.data(), block.size());
+        } else {
+            for (auto &r: block) {
+                statBuffer->addRow(r);
+                plainBuffer->addRow(r);
+            }
+        }
+        block.clear();
+        if (i % 7 == 0) {
+            statBuffer->removeRows(i % 31);
+            plainBuffer->removeRows(i % 31);
+        }
+        // Mid-pass, so the fresh sums miss the rows before it until the next pass
+        if (i % 1009 == 0) {
+            statBuffer->recenter();
+            plainBuffer->recenter();
+        }
+        if (statBuffer->currentLength() < 20)
+            continue;
+
+        DataContainer<width> skewness = statBuffer->getSkewness(), kurtosis = statBuffer->getKurtosis();
+        DataContainer<width> mean = statBuffer->getMean(), plainMean = plainBuffer->getMean();
+        DataContainer<width> stdDev = statBuffer->getStdDev(), plainStdDev = plainBuffer->getStdDev();
+        const size_t n = statBuffer->currentLength();
+        for (unsigned int j = 0; j < width; j++) {
+            maxPlainDifference = std::max(maxPlainDifference, std::abs(mean[j] - plainMean[j]) / plainStdDev[j]);
+            maxPlainDifference = std::max(maxPlainDifference, std::abs(stdDev[j] / plainStdDev[j] - 1));
+            long double mean = 0, m2 = 0, m3 = 0, m4 = 0;
+            for (unsigned int k = 0; k < n; k++)
+                mean += statBuffer->getRow(k)[j];
+            mean /= n;
+            for (unsigned int k = 0; k < n; k++) {
+                long double d = statBuffer->getRow(k)[j] - mean;
+                m2 += d * d;
+                m3 += d * d * d;
+                m4 += d * d * d * d;
+            }
+            double exactSkewness = static_cast<double>(std::sqrt(static_cast<long double>(n)) * m3 / (m2 * std::sqrt(m2)));
+            double exactKurtosis = static_cast<double>(n * m4 / (m2 * m2) - 3);
+            maxSkewnessError = std::max(maxSkewnessError, std::abs(skewness[j] - exactSkewness));
+            maxKurtosisError = std::max(maxKurtosisError, std::abs(kurtosis[j] - exactKurtosis));
+        }
+        numChecks++;
+    }
+    std::cout << numChecks << " windows checked, mean and std-dev relative to a plain buffer's (should be below 1e-12): "
+              << maxPlainDifference << std::endl;
+    std::cout << "Max absolute error of the skewness (should be below 1e-12): " << maxSkewnessError
+              << ", of the kurtosis (should be below 1e-11): " << maxKurtosisError << std::endl;
+    std::cout << "Final skewness: " << statBuffer->getSkewness() << ", kurtosis: " << statBuffer->getKurtosis()
+              << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Split one stream across 4 buffers, as separate ingest threads would, and fold their serialized
+// summaries back together. The columns sit far from zero, and each part anchors K on its own first
+// row, so the merge has to move the sums between anchors.
+void StatisticsSummaryTest1() {
+    std::cout << "##### StatisticsSummary Test1: Merged partial summaries match one buffer #####" << std::endl;
+
+    const unsigned int numRows = 900, numParts = 4;
+    StatisticsBuffer<1000, DATAROW_WIDTH> whole;
+    std::vector<std::unique_ptr<StatisticsBuffer<1000, DATAROW_WIDTH> > > parts;
+    for (unsigned int p = 0; p < numParts; p++)
+        parts.push_back(std::unique_ptr<StatisticsBuffer<1000, DATAROW_WIDTH> >(new StatisticsBuffer<1000, DATAROW_WIDTH>()));
+    for (unsigned int i = 0; i < numRows; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = 1e6 * j + i * 0.5 * (j + 1) + std::sin(i * 0.3 + j) * 7;
+        whole.addRow(row);
+        // Uneven, contiguous runs, so each part covers a different range of values
+        parts[std::min(numParts - 1, i * i / (numRows * numRows / numParts))]->addRow(row);
+    }
+
+    StatisticsSummary<DATAROW_WIDTH> merged;
+    merged.merge(StatisticsSummary<DATAROW_WIDTH>());
+    for (auto &part: parts) {
+        std::vector<unsigned char> bytes = part->getSummary().serialize();
+        merged.merge(StatisticsSummary<DATAROW_WIDTH>::deserialize(bytes.data(), bytes.size()));
+    }
+    merged.merge(StatisticsSummary<DATAROW_WIDTH>());
+
+    DataRow mean = whole.getMean(), stdDev = whole.getStdDev();
+    DataRow mergedMean = merged.getMean(), mergedStdDev = merged.getStdDev();
+    double worstError = 0;
+    for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+        worstError = std::max(worstError, std::fabs(mergedMean[j] - mean[j]) / stdDev[j]);
+        worstError = std::max(worstError, std::fabs(mergedStdDev[j] - stdDev[j]) / stdDev[j]);
+    }
+    std::cout << "Whole Mean: " << mean << ", StdDev: " << stdDev << std::endl;
+    std::cout << "Merged Mean: " << mergedMean << ", StdDev: " << mergedStdDev << std::endl;
+    std::cout << "Merged rows " << merged.currentLength() << " (should be " << numRows
+              << "), worst relative error below 1e-12 (should be 1): " << (worstError < 1e-12) << std::endl;
+
+    std::vector<unsigned char> bytes = merged.serialize();
+    StatisticsSummary<DATAROW_WIDTH> copy = StatisticsSummary<DATAROW_WIDTH>::deserialize(bytes.data(), bytes.size());
+    bool identical = copy.numRows == merged.numRows && copy.K == merged.K && copy.Ex == merged.Ex
+                     && copy.Ex2 == merged.Ex2;
+    std::cout << bytes.size() << " bytes serialized, read back identical (should be 1): " << identical << std::endl;
+
+    // Counts past 2^32, as from merging the summaries of many hosts
+    StatisticsSummary<DATAROW_WIDTH> large = merged;
+    large.numRows = 3000000000u;
+    large.merge(large);
+    std::vector<unsigned char> largeBytes = large.serialize();
+    StatisticsSummary<DATAROW_WIDTH> largeCopy =
+            StatisticsSummary<DATAROW_WIDTH>::deserialize(largeBytes.data(), largeBytes.size());
+    std::cout << "Merged count read back " << largeCopy.currentLength() << " (should be 6000000000)" << std::endl;
+
+    unsigned int numRejected = 0;
+    try {
+        StatisticsSummary<DATAROW_WIDTH>::deserialize(bytes.data(), bytes.size() - 1);
+    } catch (const std::runtime_error &) {
+        numRejected++;
+    }
+    try {
+        StatisticsSummary<DATAROW_WIDTH + 1>::deserialize(bytes.data(), StatisticsSummary<DATAROW_WIDTH + 1>::serializedBytes);
+    } catch (const std::runtime_error &) {
+        numRejected++;
+    }
+    bytes[4]++;
+    try {
+        StatisticsSummary<DATAROW_WIDTH>::deserialize(bytes.data(), bytes.size());
+    } catch (const std::runtime_error &) {
+        numRejected++;
+    }
+    std::cout << "Truncated, wrong width and wrong version rejected (should be 3): " << numRejected << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Stress test of one writer against several readers. Column j of row i is 2^20 + i + 1024*j, so
+// every column is shifted from its K by the same amount, with K in the same binade, and (even
+// across re-centering) in any consistent snapshot all columns have bit-identical Ex and Ex2.
+// A torn read would mix columns from different updates.
+void ConcurrentStatisticsBufferTest1() {
+    std::cout << "##### ConcurrentStatisticsBuffer Test1: Consistent snapshots under concurrent ingest #####" << std::endl;
+
+    const unsigned int numRowsToAdd = 200000;
+    const unsigned int numReaders = 3;
+    std::unique_ptr<ConcurrentStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> > statBuffer(
+            new ConcurrentStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH>());
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long> numSnapshots(0), numInconsistent(0);
+
+    std::vector<std::thread> readers;
+    for (unsigned int r = 0; r < numReaders; r++) {
+        readers.push_back(std::thread([&]() {
+            while (!done.load()) {
+                StatisticsSummary<DATAROW_WIDTH> summary = statBuffer->getSummary();
+                bool consistent = summary.numRows <= BUFFER_LENGTH;
+                // (a snapshot from before the first row has K still zeroed)
+                for (unsigned int j = 1; summary.numRows > 0 && j < DATAROW_WIDTH; j++) {
+                    consistent = consistent && summary.Ex[j] == summary.Ex[0] && summary.Ex2[j] == summary.Ex2[0]
+                                 && summary.K[j] - summary.K[0] == 1024.0*j;
+                }
+                numSnapshots++;
+                if (!consistent)
+                    numInconsistent++;
+            }
+        }));
+    }
+
+    DataRow row;
+    for (unsigned int i = 0; i < numRowsToAdd; i++) {
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = (1 << 20) + i + 1024.0*j;
+        statBuffer->addRow(row);
+        if (i % 97 == 0)
+            statBuffer->removeRows(13);
+    }
+    done = true;
+    for (auto &reader: readers)
+        reader.join();
+
+    std::cout << "Snapshots taken: " << numSnapshots.load() << ", inconsistent snapshots (should be 0): "
+              << numInconsistent.load() << std::endl;
+    std::cout << "Published mean: " << statBuffer->getMean()
+              << ", writer's mean: " << statBuffer->writerBuffer().getSummary().getMean() << std::endl;
+    std::cout << "Published length: " << statBuffer->currentLength() << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check that the runtime-sized buffer matches StatisticsBuffer exactly, for each kind of backing slab
+void DynamicStatisticsBufferTest1() {
+    std::cout << "##### DynamicStatisticsBuffer Test1: Runtime-sized buffer matches StatisticsBuffer #####" << std::endl;
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> statBuffer;
+    // A power-of-two length too, whose ring is indexed with a mask rather than a compare-and-reset
+    StatisticsBuffer<32, DATAROW_WIDTH> maskedStatBuffer;
+    DynamicStatisticsBuffer maskedBuffer(32, DATAROW_WIDTH);
+    std::vector<char> arena(DynamicStatisticsBuffer::requiredBytes(BUFFER_LENGTH, DATAROW_WIDTH) + 1);
+    DynamicStatisticsBuffer heapBuffer(BUFFER_LENGTH, DATAROW_WIDTH);
+    DynamicStatisticsBuffer hugePageBuffer(BUFFER_LENGTH, DATAROW_WIDTH, DynamicStatisticsBuffer::HugePages);
+    // Deliberately misaligned, the buffer aligns it itself
+    DynamicStatisticsBuffer arenaBuffer(BUFFER_LENGTH, DATAROW_WIDTH, arena.data() + 1, arena.size() - 1);
+    DynamicStatisticsBuffer *dynamicBuffers[] = {&heapBuffer, &hugePageBuffer, &arenaBuffer};
+    const char *names[] = {"heap", "huge pages", "arena"};
+
+    std::array<DataRow, 20> block;
+    for (unsigned int i = 0; i < BUFFER_LENGTH*3; i++) {
+        DataRow &row = block[i % block.size()];
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = std::cos(i * 0.1 + j) * (j + 1) * 10;
+        if (i % block.size() == block.size() - 1) {
+            // every other block goes in with addRows, the rest row by row
+            bool asBlock = (i / block.size()) % 2;
+            for (unsigned int k = 0; k < block.size(); k++) {
+                statBuffer.addRow(block[k]);
+                maskedStatBuffer.addRow(block[k]);
+            }
+            maskedBuffer.addRows(block[0].data(), block.size());
+            for (auto buffer: dynamicBuffers) {
+                if (asBlock) {
+                    buffer->addRows(block[0].data(), block.size());
+                } else {
+                    for (unsigned int k = 0; k < block.size(); k++)
+                        buffer->addRow(block[k].data());
+                }
+            }
+        }
+    }
+    statBuffer.removeRows(7);
+    for (auto buffer: dynamicBuffers)
+        buffer->removeRows(7);
+
+    DataRow mean = statBuffer.getMean(), stdDev = statBuffer.getStdDev(), oldest = statBuffer.getRow(0);
+    std::cout << "StatisticsBuffer length " << statBuffer.currentLength() << ", Mean: " << mean
+              << ", StdDev: " << stdDev << std::endl;
+    for (unsigned int b = 0; b < 3; b++) {
+        DynamicStatisticsBuffer &buffer = *dynamicBuffers[b];
+        std::vector<double> dynamicMean = buffer.getMean(), dynamicStdDev = buffer.getStdDev();
+        bool identical = buffer.currentLength() == statBuffer.currentLength()
+                         && std::equal(mean.begin(), mean.end(), dynamicMean.begin())
+                         && std::equal(stdDev.begin(), stdDev.end(), dynamicStdDev.begin())
+                         && std::equal(oldest.begin(), oldest.end(), buffer.getRow(0));
+        std::cout << names[b] << " buffer, length " << buffer.currentLength()
+                  << ", identical to StatisticsBuffer: " << identical << std::endl;
+    }
+    maskedStatBuffer.removeRows(7);
+    maskedBuffer.removeRows(7);
+    DataRow maskedMean = maskedStatBuffer.getMean(), maskedStdDev = maskedStatBuffer.getStdDev();
+    std::vector<double> dynamicMean = maskedBuffer.getMean(), dynamicStdDev = maskedBuffer.getStdDev();
+    bool identical = maskedBuffer.currentLength() == maskedStatBuffer.currentLength()
+                     && std::equal(maskedMean.begin(), maskedMean.end(), dynamicMean.begin())
+                     && std::equal(maskedStdDev.begin(), maskedStdDev.end(), dynamicStdDev.begin())
+                     && std::equal(maskedStatBuffer.getRow(3).begin(), maskedStatBuffer.getRow(3).end(),
+                                   maskedBuffer.getRow(3));
+    std::cout << "length 32 buffer, length " << maskedBuffer.currentLength()
+              << ", identical to StatisticsBuffer: " << identical << std::endl;
+
+    // An arena too small for the slab is refused rather than overrun
+    bool refused = false;
+    try {
+        DynamicStatisticsBuffer shortBuffer(BUFFER_LENGTH, DATAROW_WIDTH, arena.data(), arena.size() / 2);
+    } catch (const std::invalid_argument &) {
+        refused = true;
+    }
+    std::cout << "Undersized arena refused (should be 1): " << refused << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Ingest batches of rows for many keys through 3 shards, and check every key's window against
+// a separate buffer fed the same rows one by one
+void StatisticsRegistryTest1() {
+    std::cout << "##### StatisticsRegistry Test1: Sharded keyed ingest matches one buffer per key #####" << std::endl;
+
+    const unsigned int numKeys = 500, batchRows = 1000, numBatches = 40;
+    StatisticsRegistry<std::string> registry(BUFFER_LENGTH, DATAROW_WIDTH, 3);
+    std::unordered_map<std::string, std::unique_ptr<DynamicStatisticsBuffer> > expected;
+
+    std::vector<std::string> keys(batchRows);
+    std::vector<double> rows(batchRows * DATAROW_WIDTH);
+    unsigned int seed = 1;
+    for (unsigned int b = 0; b < numBatches; b++) {
+        for (unsigned int r = 0; r < batchRows; r++) {
+            // Runs of a few rows with the same key, as a batch from one source would have
+            if (r % 3 == 0)
+                seed = seed * 1103515245 + 12345;
+            keys[r] = "metric." + std::to_string(seed % numKeys);
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                rows[r * DATAROW_WIDTH + j] = std::sin((b * batchRows + r) * 0.01 * (j + 1)) * 100 + seed % 7;
+        }
+        if (b % 4 == 3) {
+            for (unsigned int r = 0; r < batchRows; r++)
+                registry.addRow(keys[r], &rows[r * DATAROW_WIDTH]);
+        } else {
+            registry.addRows(keys.data(), rows.data(), batchRows);
+        }
+        for (unsigned int r = 0; r < batchRows; r++) {
+            std::unique_ptr<DynamicStatisticsBuffer> &buffer = expected[keys[r]];
+            if (!buffer)
+                buffer.reset(new DynamicStatisticsBuffer(BUFFER_LENGTH, DATAROW_WIDTH));
+            buffer->addRow(&rows[r * DATAROW_WIDTH]);
+        }
+    }
+    registry.find("metric.7")->removeRows(BUFFER_LENGTH);
+    expected["metric.7"]->removeRows(BUFFER_LENGTH);
+
+    std::vector<std::string> registryKeys = registry.keys();
+    std::vector<double> means(registry.numKeys() * DATAROW_WIDTH), stdDevs(means.size());
+    registry.getMeans(means.data());
+    registry.getStdDevs(stdDevs.data());
+    unsigned int numMismatches = 0;
+    for (size_t k = 0; k < registryKeys.size(); k++) {
+        const DynamicStatisticsBuffer &buffer = *expected[registryKeys[k]];
+        const DynamicStatisticsBuffer &window = *registry.find(registryKeys[k]);
+        if (buffer.isEmpty()) {
+            numMismatches += !window.isEmpty() || !std::isnan(means[k * DATAROW_WIDTH])
+                             || !std::isnan(stdDevs[k * DATAROW_WIDTH]);
+            continue;
+        }
+        std::vector<double> mean = buffer.getMean(), stdDev = buffer.getStdDev();
+        numMismatches += window.currentLength() != buffer.currentLength()
+                         || !std::equal(mean.begin(), mean.end(), &means[k * DATAROW_WIDTH])
+                         || !std::equal(stdDev.begin(), stdDev.end(), &stdDevs[k * DATAROW_WIDTH])
+                         || !std::equal(buffer.getRow(0), buffer.getRow(0) + DATAROW_WIDTH, window.getRow(0));
+    }
+    std::cout << registry.numKeys() << " keys in " << registry.numShards() << " shards (should be "
+              << expected.size() << " in 3)" << std::endl;
+    std::cout << "Keys whose statistics differ from their own buffer (should be 0): " << numMismatches << std::endl;
+    std::cout << "Unknown key found (should be 0): " << (registry.find("metric.none") != nullptr) << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Feed bursts of rows separated by gaps, some longer than the horizon, and check the window against
+// a deque of the rows aged out by hand, with a two-pass mean and standard deviation
+void TimedStatisticsBufferTest1() {
+    std::cout << "##### TimedStatisticsBuffer Test1: Time-based window matches a two-pass scan #####" << std::endl;
+
+    const TimedStatisticsBuffer<DATAROW_WIDTH>::Timestamp horizon = 1000;
+    const size_t maxRows = 300;
+    TimedStatisticsBuffer<DATAROW_WIDTH> unbounded(horizon, 0, 4), capped(horizon, maxRows, 4);
+    std::deque<std::pair<int64_t, DataRow> > expected;
+
+    int64_t now = 0;
+    unsigned int numChecks = 0, numMismatches = 0;
+    double worstError = 0;
+    auto check = [&](const TimedStatisticsBuffer<DATAROW_WIDTH> &buffer, size_t limit) {
+        const size_t numRows = std::min(expected.size(), limit), first = expected.size() - numRows;
+        numChecks++;
+        if (buffer.currentLength() != numRows) {
+            numMismatches++;
+            return;
+        }
+        for (size_t i = 0; i < numRows; i++)
+            numMismatches += buffer.getTimestamp(i) != expected[first + i].first
+                             || !(buffer.getRow(i) == expected[first + i].second);
+        if (numRows < 2)
+            return;
+        DataRow mean, stdDev;
+        mean.fill(0);
+        stdDev.fill(0);
+        for (size_t i = first; i < expected.size(); i++)
+            mean += expected[i].second;
+        mean = mean / numRows;
+        for (size_t i = first; i < expected.size(); i++)
+            stdDev += (expected[i].second - mean).Pow(2);
+        stdDev = (stdDev / (numRows - 1)).Sqrt();
+        DataRow bufferMean = buffer.getMean(), bufferStdDev = buffer.getStdDev();
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            worstError = std::max(worstError, std::fabs(bufferMean[j] - mean[j]) / stdDev[j]);
+            worstError = std::max(worstError, std::fabs(bufferStdDev[j] - stdDev[j]) / stdDev[j]);
+        }
+    };
+
+    for (unsigned int burst = 0; burst < 60; burst++) {
+        // Gaps from none to over twice the horizon, then a burst of up to 400 rows a tick or two apart
+        now += (burst * 7919) % 2300;
+        const unsigned int burstRows = (burst * 104729) % 400;
+        for (unsigned int i = 0; i < burstRows; i++) {
+            now += i % 3 == 0;
+            DataRow row;
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                row[j] = 1e4 * j + std::sin(now * 0.01 * (j + 1)) * 50 + i % 17;
+            unbounded.addRow(now, row);
+            capped.addRow(now, row);
+            expected.push_back(std::make_pair(now, row));
+            while (expected.front().first < now - horizon)
+                expected.pop_front();
+            if (i % CHECK_INTERVAL == 0) {
+                check(unbounded, expected.size());
+                check(capped, maxRows);
+            }
+        }
+        if (burst % 5 == 4) {
+            // Age the window between bursts
+            unbounded.removeOlderThan(now + 500 - horizon);
+            capped.removeOlderThan(now + 500 - horizon);
+            while (!expected.empty() && expected.front().first < now + 500 - horizon)
+                expected.pop_front();
+            check(unbounded, expected.size());
+            check(capped, maxRows);
+        }
+    }
+    std::cout << "Unbounded window grew to " << unbounded.capacity() << " rows, capped window to "
+              << capped.capacity() << " (should be 512)" << std::endl;
+    std::cout << numChecks << " checks, mismatched rows or lengths (should be 0): " << numMismatches << std::endl;
+    // Relative to the spread, which for a window of a few rows is close to the rounding of values near 3e4
+    std::cout << "Worst relative error below 1e-10 (should be 1): " << (worstError < 1e-10) << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check the exponentially weighted estimates against their closed form: after n rows, row i carries
+// weight alpha(1 - alpha)^(n-1-i), except the first, which carries (1 - alpha)^(n-1), and the variance
+// is the weighted mean squared deviation from the weighted mean. Then check the half-life on a step.
+void ExponentialStatisticsTest1() {
+    std::cout << "##### ExponentialStatistics Test1: Weighted estimates match their closed form #####" << std::endl;
+
+    ExponentialStatistics<DATAROW_WIDTH> stats = ExponentialStatistics<DATAROW_WIDTH>::fromWindowLength(BUFFER_LENGTH);
+    std::vector<DataRow> rows;
+    double worstError = 0;
+    for (unsigned int i = 0; i < 2000; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = 100 * j + std::sin(i * 0.05 * (j + 1)) * 10 + (i % 7);
+        rows.push_back(row);
+        stats.addRow(row);
+        if (i % 97 != 1)
+            continue;
+
+        const double alpha = stats.alpha();
+        DataRow mean, variance;
+        mean.fill(0);
+        variance.fill(0);
+        std::vector<double> weights(rows.size());
+        for (size_t k = 0; k < rows.size(); k++)
+            weights[k] = (k == 0 ? 1 : alpha) * std::pow(1 - alpha, double(rows.size() - 1 - k));
+        for (size_t k = 0; k < rows.size(); k++)
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                mean[j] += weights[k] * rows[k][j];
+        for (size_t k = 0; k < rows.size(); k++)
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                variance[j] += weights[k] * (rows[k][j] - mean[j]) * (rows[k][j] - mean[j]);
+        DataRow statsMean = stats.getMean(), statsStdDev = stats.getStdDev();
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            const double stdDev = std::sqrt(variance[j]);
+            worstError = std::max(worstError, std::fabs(statsMean[j] - mean[j]) / stdDev);
+            worstError = std::max(worstError, std::fabs(statsStdDev[j] - stdDev) / stdDev);
+        }
+    }
+    std::cout << "Mean: " << stats.getMean() << ", StdDev: " << stats.getStdDev() << std::endl;
+    std::cout << "Worst relative error below 1e-10 (should be 1): " << (worstError < 1e-10) << std::endl;
+
+    // A step from 0 to 1 is halfway there after one half-life
+    ExponentialStatistics<1> step = ExponentialStatistics<1>::fromHalfLife(20);
+    DataContainer<1> zero, one;
+    zero.fill(0);
+    one.fill(1);
+    for (unsigned int i = 0; i < 100; i++)
+        step.addRow(zero);
+    for (unsigned int i = 0; i < 20; i++)
+        step.addRow(one);
+    std::cout << "Mean one half-life after a step (should be 0.5): " << step.getMean()[0] << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Load the same rows from CSV (in several awkward layouts) and from binary, and check they come back
+// exactly and give the stats of adding them directly
+void RowLoaderTest1() {
+    std::cout << "##### RowLoader Test1: CSV and binary files ingest the same rows as addRow #####" << std::endl;
+
+    const unsigned int numRows = 300000;
+    std::vector<DataRow> rows(numRows);
+    for (unsigned int i = 0; i < numRows; i++)
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            rows[i][j] = std::sin(i * 0.37 * (j + 1)) * std::pow(10.0, int(j) - 1) + 1e3 * j;
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> expected;
+    for (auto &row: rows)
+        expected.addRow(row);
+
+    char csvPath[] = "/tmp/informal_test_rows_XXXXXX", binaryPath[] = "/tmp/informal_test_rows_XXXXXX";
+    close(mkstemp(csvPath));
+    close(mkstemp(binaryPath));
+    {
+        std::ofstream csv(csvPath);
+        csv << "a, b, c, d" << std::endl;
+        csv << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for (unsigned int i = 0; i < numRows; i++) {
+            // Vary the separators, blank lines and line endings, and leave the last line unterminated
+            const char *separator = i % 3 == 0 ? "," : (i % 3 == 1 ? ", " : "\t,  ");
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                csv << (j ? separator : "") << rows[i][j];
+            if (i + 1 < numRows)
+                csv << (i % 7 == 0 ? "\r\n" : "\n") << (i % 1000 == 0 ? "\n" : "");
+        }
+        std::ofstream binary(binaryPath, std::ios::binary);
+        binary.write(reinterpret_cast<const char *>(rows.data()), rows.size() * sizeof(DataRow));
+    }
+
+    unsigned int mismatches = 0;
+    for (unsigned int numThreads = 1; numThreads <= 4; numThreads += 3) {
+        RowLoader<DATAROW_WIDTH> csvLoader(csvPath, RowLoader<DATAROW_WIDTH>::Csv, 1, numThreads);
+        RowLoader<DATAROW_WIDTH> binaryLoader(binaryPath, RowLoader<DATAROW_WIDTH>::Binary);
+        // Every row comes back exactly, in order
+        for (auto loader: {&csvLoader, &binaryLoader}) {
+            size_t index = 0;
+            size_t numLoaded = loader->forEachBlock([&](const DataRow *block, size_t numBlockRows) {
+                for (size_t r = 0; r < numBlockRows; r++, index++) {
+                    for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                        mismatches += index >= numRows || block[r][j] != rows[index][j];
+                }
+            });
+            mismatches += numLoaded != numRows || index != numRows;
+        }
+        // Blocks go in through addRows, which may round differently from addRow in the last bit
+        StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> fromCsv, fromBinary;
+        csvLoader.loadInto(fromCsv);
+        binaryLoader.loadInto(fromBinary);
+        DataRow mean = expected.getMean(), stdDev = expected.getStdDev();
+        for (auto buffer: {&fromCsv, &fromBinary}) {
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+                mismatches += std::abs(buffer->getMean()[j] - mean[j]) > 1e-12 * (std::abs(mean[j]) + stdDev[j]);
+                mismatches += std::abs(buffer->getStdDev()[j] - stdDev[j]) > 1e-12 * stdDev[j];
+            }
+        }
+        std::cout << "CSV of " << csvLoader.fileBytes() << " bytes on " << numThreads << " parser threads, binary of "
+                  << binaryLoader.fileBytes() << " bytes, mismatches (should be 0): " << mismatches << std::endl;
+    }
+
+    // A short row in the middle of the file, and a binary file cut mid-row, are both rejected
+    {
+        std::ofstream csv(csvPath, std::ios::app);
+        csv << "\n1, 2, 3\n";
+        std::ofstream binary(binaryPath, std::ios::app | std::ios::binary);
+        binary << 'x';
+    }
+    unsigned int numRejected = 0;
+    try {
+        RowLoader<DATAROW_WIDTH> csvLoader(csvPath, RowLoader<DATAROW_WIDTH>::Csv, 1);
+        StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> statBuffer;
+        csvLoader.loadInto(statBuffer);
+    } catch (const std::runtime_error &error) {
+        std::cout << "Rejected: " << error.what() << std::endl;
+        numRejected++;
+    }
+    try {
+        RowLoader<DATAROW_WIDTH> binaryLoader(binaryPath, RowLoader<DATAROW_WIDTH>::Binary);
+        StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> statBuffer;
+        binaryLoader.loadInto(statBuffer);
+    } catch (const std::runtime_error &error) {
+        std::cout << "Rejected: " << error.what() << std::endl;
+        numRejected++;
+    }
+    std::cout << "Malformed files rejected (should be 2): " << numRejected << std::endl;
+    unlink(csvPath);
+    unlink(binaryPath);
+    std::cout << std::endl << std::endl;
+}
+
+// Row number counter of the persistence test: column 0 is the counter itself, the rest drift slowly
+DataRow persistentTestRow(unsigned long counter) {
+    DataRow row;
+    row[0] = counter;
+    for (unsigned int j = 1; j < DATAROW_WIDTH; j++)
+        row[j] = 1e4 + 0.001 * counter + std::sin(counter * 0.37 * j) * j;
+    return row;
+}
+
+// A child process ingests into the file until it is killed at an arbitrary point; the parent then
+// reattaches and checks the window holds consecutive, untorn rows and stats matching a recompute
+void PersistentStatisticsBufferTest1() {
+    std::cout << "##### PersistentStatisticsBuffer Test1: Reattach after the writer is killed mid-ingest #####" << std::endl;
+
+    typedef PersistentStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> Buffer;
+    char path[] = "/tmp/informal_test_persistent_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+
+    const unsigned int numKills = 16;
+    unsigned int mismatches = 0, numRecovered = 0;
+    unsigned long numIngested = 0;
+    for (unsigned int kill = 0; kill < numKills; kill++) {
+        pid_t child = fork();
+        if (child == 0) {
+            Buffer statBuffer(path);
+            unsigned long counter = statBuffer.isEmpty() ? 0 : statBuffer.getLatestRow()[0] + 1;
+            while (true)
+                statBuffer.addRow(persistentTestRow(counter++));
+        }
+        usleep(10000 + 3371 * kill);
+        ::kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+
+        Buffer statBuffer(path);
+        numRecovered += statBuffer.wasRecovered();
+        if (!statBuffer.wasReattached() || statBuffer.isEmpty()) {
+            mismatches++;
+            continue;
+        }
+        const size_t numRows = statBuffer.currentLength();
+        numIngested = statBuffer.getLatestRow()[0] + 1;
+        if (numRows != std::min<unsigned long>(numIngested, BUFFER_LENGTH))
+            mismatches++;
+        long double exactMean[DATAROW_WIDTH] = {0}, exactSum[DATAROW_WIDTH] = {0};
+        for (size_t k = 0; k < numRows; k++) {
+            const DataRow &row = statBuffer.getRow(k);
+            DataRow expected = persistentTestRow(numIngested - numRows + k);
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+                if (row[j] != expected[j])
+                    mismatches++;
+                exactMean[j] += row[j];
+            }
+        }
+        DataRow mean = statBuffer.getMean(), stdDev = statBuffer.getStdDev();
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            exactMean[j] /= numRows;
+            for (size_t k = 0; k < numRows; k++)
+                exactSum[j] += (statBuffer.getRow(k)[j] - exactMean[j]) * (statBuffer.getRow(k)[j] - exactMean[j]);
+            double exactStdDev = std::sqrt(exactSum[j] / (numRows - 1));
+            if (std::abs(mean[j] - exactMean[j]) > 1e-9 * std::abs(exactMean[j])
+                    || std::abs(stdDev[j] - exactStdDev) > 1e-9 * exactStdDev)
+                mismatches++;
+        }
+    }
+    std::cout << "Killed the writer " << numKills << " times, " << numIngested << " rows ingested in all, "
+              << numRecovered << " unfinished updates rolled back" << std::endl;
+    std::cout << "Rows and stats checked against a recompute after each kill, mismatches (should be 0): "
+              << mismatches << std::endl;
+
+    bool rejected = false;
+    try {
+        PersistentStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH + 1> wrongShape(path);
+    } catch (const std::runtime_error &) {
+        rejected = true;
+    }
+    std::cout << "Attaching with a different width rejected (should be 1): " << rejected << std::endl;
+
+    unsigned int numAttachRejected = 0;
+    {
+        Buffer attached(path);
+        try {
+            Buffer second(path);
+        } catch (const std::runtime_error &) {
+            numAttachRejected++;
+        }
+    }
+    // Once the first is gone the file can be attached again
+    Buffer(path).isEmpty();
+    std::cout << "Second attach while the first is held rejected (should be 1): " << numAttachRejected << std::endl;
+
+    // Damage the fields the buffer indexes with: after the 32-byte header come headIndex, tailIndex
+    // and numRows, K, Ex and Ex2, then the journal's active flag and slot
+    const off_t numRowsOffset = 32 + 2 * sizeof(uint64_t);
+    const off_t activeOffset = 32 + 3 * sizeof(uint64_t) + 3 * sizeof(DataRow);
+    const uint64_t damage[][2] = {{static_cast<uint64_t>(numRowsOffset), BUFFER_LENGTH + 1},
+                                  {static_cast<uint64_t>(activeOffset), 2},
+                                  {static_cast<uint64_t>(activeOffset + sizeof(uint64_t)), BUFFER_LENGTH}};
+    unsigned int numCorruptRejected = 0;
+    for (auto &field: damage) {
+        uint64_t original, value = field[1];
+        fd = open(path, O_RDWR);
+        pread(fd, &original, sizeof(original), field[0]);
+        pwrite(fd, &value, sizeof(value), field[0]);
+        // An out-of-range slot only matters while the journal is active
+        const uint64_t active = 1;
+        if (field[0] == activeOffset + sizeof(uint64_t))
+            pwrite(fd, &active, sizeof(active), activeOffset);
+        close(fd);
+        try {
+            Buffer corrupt(path);
+        } catch (const std::runtime_error &) {
+            numCorruptRejected++;
+        }
+        fd = open(path, O_RDWR);
+        pwrite(fd, &original, sizeof(original), field[0]);
+        if (field[0] == activeOffset + sizeof(uint64_t)) {
+            const uint64_t inactive = 0;
+            pwrite(fd, &inactive, sizeof(inactive), activeOffset);
+        }
+        close(fd);
+    }
+    Buffer restored(path);
+    std::cout << "Files with a row count, journal flag or journal slot out of range rejected (should be 3): "
+              << numCorruptRejected << ", restored file attaches with its rows (should be 1): "
+              << (restored.currentLength() == std::min<unsigned long>(numIngested, BUFFER_LENGTH)) << std::endl;
+    unlink(path);
+    std::cout << std::endl << std::endl;
+}
+
+// Check the column-major buffer against StatisticsBuffer, and its column views against getRow
+void ColumnarStatisticsBufferTest1() {
+    std::cout << "##### ColumnarStatisticsBuffer Test1: Column storage and zero-copy columns #####" << std::endl;
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> statBuffer;
+    ColumnarStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> columnBuffer;
+    for (unsigned int i = 0; i < BUFFER_LENGTH*2 + 17; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = std::cos(i * 0.3 + j) * (j + 1);
+        statBuffer.addRow(row);
+        columnBuffer += row;
+    }
+    statBuffer.removeRows(20);
+    columnBuffer.removeRows(20);
+
+    DataRow mean = statBuffer.getMean(), stdDev = statBuffer.getStdDev();
+    DataRow columnMean = columnBuffer.getMean(), columnStdDev = columnBuffer.getStdDev();
+    std::cout << "Mean: " << columnMean << ", StdDev: " << columnStdDev << std::endl;
+    std::cout << "Stats identical to StatisticsBuffer: "
+              << (std::equal(mean.begin(), mean.end(), columnMean.begin())
+                  && std::equal(stdDev.begin(), stdDev.end(), columnStdDev.begin())) << std::endl;
+
+    bool columnsMatch = true;
+    for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+        RingView<double> column = columnBuffer.getColumn(j);
+        columnsMatch = columnsMatch && column.size() == statBuffer.currentLength();
+        for (unsigned int i = 0; columnsMatch && i < column.size(); i++)
+            columnsMatch = column[i] == statBuffer.getRow(i)[j];
+    }
+    RingView<double> column0 = columnBuffer.getColumn(0);
+    std::cout << "Column 0 spans: " << column0.firstSize << " + " << column0.secondSize
+              << " entries, columns match rows: " << columnsMatch << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check the sliding min/max against a brute-force scan of the rows, through addRow, addRows and removeRows
+void SlidingExtremaTest1() {
+    std::cout << "##### SlidingExtrema Test1: Sliding-window min/max #####" << std::endl;
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, SlidingExtrema> statBuffer;
+    std::array<DataRow, 30> block;
+    unsigned int numChecks = 0, numMismatches = 0;
+    for (unsigned int i = 0; i < BUFFER_LENGTH*10; i++) {
+        DataRow row;
+        row[0] = i;                         // increasing
+        row[1] = -1.0*i;                    // decreasing
+        row[2] = (i * 7919) % 101;          // scattered, with repeats
+        row[3] = std::sin(i * 0.05) * 10;   // smooth
+        if (i % 200 < 60) {
+            block[i % 30] = row;
+            if (i % 30 == 29)
+                statBuffer.addRows(block.data(), block.size());
+        } else {
+            statBuffer.addRow(row);
+        }
+        if (i % 37 == 0 && !statBuffer.isEmpty())
+            statBuffer.removeRows(i % 11);
+        if (statBuffer.isEmpty())
+            continue;
+
+        DataRow expectedMin = statBuffer.getRow(0), expectedMax = statBuffer.getRow(0);
+        for (unsigned int k = 1; k < statBuffer.currentLength(); k++) {
+            DataRow other = statBuffer.getRow(k);
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+                expectedMin[j] = std::min(expectedMin[j], other[j]);
+                expectedMax[j] = std::max(expectedMax[j], other[j]);
+            }
+        }
+        DataRow min = statBuffer.getMin(), max = statBuffer.getMax();
+        numChecks++;
+        if (!std::equal(min.begin(), min.end(), expectedMin.begin())
+                || !std::equal(max.begin(), max.end(), expectedMax.begin()))
+            numMismatches++;
+    }
+    std::cout << "Min: " << statBuffer.getMin() << ", Max: " << statBuffer.getMax() << std::endl;
+    std::cout << "Checks against a full scan: " << numChecks << ", mismatches (should be 0): "
+              << numMismatches << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check the covariance and correlation matrices against a two-pass scan of the window, through
+// row and block ingest and removal, on correlated columns with a large offset
+void SlidingCovarianceTest1() {
+    std::cout << "##### SlidingCovariance Test1: Sliding-window covariance and correlation #####" << std::endl;
+
+    typedef SlidingCovariance<BUFFER_LENGTH, DATAROW_WIDTH>::Matrix Matrix;
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, SlidingCovariance> statBuffer;
+    std::array<DataRow, 20> block;
+    unsigned int numChecks = 0, numMismatches = 0;
+    for (unsigned int i = 0; i < BUFFER_LENGTH*20; i++) {
+        DataRow row;
+        row[0] = std::sin(i * 0.37) * 10;
+        row[1] = 2 * row[0] + std::cos(i * 1.3);        // strongly correlated with column 0
+        row[2] = 1e6 + 0.01 * i - row[0];               // anti-correlated, offset and drifting
+        row[3] = (i * 7919) % 101;                      // unrelated
+        if (i % 300 < 100) {
+            block[i % 20] = row;
+            if (i % 20 == 19)
+                statBuffer.addRows(block.data(), block.size());
+        } else {
+            statBuffer.addRow(row);
+        }
+        if (i % 41 == 0 && !statBuffer.isEmpty())
+            statBuffer.removeRows(i % 13);
+        if (statBuffer.currentLength() < 2)
+            continue;
+
+        const size_t length = statBuffer.currentLength();
+        long double mean[DATAROW_WIDTH] = {0};
+        for (unsigned int k = 0; k < length; k++) {
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                mean[j] += statBuffer.getRow(k)[j];
+        }
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            mean[j] /= length;
+        long double expected[DATAROW_WIDTH][DATAROW_WIDTH] = {{0}};
+        for (unsigned int k = 0; k < length; k++) {
+            DataRow other = statBuffer.getRow(k);
+            for (unsigned int a = 0; a < DATAROW_WIDTH; a++) {
+                for (unsigned int b = 0; b < DATAROW_WIDTH; b++)
+                    expected[a][b] += (other[a] - mean[a]) * (other[b] - mean[b]) / (length - 1);
+            }
+        }
+
+        Matrix covariance = statBuffer.getCovariance(), correlation = statBuffer.getCorrelation();
+        for (unsigned int a = 0; a < DATAROW_WIDTH; a++) {
+            for (unsigned int b = 0; b < DATAROW_WIDTH; b++) {
+                double scale = std::sqrt(static_cast<double>(expected[a][a] * expected[b][b]));
+                double expectedCorrelation = expected[a][b] / scale;
+                numChecks++;
+                if (std::abs(covariance[a][b] - expected[a][b]) > 1e-8 * scale
+                        || std::abs(correlation[a][b] - expectedCorrelation) > 1e-8)
+                    numMismatches++;
+            }
+        }
+    }
+    Matrix correlation = statBuffer.getCorrelation();
+    std::cout << "Correlation:" << std::endl;
+    for (auto &correlationRow: correlation)
+        std::cout << "  " << correlationRow << std::endl;
+    std::cout << "Variances: ";
+    for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+        std::cout << statBuffer.getCovariance()[j][j] << " ";
+    std::cout << ", StdDev squared: " << statBuffer.getStdDev().Pow(2) << std::endl;
+    std::cout << "Checks against a two-pass scan: " << numChecks << ", mismatches (should be 0): "
+              << numMismatches << std::endl;
+
+    // Emptying the window row by row must leave nothing behind for the rows that follow
+    while (!statBuffer.isEmpty())
+        statBuffer.removeRows(1);
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, SlidingCovariance> freshBuffer;
+    for (unsigned int i = 0; i < 50; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = -3e5 + std::cos(i * 0.7 + j) * (j + 1);
+        statBuffer.addRow(row);
+        freshBuffer.addRow(row);
+    }
+    unsigned int numDiffering = 0;
+    for (unsigned int a = 0; a < DATAROW_WIDTH; a++) {
+        for (unsigned int b = 0; b < DATAROW_WIDTH; b++) {
+            if (statBuffer.getCovariance()[a][b] != freshBuffer.getCovariance()[a][b])
+                numDiffering++;
+        }
+    }
+    std::cout << "Covariances differing from a fresh buffer after emptying (should be 0): " << numDiffering
+              << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check sliding quantiles against sorting a copy of the window, with both trackers combined
+void SlidingQuantilesTest1() {
+    std::cout << "##### SlidingQuantiles Test1: Exact sliding-window quantiles #####" << std::endl;
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, SlidingExtrema, SlidingQuantiles> statBuffer;
+    const double quantiles[] = {0, 0.25, 0.5, 0.95, 0.99, 1};
+    unsigned int numChecks = 0, numMismatches = 0;
+    for (unsigned int i = 0; i < BUFFER_LENGTH*6; i++) {
+        DataRow row;
+        row[0] = i;
+        row[1] = (i * 7919) % 13;           // many duplicates
+        row[2] = std::sin(i * 0.37) * 100;
+        row[3] = (i % 2) ? 1e9 : -1e9;
+        statBuffer.addRow(row);
+        if (i % 23 == 0)
+            statBuffer.removeRows(5);
+        if (statBuffer.isEmpty())
+            continue;
+
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            std::vector<double> column;
+            for (unsigned int k = 0; k < statBuffer.currentLength(); k++)
+                column.push_back(statBuffer.getRow(k)[j]);
+            std::sort(column.begin(), column.end());
+            for (auto q: quantiles) {
+                double rank = (column.size() - 1) * q;
+                size_t lower = static_cast<size_t>(rank), upper = std::min(lower + 1, column.size() - 1);
+                double expected = column[lower] + (column[upper] - column[lower]) * (rank - lower);
+                numChecks++;
+                if (std::abs(statBuffer.getQuantile(q)[j] - expected) > 1e-9 * std::abs(expected))
+                    numMismatches++;
+            }
+        }
+    }
+    std::cout << "Median: " << statBuffer.getMedian() << ", p99: " << statBuffer.getQuantile(0.99) << std::endl;
+    std::cout << "Min: " << statBuffer.getMin() << ", p0: " << statBuffer.getQuantile(0) << std::endl;
+    std::cout << "Checks against sorting the window: " << numChecks << ", mismatches (should be 0): "
+              << numMismatches << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Push NaN and +-inf through full windows and out again: each must be evicted, and the
+// quantiles must match sorting the window with NaN placed after +inf
+void SlidingQuantilesTest2() {
+    std::cout << "##### SlidingQuantiles Test2: NaN and infinities through the window #####" << std::endl;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN(), inf = std::numeric_limits<double>::infinity();
+    const double specials[] = {nan, inf, -inf, 2.5, nan, -1};
+    StatisticsBuffer<8, 1, SlidingQuantiles> statBuffer;
+    const double quantiles[] = {0, 0.3, 0.5, 0.9, 1};
+    unsigned int numChecks = 0, numMismatches = 0;
+    for (unsigned int i = 0; i < 8 * 10; i++) {
+        // Specials for the first half, then only finite values to flush them all out
+        DataContainer<1> row;
+        row[0] = i < 8 * 5 ? specials[(i * 5) % 6] : std::sin(i * 0.37);
+        statBuffer.addRow(row);
+        if (i % 13 == 12)
+            statBuffer.removeRows(3);
+        if (statBuffer.isEmpty())
+            continue;
+
+        std::vector<double> column;
+        for (unsigned int k = 0; k < statBuffer.currentLength(); k++)
+            column.push_back(statBuffer.getRow(k)[0]);
+        std::sort(column.begin(), column.end(), [](double a, double b) {
+            return std::isnan(b) ? !std::isnan(a) : a < b;
+        });
+        for (auto q: quantiles) {
+            double rank = (column.size() - 1) * q;
+            size_t lower = static_cast<size_t>(rank), upper = std::min(lower + 1, column.size() - 1);
+            double low = column[lower], high = column[upper];
+            double expected = rank == lower || low == high ? low : low + (high - low) * (rank - lower);
+            double actual = statBuffer.getQuantile(q)[0];
+            numChecks++;
+            if (!(actual == expected || (std::isnan(actual) && std::isnan(expected))))
+                numMismatches++;
+        }
+    }
+    std::cout << "Checks against sorting the window: " << numChecks << ", mismatches (should be 0): "
+              << numMismatches << std::endl;
+    std::cout << "Max once the specials are evicted (should be finite): " << statBuffer.getQuantile(1) << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Approximate quantiles against sorting the window, over columns spanning many powers of two, of
+// both signs, with duplicates and with zeros. Each should be within 1/128 of the larger magnitude
+// of the two order statistics the exact quantile interpolates between.
+void SlidingHistogramTest1() {
+    std::cout << "##### SlidingHistogram Test1: Approximate quantiles within the error bound #####" << std::endl;
+
+    std::vector<double> testdata;
+    std::ifstream infile("test_data.txt");
+    std::string line = "";
+    while (std::getline(infile, line))
+        testdata.push_back(std::stod(line));
+
+    StatisticsBuffer<BUFFER_LENGTH * 4, DATAROW_WIDTH, SlidingHistogram> statBuffer;
+    const double quantiles[] = {0, 0.01, 0.25, 0.5, 0.95, 0.99, 1};
+    unsigned int numChecks = 0, numViolations = 0, histogramMismatches = 0;
+    double maxRelativeError = 0;
+    for (unsigned int i = 0; i < BUFFER_LENGTH * 40; i++) {
+        const double x = testdata[i % testdata.size()];
+        DataRow row;
+        row[0] = std::exp(4 * x);                 // positive, skewed over a few powers of ten
+        row[1] = x;                               // both signs
+        row[2] = (i * 7919) % 13 - 6;             // many duplicates, and zeros
+        row[3] = (i % 3 ? 1e6 : -1e-6) * (1 + x * x);
+        statBuffer.addRow(row);
+        if (i % 23 == 0)
+            statBuffer.removeRows(7);
+        if (i % 11 != 0 || statBuffer.isEmpty())
+            continue;
+
+        const size_t n = statBuffer.currentLength();
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+            std::vector<double> column;
+            for (unsigned int k = 0; k < n; k++)
+                column.push_back(statBuffer.getRow(k)[j]);
+            std::sort(column.begin(), column.end());
+            for (auto q: quantiles) {
+                double rank = (n - 1) * q;
+                size_t lower = static_cast<size_t>(rank), upper = std::min(lower + 1, n - 1);
+                double expected = column[lower] + (column[upper] - column[lower]) * (rank - lower);
+                double bound = std::max(std::abs(column[lower]), std::abs(column[upper])) / 128;
+                double error = std::abs(statBuffer.getQuantile(q)[j] - expected);
+                numChecks++;
+                if (error > bound * (1 + 1e-12))
+                    numViolations++;
+                if (bound > 0)
+                    maxRelativeError = std::max(maxRelativeError, error / bound / 128);
+            }
+
+            size_t total = 0;
+            double previousUpper = -std::numeric_limits<double>::infinity();
+            for (const HistogramBin &bin: statBuffer.getHistogram(j)) {
+                if (bin.count == 0 || bin.lower >= bin.upper || bin.lower < previousUpper)
+                    histogramMismatches++;
+                previousUpper = bin.upper;
+                total += bin.count;
+            }
+            if (total != n)
+                histogramMismatches++;
+        }
+    }
+    std::cout << "Median: " << statBuffer.getMedian() << ", p99: " << statBuffer.getQuantile(0.99) << std::endl;
+    std::cout << "Checks against sorting the window: " << numChecks << ", outside the bound (should be 0): "
+              << numViolations << ", max error relative to the larger order statistic (should be below 0.0079): "
+              << maxRelativeError << std::endl;
+    std::cout << "Histograms out of order or not summing to the rows (should be 0): " << histogramMismatches
+              << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+template <size_t T_length, size_t T_width>
+using WideHistogram = BasicSlidingHistogram<T_length, T_width, -8, 48>;
+
+// Values past the default range, infinities and NaN, through several full windows. Column 0 holds
+// +-1e12 and +-inf now and then, column 1 NaN every third row, column 2 nothing but NaN.
+void SlidingHistogramTest2() {
+    std::cout << "##### SlidingHistogram Test2: Out-of-range values, infinities and NaN #####" << std::endl;
+
+    const size_t length = 50, width = 3;
+    const double nan = std::numeric_limits<double>::quiet_NaN(), inf = std::numeric_limits<double>::infinity();
+    StatisticsBuffer<length, width, SlidingHistogram> statBuffer;
+    StatisticsBuffer<length, width, WideHistogram> wideBuffer;
+    const double quantiles[] = {0, 0.1, 0.5, 0.9, 1};
+    unsigned int numChecks = 0, numDefaultWrong = 0, numWideWrong = 0, numNanWrong = 0, histogramMismatches = 0;
+    for (unsigned int i = 0; i < length * 6; i++) {
+        DataContainer<width> row;
+        row[0] = i % 17 == 0 ? (i % 2 ? 1e12 : -1e12) : i % 29 == 0 ? (i % 2 ? inf : -inf) : 100.0 + i % 13;
+        row[1] = i % 3 == 0 ? nan : 0.5 * (i % 7);
+        row[2] = nan;
+        statBuffer.addRow(row);
+        wideBuffer.addRow(row);
+
+        // Each column's non-NaN values, sorted, against which both buffers are checked
+        std::vector<double> columns[width];
+        for (unsigned int k = 0; k < statBuffer.currentLength(); k++) {
+            for (unsigned int j = 0; j < width; j++) {
+                if (!std::isnan(statBuffer.getRow(k)[j]))
+                    columns[j].push_back(statBuffer.getRow(k)[j]);
+            }
+        }
+        for (unsigned int j = 0; j < 2; j++) {
+            std::vector<double> &column = columns[j];
+            std::sort(column.begin(), column.end());
+            const size_t n = column.size();
+            if (n == 0) {
+                numNanWrong += !std::isnan(statBuffer.getMedian()[j]);
+                continue;
+            }
+            for (auto q: quantiles) {
+                const double rank = (n - 1) * q;
+                const size_t lower = static_cast<size_t>(rank), upper = std::min(lower + 1, n - 1);
+                const double fraction = rank - lower;
+                // The default range sees 1e12 as infinite, the wide one within its bound
+                const bool inRange = std::abs(column[lower]) < 4e9 && (fraction == 0 || std::abs(column[upper]) < 4e9);
+                const double bound = std::max(std::abs(column[lower]), std::abs(column[upper])) / 128 * (1 + 1e-12);
+                const double got = statBuffer.getQuantile(q)[j], wide = wideBuffer.getQuantile(q)[j];
+                if (std::isinf(column[lower]) || (fraction > 0 && std::isinf(column[upper]))) {
+                    const double expected = std::isinf(column[lower]) ? column[lower] : column[upper];
+                    numDefaultWrong += got != expected;
+                    numWideWrong += wide != expected;
+                } else {
+                    const double expected = column[lower] + (column[upper] - column[lower]) * fraction;
+                    if (inRange)
+                        numDefaultWrong += !(std::abs(got - expected) <= bound);
+                    else
+                        numDefaultWrong += !std::isinf(got) || (got > 0) != (expected > 0);
+                    numWideWrong += !(std::abs(wide - expected) <= bound);
+                }
+                numChecks++;
+            }
+        }
+        numNanWrong += !std::isnan(statBuffer.getMedian()[2]);
+
+        for (unsigned int j = 0; j < width; j++) {
+            size_t total = 0;
+            for (const HistogramBin &bin: statBuffer.getHistogram(j))
+                total += bin.count;
+            histogramMismatches += total != statBuffer.currentLength();
+        }
+    }
+    std::cout << numChecks << " quantiles checked, wrong with the default range (should be 0): " << numDefaultWrong
+              << ", with a range of 2^-8 to 2^48 (should be 0): " << numWideWrong << std::endl;
+    std::cout << "Medians of an all-NaN column not NaN (should be 0): " << numNanWrong << std::endl;
+    std::cout << "Histograms not summing to the rows, NaN bin included (should be 0): " << histogramMismatches
+              << std::endl;
+    std::cout << "Final min: " << statBuffer.getQuantile(0) << ", max: " << statBuffer.getQuantile(1) << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check every level of a three-level pyramid against a two-pass scan of the rows it should cover
+void StatisticsPyramidTest1() {
+    std::cout << "##### StatisticsPyramid Test1: Multi-resolution windows from one ingest #####" << std::endl;
+
+    const size_t rowsPerBucket = 10, bucketsPerLevel = 6, numLevels = 3;
+    StatisticsPyramid<rowsPerBucket, DATAROW_WIDTH, bucketsPerLevel, numLevels> pyramid;
+    std::vector<DataRow> allRows;
+    std::array<DataRow, 17> block;
+    size_t blockSize = 0;
+    unsigned int numChecks = 0, numMismatches = 0;
+    for (unsigned int i = 0; i < 3000; i++) {
+        DataRow row;
+        row[0] = std::sin(i * 0.37) * 10;
+        row[1] = 1e6 + 0.5 * i;                 // offset and drifting
+        row[2] = (i * 7919) % 101;
+        row[3] = (i % 500 < 250) ? i : -1.0*i;
+        allRows.push_back(row);
+        if (i % 400 < 170) {
+            block[blockSize++] = row;
+            if (blockSize < block.size() && i % 400 != 169)
+                continue;
+            pyramid.addRows(block.data(), blockSize);
+            blockSize = 0;
+        } else {
+            pyramid.addRow(row);
+        }
+
+        for (size_t level = 0; level < numLevels; level++) {
+            const size_t length = pyramid.currentLength(level);
+            // level 0 is the last rowsPerBucket rows; level 1 adds whole buckets of 10 and level 2 of 60
+            size_t bucketRows = level == 0 ? 1 : rowsPerBucket;
+            for (size_t k = 1; k < level; k++)
+                bucketRows *= bucketsPerLevel;
+            size_t numBuckets = level == 0 ? rowsPerBucket : bucketsPerLevel;
+            size_t expectedLength = std::min<size_t>(allRows.size(),
+                    allRows.size() % bucketRows + numBuckets * bucketRows);
+
+            DataRow min = allRows[allRows.size() - length], max = min;
+            long double mean[DATAROW_WIDTH] = {0}, sumSquares[DATAROW_WIDTH] = {0};
+            for (size_t k = allRows.size() - length; k < allRows.size(); k++) {
+                for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+                    mean[j] += allRows[k][j];
+                    min[j] = std::min(min[j], allRows[k][j]);
+                    max[j] = std::max(max[j], allRows[k][j]);
+                }
+            }
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                mean[j] /= length;
+            for (size_t k = allRows.size() - length; k < allRows.size(); k++) {
+                for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                    sumSquares[j] += (allRows[k][j] - mean[j]) * (allRows[k][j] - mean[j]);
+            }
+
+            DataRow pyramidMean = pyramid.getMean(level), pyramidStdDev = pyramid.getStdDev(level);
+            DataRow pyramidMin = pyramid.getMin(level), pyramidMax = pyramid.getMax(level);
+            bool matches = length == expectedLength
+                           && std::equal(min.begin(), min.end(), pyramidMin.begin())
+                           && std::equal(max.begin(), max.end(), pyramidMax.begin());
+            for (unsigned int j = 0; matches && j < DATAROW_WIDTH; j++) {
+                double stdDev = length > 1 ? std::sqrt(static_cast<double>(sumSquares[j] / (length - 1))) : 0;
+                matches = std::abs(pyramidMean[j] - mean[j]) <= 1e-9 * (std::abs(mean[j]) + 1)
+                          && (length < 2 || std::abs(pyramidStdDev[j] - stdDev) <= 1e-9 * (stdDev + 1));
+            }
+            numChecks++;
+            if (!matches)
+                numMismatches++;
+        }
+    }
+    for (size_t level = 0; level < numLevels; level++) {
+        std::cout << "Level " << level << ": length " << pyramid.currentLength(level)
+                  << ", Mean: " << pyramid.getMean(level) << ", StdDev: " << pyramid.getStdDev(level) << std::endl;
+    }
+    std::cout << "Checks against a two-pass scan: " << numChecks << ", mismatches (should be 0): "
+              << numMismatches << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+// Check that every SIMD instruction set gives bit-identical results to the scalar kernels.
+// The width is odd so that the scalar tail of each vector loop is exercised too.
+// Score the test data, with a spike injected into one column every 97 rows, against the
+// thresholds, and check the masks and z-scores against getMean() and getStdDev() taken before
+// each row is added. Rows within rounding of a threshold are left out of the mask comparison.
+void ZScoreTest1() {
+    std::cout << "##### ZScore Test1: addRowScored against the mean and std-dev before each row #####" << std::endl;
+
+    std::vector<double> testdata;
+    std::ifstream infile("test_data.txt");
+    std::string line = "";
+    while (std::getline(infile, line))
+        testdata.push_back(std::stod(line));
+
+    DataRow thresholdValues;
+    thresholdValues[0] = 2.5;
+    thresholdValues[1] = 3;
+    thresholdValues[2] = 3;
+    thresholdValues[3] = 4;
+    ZScoreThresholds<DATAROW_WIDTH> thresholds(thresholdValues);
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> statBuffer;
+    BasicStatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, float> floatBuffer;
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, HigherMoments> momentBuffer;
+    // The same rows added unscored, whose sums the scored buffers must match exactly
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> plainBuffer;
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, HigherMoments> plainMomentBuffer;
+    unsigned int maskMismatches = 0, floatMismatches = 0, numCallbacks = 0, numFlaggedRows = 0, spikesMissed = 0;
+    unsigned int sumMismatches = 0;
+    double maxZScoreError = 0;
+    for (unsigned int i = 0; i < 4000; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = static_cast<float>(testdata[(i * (j + 1)) % testdata.size()]);
+        const bool spike = i % 97 == 96;
+        if (spike)
+            row[i % DATAROW_WIDTH] += 50;
+
+        ColumnMask<DATAROW_WIDTH> expected;
+        DataRow expectedZScores;
+        bool nearThreshold = false;
+        if (statBuffer.currentLength() >= 2) {
+            DataRow mean = statBuffer.getMean(), stdDev = statBuffer.getStdDev();
+            for (unsigned int j = 0; j < DATAROW_WIDTH; j++) {
+                expectedZScores[j] = (row[j] - mean[j]) / stdDev[j];
+                expected[j] = std::abs(expectedZScores[j]) > thresholds.getThreshold(j);
+                nearThreshold |= std::abs(std::abs(expectedZScores[j]) - thresholds.getThreshold(j)) < 1e-9;
+            }
+        }
+
+        ColumnMask<DATAROW_WIDTH> calledWith;
+        ColumnMask<DATAROW_WIDTH> mask = statBuffer.addRowScored(row, thresholds,
+                [&](const ColumnMask<DATAROW_WIDTH> &flagged, const DataRow &zScores) {
+                    numCallbacks++;
+                    calledWith = flagged;
+                    for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+                        maxZScoreError = std::max(maxZScoreError, std::abs(zScores[j] - expectedZScores[j]));
+                });
+        ColumnMask<DATAROW_WIDTH> floatMask = floatBuffer.addRowScored(DataContainer<DATAROW_WIDTH, float>(row),
+                thresholds, [](const ColumnMask<DATAROW_WIDTH> &, const DataRow &) {});
+        ColumnMask<DATAROW_WIDTH> momentMask = momentBuffer.addRowScored(row, thresholds,
+                [](const ColumnMask<DATAROW_WIDTH> &, const DataRow &) {});
+        plainBuffer.addRow(row);
+        plainMomentBuffer.addRow(row);
+
+        if (mask.any())
+            numFlaggedRows++;
+        if (!nearThreshold && mask != expected)
+            maskMismatches++;
+        if (mask != calledWith || floatMask != mask || momentMask != mask)
+            floatMismatches++;
+        // From two rows on, where no statistic is NaN
+        if (statBuffer.currentLength() >= 2
+                && (statBuffer.getMean() != plainBuffer.getMean() || statBuffer.getStdDev() != plainBuffer.getStdDev()
+                    || momentBuffer.getSkewness() != plainMomentBuffer.getSkewness()
+                    || momentBuffer.getKurtosis() != plainMomentBuffer.getKurtosis()))
+            sumMismatches++;
+        if (spike && statBuffer.currentLength() > 2 && !mask[i % DATAROW_WIDTH])
+            spikesMissed++;
+        if (i % 500 == 499) {
+            statBuffer.removeRows(BUFFER_LENGTH - 1);
+            floatBuffer.removeRows(BUFFER_LENGTH - 1);
+            momentBuffer.removeRows(BUFFER_LENGTH - 1);
+            plainBuffer.removeRows(BUFFER_LENGTH - 1);
+            plainMomentBuffer.removeRows(BUFFER_LENGTH - 1);
+        }
+    }
+    std::cout << "Rows flagged: " << numFlaggedRows << ", callbacks (should be the same): " << numCallbacks
+              << ", spikes missed (should be 0): " << spikesMissed << std::endl;
+    std::cout << "Masks differing from getMean()/getStdDev() (should be 0): " << maskMismatches
+              << ", from the callback's or a float or HigherMoments buffer's (should be 0): " << floatMismatches
+              << std::endl;
+    std::cout << "Rows after which the statistics differ from those of addRow() (should be 0): " << sumMismatches
+              << std::endl;
+    std::cout << "Max error of the z-scores passed to the callback (should be below 1e-9): " << maxZScoreError
+              << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+void InstrumentationTest1() {
+    std::cout << "##### Instrumentation Test1: Counters and timings of an Instrumented buffer #####" << std::endl;
+
+    std::vector<double> testdata;
+    std::ifstream infile("test_data.txt");
+    std::string line = "";
+    while (std::getline(infile, line))
+        testdata.push_back(std::stod(line));
+
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH> plainBuffer;
+    StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, Instrumented> statBuffer;
+    BufferInstrumentation &instrumentation = statBuffer.getInstrumentation();
+    instrumentation.setSampleInterval(1);
+
+    uint64_t added = 0, evicted = 0, removed = 0, queries = 0;
+    unsigned int statMismatches = 0;
+    std::vector<DataRow> block;
+    for (unsigned int i = 0; i < 1000; i++) {
+        DataRow row;
+        for (unsigned int j = 0; j < DATAROW_WIDTH; j++)
+            row[j] = testdata[(i * (j + 1)) % testdata.size()];
+        block.push_back(row);
+        if (i % 7 == 6) {
+            // Blocks of 7, and now and then one longer than the buffer
+            if (i % 140 == 139) {
+                block.insert(block.end(), BUFFER_LENGTH, row);
+            }
+            const size_t before = statBuffer.currentLength();
+            statBuffer.addRows(block.data(), block.size());
+            plainBuffer.addRows(block.data(), block.size());
+            added += block.size();
+            evicted += before + block.size() - statBuffer.currentLength();
+            block.clear();
+        } else {
+            if (statBuffer.isFull())
+                evicted++;
+            statBuffer.addRow(row);
+            plainBuffer.addRow(row);
+            added++;
+        }
+        if (i % 50 == 49) {
+            const size_t before = statBuffer.currentLength();
+            statBuffer.removeRows(13);
+            plainBuffer.removeRows(13);
+            removed += before - statBuffer.currentLength();
+        }
+        if (!statBuffer.isEmpty()) {
+            // The std-dev of a single row is NaN, so is only compared from two rows on
+            const DataRow stdDev = statBuffer.getStdDev();
+            if (statBuffer.getMean() != plainBuffer.getMean()
+                    || (statBuffer.currentLength() >= 2 && stdDev != plainBuffer.getStdDev()))
+                statMismatches++;
+            queries++;
+        }
+    }
+
+    std::cout << "Statistics differing from an uninstrumented buffer (should be 0): " << statMismatches << std::endl;
+    std::cout << "Rows added " << instrumentation.getRowsAdded() << " (should be " << added << "), evicted "
+              << instrumentation.getRowsEvicted() << " (should be " << evicted << "), removed "
+              << instrumentation.getRowsRemoved() << " (should be " << removed << ")" << std::endl;
+    std::cout << "Calls of addRow " << instrumentation.getCalls(BufferInstrumentation::AddRow) << ", addRows "
+              << instrumentation.getCalls(BufferInstrumentation::AddRows) << ", removeRows "
+              << instrumentation.getCalls(BufferInstrumentation::RemoveRows) << " (should be 858, 142, 20)" << std::endl;
+    std::cout << "Calls of getMean " << instrumentation.getCalls(BufferInstrumentation::GetMean) << ", getStdDev "
+              << instrumentation.getCalls(BufferInstrumentation::GetStdDev) << " (should both be " << queries << ")"
+              << std::endl;
+
+    unsigned int histogramMismatches = 0;
+    for (unsigned int op = 0; op < BufferInstrumentation::numOperations; op++) {
+        const BufferInstrumentation::Operation operation = static_cast<BufferInstrumentation::Operation>(op);
+        const std::array<uint64_t, BufferInstrumentation::numLatencyBins> histogram =
+            instrumentation.getLatencyHistogram(operation);
+        const uint64_t total = std::accumulate(histogram.begin(), histogram.end(), uint64_t(0));
+        if (total != instrumentation.getSampledCalls(operation)
+                || instrumentation.getSampledCalls(operation) != instrumentation.getCalls(operation))
+            histogramMismatches++;
+    }
+    std::cout << "Operations whose histograms do not count every call at a sample interval of 1 (should be 0): "
+              << histogramMismatches << std::endl;
+
+    // One call in 64 timed, from the first
+    const size_t evictedAfterClear = 1000 - (BUFFER_LENGTH - statBuffer.currentLength());
+    instrumentation.clear();
+    instrumentation.setSampleInterval(64);
+    for (unsigned int i = 0; i < 1000; i++)
+        statBuffer.addRow(block.empty() ? plainBuffer.getLatestRow() : block.back());
+    std::cout << "Of 1000 addRow calls after clear(), timed at an interval of 64: "
+              << instrumentation.getSampledCalls(BufferInstrumentation::AddRow) << " (should be 16)" << std::endl;
+
+    std::ostringstream json;
+    instrumentation.dumpJson(json);
+    const bool jsonComplete = json.str().find("\"rows_evicted\": " + std::to_string(evictedAfterClear)) != std::string::npos
+                              && json.str().find("\"addRow\": {\"calls\": 1000, \"timed\": 16") != std::string::npos
+                              && json.str().find("getMean") == std::string::npos;
+    std::cout << "JSON dump has the counts of the calls made, and only those (should be 1): " << jsonComplete
+              << std::endl;
+    instrumentation.dumpText(std::cout);
+
+    // Const queries from several threads at once, each counted
+    const unsigned int numReaders = 4, queriesPerReader = 20000;
+    const StatisticsBuffer<BUFFER_LENGTH, DATAROW_WIDTH, Instrumented> &constBuffer = statBuffer;
+    const uint64_t meansBefore = instrumentation.getCalls(BufferInstrumentation::GetMean);
+    std::vector<std::thread> readers;
+    for (unsigned int r = 0; r < numReaders; r++) {
+        readers.push_back(std::thread([&constBuffer]() {
+            for (unsigned int q = 0; q < queriesPerReader; q++)
+                constBuffer.getMean();
+        }));
+    }
+    for (auto &reader: readers)
+        reader.join();
+    std::cout << "Calls of getMean from " << numReaders << " threads: "
+              << instrumentation.getCalls(BufferInstrumentation::GetMean) - meansBefore << " (should be "
+              << numReaders * queriesPerReader << ")" << std::endl;
+    std::cout << "Size added by Instrumented: " << sizeof(statBuffer) - sizeof(plainBuffer)
+              << " (should be that of BufferInstrumentation, " << sizeof(BufferInstrumentation) << ")" << std::endl;
+    std::cout << std::endl << std::endl;
+}
+
+void ColumnKernelsTest1() {
+    std::cout << "##### ColumnKernels Test1: SIMD dispatch matches scalar #####" << std::endl;
+
+    const size_t width = 13;
+    StatisticsBuffer<BUFFER_LENGTH, width> statBuffers[ColumnKernels::AVX512 + 1];
+    StatisticsBuffer<BUFFER_LENGTH, width, MeanOnly> meanBuffers[ColumnKernels::AVX512 + 1];
+    StatisticsBuffer<BUFFER_LENGTH, width, HigherMoments> momentBuffers[ColumnKernels::AVX512 + 1];
+    DataContainer<width> zScoreSums[ColumnKernels::AVX512 + 1];
+    DataContainer<width> momentZScoreSums[ColumnKernels::AVX512 + 1];
+    DataContainer<width> operatorResults[ColumnKernels::AVX512 + 1];
+    std::vector<ExponentialStatistics<width> > decayed(ColumnKernels::AVX512 + 1, ExponentialStatistics<width>(0.1));
+
+    ColumnKernels::InstructionSet supported = ColumnKernels::supportedInstructionSet();
+    std::cout << "Supported instruction set: " << ColumnKernels::instructionSetName(supported) << std::endl;
+    for (int set = ColumnKernels::Scalar; set <= supported; set++) {
+        ColumnKernels::setInstructionSet(static_cast<ColumnKernels::InstructionSet>(set));
+        DataContainer<width> row, scale, temp;
+        scale.fill(0.5);
+        operatorResults[set].fill(0);
+        zScoreSums[set].fill(0);
+        momentZScoreSums[set].fill(0);
+        for (unsigned int i = 0; i < BUFFER_LENGTH*3; i++) {
+            for (unsigned int j = 0; j < width; j++)
+                row[j] = std::sin(i * 0.37 + j) * (j + 1) + 100;
+            DataContainer<width> &zScoreSum = zScoreSums[set];
+            statBuffers[set].addRowScored(row, ZScoreThresholds<width>(1.0),
+                    [&zScoreSum](const ColumnMask<width> &, const DataContainer<width> &zScores) {
+                        zScoreSum += zScores;
+                    });
+            DataContainer<width> &momentZScoreSum = momentZScoreSums[set];
+            momentBuffers[set].addRowScored(row, ZScoreThresholds<width>(1.0),
+                    [&momentZScoreSum](const ColumnMask<width> &, const DataContainer<width> &zScores) {
+                        momentZScoreSum += zScores;
+                    });
+            meanBuffers[set].addRow(row);
+            decayed[set].addRow(row);
+            temp = row - scale;
+            temp = temp.Pow(2);
+            temp = temp / 3;
+            operatorResults[set] += temp.Sqrt();
+        }
+        statBuffers[set].removeRows(BUFFER_LENGTH / 3);
+        meanBuffers[set].removeRows(BUFFER_LENGTH / 3);
+        momentBuffers[set].removeRows(BUFFER_LENGTH / 3);
+
+        // A block that fills the freed slots and then evicts, through the add and replace block kernels
+        std::vector<DataContainer<width> > block(BUFFER_LENGTH / 2);
+        for (unsigned int i = 0; i < block.size(); i++)
+            for (unsigned int j = 0; j < width; j++)
+                block[i][j] = std::cos(i * 0.29 + j) * (j + 2) + 100;
+        statBuffers[set].addRows(block.data(), block.size());
+        meanBuffers[set].addRows(block.data(), block.size());
+        momentBuffers[set].addRows(block.data(), block.size());
+    }
+    ColumnKernels::setInstructionSet(supported);
+
+    for (int set = ColumnKernels::Scalar; set <= supported; set++) {
+        DataContainer<width> mean = statBuffers[set].getMean();
+        DataContainer<width> stdDev = statBuffers[set].getStdDev();
+        bool identical = std::equal(mean.begin(), mean.end(), statBuffers[0].getMean().begin())
+                         && std::equal(stdDev.begin(), stdDev.end(), statBuffers[0].getStdDev().begin())
+                         && std::equal(operatorResults[set].begin(), operatorResults[set].end(),
+                                       operatorResults[0].begin())
+                         && meanBuffers[set].getMean() == meanBuffers[0].getMean()
+                         && momentBuffers[set].getSkewness() == momentBuffers[0].getSkewness()
+                         && momentBuffers[set].getKurtosis() == momentBuffers[0].getKurtosis()
+                         && zScoreSums[set] == zScoreSums[0]
+                         && momentZScoreSums[set] == momentZScoreSums[0]
+                         && decayed[set].getMean() == decayed[0].getMean()
+                         && decayed[set].getStdDev() == decayed[0].getStdDev();
+        std::cout << ColumnKernels::instructionSetName(static_cast<ColumnKernels::InstructionSet>(set))
+                  << " identical to scalar: " << identical << std::endl;
+    }
+    std::cout << std::endl << std::endl;
+}
+
 int main() { 
     DataContainerTest1();
+    DataExpressionTest1();
     StatisticsBufferTest1();
     StatisticsBufferTest2();
+    StatisticsBufferTest3();
+    StatisticsBufferTest4();
+    StatisticsBufferTest5();
+    BasicStatisticsBufferTest1();
+    StatisticsSummaryTest1();
+    MomentPolicyTest1();
+    HigherMomentsTest1();
+    ZScoreTest1();
+    InstrumentationTest1();
+    ColumnKernelsTest1();
+    ConcurrentStatisticsBufferTest1();
+    DynamicStatisticsBufferTest1();
+    StatisticsRegistryTest1();
+    TimedStatisticsBufferTest1();
+    ExponentialStatisticsTest1();
+    PersistentStatisticsBufferTest1();
+    RowLoaderTest1();
+    ColumnarStatisticsBufferTest1();
+    SlidingExtremaTest1();
+    SlidingCovarianceTest1();
+    SlidingQuantilesTest1();
+    SlidingQuantilesTest2();
+    SlidingHistogramTest1();
+    SlidingHistogramTest2();
+    StatisticsPyramidTest1();
     return 0; 
 }
 